@@ -7,6 +7,7 @@
 #include <benchmark/benchmark.h>
 #include <boost/histogram/axis.hpp>
 #include <numeric>
+#include <vector>
 #include "../test/throw_exception.hpp"
 #include "generator.hpp"
 
@@ -33,6 +34,30 @@ static void circular(benchmark::State& state) {
   for (auto _ : state) benchmark::DoNotOptimize(a.index(gen()));
 }
 
+template <class Distribution>
+static void regular_n(benchmark::State& state) {
+  auto a = axis::regular<>(100, 0.0, 1.0);
+  generator<Distribution> gen;
+  std::vector<axis::index_type> idx(gen.size());
+  for (auto _ : state) {
+    a.index_n(gen.data(), gen.size(), idx.data());
+    benchmark::DoNotOptimize(idx.data());
+  }
+  state.SetItemsProcessed(state.iterations() * gen.size());
+}
+
+template <class Distribution>
+static void circular_n(benchmark::State& state) {
+  auto a = axis::circular<>(100, 0.0, 1.0);
+  generator<Distribution> gen;
+  std::vector<axis::index_type> idx(gen.size());
+  for (auto _ : state) {
+    a.index_n(gen.data(), gen.size(), idx.data());
+    benchmark::DoNotOptimize(idx.data());
+  }
+  state.SetItemsProcessed(state.iterations() * gen.size());
+}
+
 template <class T, class Distribution>
 static void integer(benchmark::State& state) {
   auto a = axis::integer<T>(0, 1);
@@ -67,6 +92,10 @@ BENCHMARK_TEMPLATE(regular, uniform);
 BENCHMARK_TEMPLATE(regular, normal);
 BENCHMARK_TEMPLATE(circular, uniform);
 BENCHMARK_TEMPLATE(circular, normal);
+BENCHMARK_TEMPLATE(regular_n, uniform);
+BENCHMARK_TEMPLATE(regular_n, normal);
+BENCHMARK_TEMPLATE(circular_n, uniform);
+BENCHMARK_TEMPLATE(circular_n, normal);
 BENCHMARK_TEMPLATE(integer, int, uniform);
 BENCHMARK_TEMPLATE(integer, int, normal);
 BENCHMARK_TEMPLATE(integer, double, uniform);
@@ -0,0 +1,92 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <benchmark/benchmark.h>
+#include <boost/histogram/axis/regular.hpp>
+#include <boost/histogram/fill_group.hpp>
+#include <boost/histogram/histogram.hpp>
+#include <boost/histogram/make_histogram.hpp>
+#include <boost/histogram/storage_adaptor.hpp>
+#include <boost/mp11/integer_sequence.hpp>
+#include <vector>
+#include "../test/throw_exception.hpp"
+#include "generator.hpp"
+
+#include <cassert>
+struct assert_check {
+  assert_check() {
+    assert(false); // don't run with asserts enabled
+  }
+} _;
+
+using namespace boost::histogram;
+using reg = axis::regular<>;
+using hist_1d = decltype(make_histogram_with(dense_storage<double>(), reg(100, 0, 1)));
+using hist_2d = decltype(make_histogram_with(dense_storage<double>(), reg(100, 0, 1),
+                                             reg(100, 0, 1)));
+
+// the histograms share the first axis and are filled with different weights
+template <class Histogram>
+struct group_setup {
+  generator<uniform> x, y{};
+  std::vector<std::vector<double>> columns;
+  std::vector<std::vector<double>> weights;
+  std::vector<Histogram> hists;
+  std::vector<unsigned> indices;
+
+  group_setup(std::size_t n) : weights(n, std::vector<double>(x.size())) {
+    columns.emplace_back(x.begin(), x.end());
+    columns.emplace_back(y.begin(), y.end());
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t k = 0; k < x.size(); ++k) weights[i][k] = x[k] * i;
+      hists.push_back(make(Histogram{}));
+    }
+    // each histogram uses as many columns as it has axes
+    columns.resize(hists[0].rank());
+    for (unsigned i = 0; i < columns.size(); ++i) indices.push_back(i);
+  }
+
+  static hist_1d make(hist_1d) {
+    return make_histogram_with(dense_storage<double>(), reg(100, 0, 1));
+  }
+
+  static hist_2d make(hist_2d) {
+    return make_histogram_with(dense_storage<double>(), reg(100, 0, 1),
+                               reg(100, 0, 1));
+  }
+};
+
+template <class Histogram, std::size_t N>
+static void Separate(benchmark::State& state) {
+  group_setup<Histogram> s(N);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < N; ++i) s.hists[i].fill(s.columns, weight(s.weights[i]));
+  }
+  state.SetItemsProcessed(state.iterations() * s.x.size() * N);
+}
+
+template <class Histogram, std::size_t... Is>
+void fill_all(group_setup<Histogram>& s, boost::mp11::index_sequence<Is...>) {
+  auto& h = s.hists;
+  const auto& w = s.weights;
+  fill_group(s.columns, fill_entry(h[Is], s.indices, weight(w[Is]))...);
+}
+
+template <class Histogram, std::size_t N>
+static void Group(benchmark::State& state) {
+  group_setup<Histogram> s(N);
+  for (auto _ : state) fill_all(s, boost::mp11::make_index_sequence<N>{});
+  state.SetItemsProcessed(state.iterations() * s.x.size() * N);
+}
+
+BENCHMARK_TEMPLATE(Separate, hist_1d, 5);
+BENCHMARK_TEMPLATE(Group, hist_1d, 5);
+BENCHMARK_TEMPLATE(Separate, hist_1d, 20);
+BENCHMARK_TEMPLATE(Group, hist_1d, 20);
+BENCHMARK_TEMPLATE(Separate, hist_2d, 5);
+BENCHMARK_TEMPLATE(Group, hist_2d, 5);
+BENCHMARK_TEMPLATE(Separate, hist_2d, 20);
+BENCHMARK_TEMPLATE(Group, hist_2d, 20);
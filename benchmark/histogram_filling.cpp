@@ -5,9 +5,14 @@
 // or copy at http://www.boost.org/LICENSE_1_0.txt)
 
 #include <benchmark/benchmark.h>
+#include <boost/histogram/axis/integer.hpp>
 #include <boost/histogram/axis/regular.hpp>
+#include <boost/histogram/hybrid_storage.hpp>
+#include <boost/histogram/sparse_storage.hpp>
 #include <boost/histogram/storage_adaptor.hpp>
+#include <map>
 #include <memory>
+#include <vector>
 #include "../test/throw_exception.hpp"
 #include "../test/utility_histogram.hpp"
 #include "generator.hpp"
@@ -20,6 +25,9 @@ struct assert_check {
 } _;
 
 using SStore = std::vector<double>;
+using MStore = std::map<std::size_t, double>;
+using SpStore = boost::histogram::sparse_storage<double>;
+using HyStore = boost::histogram::hybrid_storage<double>;
 
 // make benchmark compatible with older versions of the library
 #if __has_include(<boost/histogram/unlimited_storage.hpp>)
@@ -49,6 +57,75 @@ static void fill_n_1d(benchmark::State& state) {
   state.SetItemsProcessed(state.iterations() * gen.size());
 }
 
+template <class Distribution, class Tag, class Storage = SStore>
+static void fill_n_1d_circular(benchmark::State& state) {
+  auto h = make_s(Tag(), Storage(), axis::circular<>(100, 0, 1));
+  auto gen = generator<Distribution>();
+  for (auto _ : state) h.fill(gen);
+  state.SetItemsProcessed(state.iterations() * gen.size());
+}
+
+template <class Distribution, class Tag, class Storage = SStore>
+static void fill_n_1d_noflow(benchmark::State& state) {
+  // axis without flow bins covers only half of the values
+  using reg_noflow =
+      axis::regular<double, boost::use_default, axis::null_type, axis::option::none_t>;
+  auto h = make_s(Tag(), Storage(), reg_noflow(100, 0.25, 0.75));
+  auto gen = generator<Distribution>();
+  for (auto _ : state) h.fill(gen);
+  state.SetItemsProcessed(state.iterations() * gen.size());
+}
+
+template <class Distribution, class Tag, class Storage = SStore>
+static void fill_n_1d_wide(benchmark::State& state) {
+  // more cells than indices per fill_n block, counters wider than 8 bit
+  auto h = make_s(Tag(), Storage(), reg(50000, 0, 1));
+  h.at(0) = 300;
+  auto gen = generator<Distribution>();
+  for (auto _ : state) h.fill(gen);
+  state.SetItemsProcessed(state.iterations() * gen.size());
+}
+
+template <class Tag, class Storage = SStore>
+static void fill_1d_growing_monotonic(benchmark::State& state) {
+  // every fill extends the axis by one bin, worst case for storage growth
+  using growing = axis::integer<int, axis::null_type, axis::option::growth_t>;
+  const int n = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    auto h = make_s(Tag(), Storage(), growing(0, 1));
+    for (int i = 0; i < n; ++i) h(i);
+    benchmark::DoNotOptimize(h.size());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <class Tag, class Storage = SStore>
+static void fill_1d_growing_descending(benchmark::State& state) {
+  // every fill extends the axis by one bin at the lower end
+  using growing = axis::integer<int, axis::null_type, axis::option::growth_t>;
+  const int n = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    auto h = make_s(Tag(), Storage(), growing(0, 1));
+    for (int i = 0; i < n; ++i) h(-i);
+    benchmark::DoNotOptimize(h.size());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <class Tag, class Storage = SStore>
+static void fill_n_1d_growing_descending(benchmark::State& state) {
+  // every value extends the axis at the lower end
+  using growing = axis::integer<double, axis::null_type, axis::option::growth_t>;
+  std::vector<double> x(static_cast<std::size_t>(state.range(0)));
+  for (std::size_t i = 0; i < x.size(); ++i) x[i] = -static_cast<double>(i);
+  for (auto _ : state) {
+    auto h = make_s(Tag(), Storage(), growing(0, 1));
+    h.fill(x);
+    benchmark::DoNotOptimize(h.size());
+  }
+  state.SetItemsProcessed(state.iterations() * x.size());
+}
+
 template <class Distribution, class Tag, class Storage = SStore>
 static void fill_2d(benchmark::State& state) {
   auto h = make_s(Tag(), Storage(), reg(100, 0, 1), reg(100, 0, 1));
@@ -113,14 +190,61 @@ BENCHMARK_TEMPLATE(fill_1d, normal, dynamic_tag);
 // BENCHMARK_TEMPLATE(fill_1d, normal, dynamic_tag, DStore);
 
 BENCHMARK_TEMPLATE(fill_n_1d, uniform, static_tag);
-// BENCHMARK_TEMPLATE(fill_n_1d, uniform, static_tag, DStore);
+BENCHMARK_TEMPLATE(fill_n_1d, uniform, static_tag, DStore);
 BENCHMARK_TEMPLATE(fill_n_1d, normal, static_tag);
-// BENCHMARK_TEMPLATE(fill_n_1d, normal, static_tag, DStore);
+BENCHMARK_TEMPLATE(fill_n_1d, normal, static_tag, DStore);
+BENCHMARK_TEMPLATE(fill_n_1d_wide, uniform, static_tag);
+BENCHMARK_TEMPLATE(fill_n_1d_wide, uniform, static_tag, DStore);
 BENCHMARK_TEMPLATE(fill_n_1d, uniform, dynamic_tag);
 // BENCHMARK_TEMPLATE(fill_n_1d, uniform, dynamic_tag, DStore);
 BENCHMARK_TEMPLATE(fill_n_1d, normal, dynamic_tag);
 // BENCHMARK_TEMPLATE(fill_n_1d, normal, dynamic_tag, DStore);
 
+BENCHMARK_TEMPLATE(fill_n_1d_circular, uniform, static_tag);
+BENCHMARK_TEMPLATE(fill_n_1d_circular, normal, static_tag);
+BENCHMARK_TEMPLATE(fill_n_1d_circular, uniform, dynamic_tag);
+BENCHMARK_TEMPLATE(fill_n_1d_circular, normal, dynamic_tag);
+
+BENCHMARK_TEMPLATE(fill_n_1d_noflow, uniform, static_tag);
+BENCHMARK_TEMPLATE(fill_n_1d_noflow, uniform, dynamic_tag);
+
+BENCHMARK_TEMPLATE(fill_1d_growing_monotonic, static_tag)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000);
+BENCHMARK_TEMPLATE(fill_1d_growing_monotonic, dynamic_tag)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000);
+
+BENCHMARK_TEMPLATE(fill_n_1d_growing_descending, static_tag)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000);
+BENCHMARK_TEMPLATE(fill_n_1d_growing_descending, dynamic_tag)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000);
+BENCHMARK_TEMPLATE(fill_1d_growing_monotonic, static_tag, DStore)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000);
+BENCHMARK_TEMPLATE(fill_1d_growing_descending, static_tag)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000);
+BENCHMARK_TEMPLATE(fill_1d_growing_descending, static_tag, DStore)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000);
+BENCHMARK_TEMPLATE(fill_n_1d_growing_descending, static_tag, DStore)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000);
+
+template <class Distribution, class Tag, class Storage = SStore>
+static void fill_n_6d_sparse(benchmark::State& state) {
+  // about 10^9 cells of which only few are filled
+  auto h = make_s(Tag(), Storage(), reg(30, 0, 1), reg(30, 0, 1), reg(30, 0, 1),
+                  reg(30, 0, 1), reg(30, 0, 1), reg(30, 0, 1));
+  auto gen = generator<Distribution>();
+  auto v = {gen, gen, gen, gen, gen, gen};
+  for (auto _ : state) h.fill(v);
+  state.SetItemsProcessed(state.iterations() * 6 * gen.size());
+}
+
 BENCHMARK_TEMPLATE(fill_2d, uniform, static_tag);
 // BENCHMARK_TEMPLATE(fill_2d, uniform, static_tag, DStore);
 BENCHMARK_TEMPLATE(fill_2d, normal, static_tag);
@@ -131,6 +255,7 @@ BENCHMARK_TEMPLATE(fill_2d, normal, dynamic_tag);
 // BENCHMARK_TEMPLATE(fill_2d, normal, dynamic_tag, DStore);
 
 BENCHMARK_TEMPLATE(fill_n_2d, uniform, static_tag);
+BENCHMARK_TEMPLATE(fill_n_2d, uniform, static_tag, HyStore);
 // BENCHMARK_TEMPLATE(fill_n_2d, uniform, static_tag, DStore);
 BENCHMARK_TEMPLATE(fill_n_2d, normal, static_tag);
 // BENCHMARK_TEMPLATE(fill_n_2d, normal, static_tag, DStore);
@@ -174,3 +299,7 @@ BENCHMARK_TEMPLATE(fill_n_6d, uniform, dynamic_tag);
 // BENCHMARK_TEMPLATE(fill_n_6d, uniform, dynamic_tag, DStore);
 BENCHMARK_TEMPLATE(fill_n_6d, normal, dynamic_tag);
 // BENCHMARK_TEMPLATE(fill_n_6d, normal, dynamic_tag, DStore);
+
+BENCHMARK_TEMPLATE(fill_n_6d_sparse, normal, static_tag, MStore);
+BENCHMARK_TEMPLATE(fill_n_6d_sparse, normal, static_tag, SpStore);
+BENCHMARK_TEMPLATE(fill_n_6d_sparse, normal, static_tag, HyStore);
@@ -9,8 +9,12 @@
 #include <boost/histogram/axis/regular.hpp>
 #include <boost/histogram/histogram.hpp>
 #include <boost/histogram/make_histogram.hpp>
+#include <boost/histogram/sharded_histogram.hpp>
+#include <boost/histogram/striped_storage.hpp>
+#include <algorithm>
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <numeric>
 #include <random>
@@ -30,6 +34,7 @@ using namespace std::chrono_literals;
 
 using DS = dense_storage<unsigned>;
 using DSTS = dense_storage<accumulators::count<unsigned, true>>;
+using SS = striped_storage<unsigned>;
 
 static void NoThreads(benchmark::State& state) {
   std::default_random_engine gen(1);
@@ -65,6 +70,91 @@ static void AtomicStorage(benchmark::State& state) {
   }
 }
 
+static auto striped = make_histogram_with(SS(), axis::regular<>());
+
+static void StripedStorage(benchmark::State& state) {
+  init.lock();
+  if (state.thread_index == 0) {
+    const unsigned nbins = state.range(0);
+    striped = make_histogram_with(SS(), axis::regular<>(nbins, 0, 1));
+  }
+  init.unlock();
+  std::default_random_engine gen(state.thread_index);
+  std::uniform_real_distribution<> dis(0, 1);
+  for (auto _ : state) {
+    // simulate some work
+    for (volatile unsigned n = 0; n < state.range(1); ++n)
+      ;
+    striped(dis(gen));
+  }
+}
+
+using SH = sharded_histogram<std::tuple<axis::regular<>>, DS>;
+static std::unique_ptr<SH> sharded;
+
+static void ShardedHistogram(benchmark::State& state) {
+  init.lock();
+  if (state.thread_index == 0) {
+    const unsigned nbins = state.range(0);
+    sharded.reset(new SH(make_histogram_with(DS(), axis::regular<>(nbins, 0, 1))));
+  }
+  init.unlock();
+  std::default_random_engine gen(state.thread_index);
+  std::uniform_real_distribution<> dis(0, 1);
+  for (auto _ : state) {
+    // simulate some work
+    for (volatile unsigned n = 0; n < state.range(1); ++n)
+      ;
+    (*sharded)(dis(gen));
+  }
+}
+
+using RG = axis::regular<double, use_default, use_default, axis::option::growth_t>;
+static auto hist_growing = make_histogram_with(DSTS(), RG());
+
+static void AtomicStorageGrowing(benchmark::State& state) {
+  init.lock();
+  if (state.thread_index == 0) {
+    const unsigned nbins = state.range(0);
+    hist_growing = make_histogram_with(DSTS(), RG(nbins, 0, 1));
+  }
+  init.unlock();
+  std::default_random_engine gen(state.thread_index);
+  std::uniform_real_distribution<> dis(0, 1);
+  for (auto _ : state) {
+    // simulate some work
+    for (volatile unsigned n = 0; n < state.range(1); ++n)
+      ;
+    hist_growing(dis(gen));
+  }
+}
+
+static void FillThreads(benchmark::State& state) {
+  std::default_random_engine gen(1);
+  std::uniform_real_distribution<> dis(0, 1);
+  const unsigned nbins = state.range(0);
+  const unsigned nthreads = state.range(1);
+  auto hist = make_histogram_with(DS(), axis::regular<>(nbins, 0, 1),
+                                  axis::regular<>(nbins, 0, 1));
+  std::vector<double> x(1 << 20), y(1 << 20);
+  std::generate(x.begin(), x.end(), [&] { return dis(gen); });
+  std::generate(y.begin(), y.end(), [&] { return dis(gen); });
+  auto xy = {x, y};
+  for (auto _ : state) hist.fill(threads(nthreads), xy);
+  state.SetItemsProcessed(state.iterations() * x.size());
+}
+
+BENCHMARK(FillThreads)
+    ->UseRealTime()
+    ->Args({1 << 4, 1})
+    ->Args({1 << 4, 2})
+    ->Args({1 << 4, 4})
+    ->Args({1 << 4, 8})
+    ->Args({1 << 10, 1})
+    ->Args({1 << 10, 2})
+    ->Args({1 << 10, 4})
+    ->Args({1 << 10, 8});
+
 BENCHMARK(NoThreads)
     ->UseRealTime()
 
@@ -147,3 +237,99 @@ BENCHMARK(AtomicStorage)
     ->Args({1 << 18, 100})
 
     ;
+
+BENCHMARK(ShardedHistogram)
+    ->UseRealTime()
+    ->Threads(1)
+    ->Threads(2)
+    ->Threads(4)
+
+    ->Args({1 << 4, 0})
+    ->Args({1 << 6, 0})
+    ->Args({1 << 8, 0})
+    ->Args({1 << 10, 0})
+    ->Args({1 << 14, 0})
+    ->Args({1 << 18, 0})
+
+    ->Args({1 << 4, 5})
+    ->Args({1 << 6, 5})
+    ->Args({1 << 8, 5})
+    ->Args({1 << 10, 5})
+    ->Args({1 << 14, 5})
+    ->Args({1 << 18, 5})
+
+    ->Args({1 << 4, 10})
+    ->Args({1 << 6, 10})
+    ->Args({1 << 8, 10})
+    ->Args({1 << 10, 10})
+    ->Args({1 << 14, 10})
+    ->Args({1 << 18, 10})
+
+    ->Args({1 << 4, 50})
+    ->Args({1 << 6, 50})
+    ->Args({1 << 8, 50})
+    ->Args({1 << 10, 50})
+    ->Args({1 << 14, 50})
+    ->Args({1 << 18, 50})
+
+    ->Args({1 << 4, 100})
+    ->Args({1 << 6, 100})
+    ->Args({1 << 8, 100})
+    ->Args({1 << 10, 100})
+    ->Args({1 << 14, 100})
+    ->Args({1 << 18, 100})
+
+    ;
+
+BENCHMARK(StripedStorage)
+    ->UseRealTime()
+    ->Threads(1)
+    ->Threads(2)
+    ->Threads(4)
+
+    ->Args({1 << 4, 0})
+    ->Args({1 << 6, 0})
+    ->Args({1 << 8, 0})
+    ->Args({1 << 10, 0})
+    ->Args({1 << 14, 0})
+    ->Args({1 << 18, 0})
+
+    ->Args({1 << 4, 5})
+    ->Args({1 << 6, 5})
+    ->Args({1 << 8, 5})
+    ->Args({1 << 10, 5})
+    ->Args({1 << 14, 5})
+    ->Args({1 << 18, 5})
+
+    ->Args({1 << 4, 10})
+    ->Args({1 << 6, 10})
+    ->Args({1 << 8, 10})
+    ->Args({1 << 10, 10})
+    ->Args({1 << 14, 10})
+    ->Args({1 << 18, 10})
+
+    ->Args({1 << 4, 50})
+    ->Args({1 << 6, 50})
+    ->Args({1 << 8, 50})
+    ->Args({1 << 10, 50})
+    ->Args({1 << 14, 50})
+    ->Args({1 << 18, 50})
+
+    ->Args({1 << 4, 100})
+    ->Args({1 << 6, 100})
+    ->Args({1 << 8, 100})
+    ->Args({1 << 10, 100})
+    ->Args({1 << 14, 100})
+    ->Args({1 << 18, 100})
+
+    ;
+
+BENCHMARK(AtomicStorageGrowing)
+    ->UseRealTime()
+    ->Threads(1)
+    ->Threads(2)
+    ->Threads(4)
+    ->Args({1 << 4, 0})
+    ->Args({1 << 10, 0})
+    ->Args({1 << 4, 10})
+    ->Args({1 << 10, 10});
@@ -0,0 +1,73 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <benchmark/benchmark.h>
+#include <boost/histogram/axis/integer.hpp>
+#include <boost/histogram/histogram.hpp>
+#include <boost/histogram/make_histogram.hpp>
+#include <boost/histogram/native_archive.hpp>
+#include <boost/histogram/storage_adaptor.hpp>
+#include <boost/histogram/unlimited_storage.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../test/throw_exception.hpp"
+
+#include <cassert>
+struct assert_check {
+  assert_check() {
+    assert(false); // don't run with asserts enabled
+  }
+} _;
+
+using namespace boost::histogram;
+
+template <class Storage>
+auto make_filled_histogram(unsigned n) {
+  auto h = make_histogram_with(Storage(), axis::integer<>(0, n));
+  for (unsigned i = 0; i < n; i += 2) h(i);
+  return h;
+}
+
+template <class Storage>
+static void Save(benchmark::State& state) {
+  const auto h = make_filled_histogram<Storage>(state.range(0));
+  std::string buffer;
+  for (auto _ : state) {
+    std::ostringstream os(std::move(buffer));
+    native_oarchive oa(os);
+    oa << h;
+    buffer = os.str();
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+template <class Storage>
+static void Load(benchmark::State& state) {
+  auto h = make_filled_histogram<Storage>(state.range(0));
+  std::ostringstream os;
+  native_oarchive oa(os);
+  oa << h;
+  const auto buffer = os.str();
+  for (auto _ : state) {
+    std::istringstream is(buffer);
+    native_iarchive ia(is);
+    ia >> h;
+    benchmark::DoNotOptimize(h);
+  }
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+
+#define BENCH(Type, Storage)                                               \
+  BENCHMARK_TEMPLATE(Type, Storage)->RangeMultiplier(32)->Range(1 << 10, 1 << 20)
+
+BENCH(Save, dense_storage<double>);
+BENCH(Load, dense_storage<double>);
+BENCH(Save, unlimited_storage<>);
+BENCH(Load, unlimited_storage<>);
+BENCH(Save, weight_storage);
+BENCH(Load, weight_storage);
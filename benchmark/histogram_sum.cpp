@@ -0,0 +1,72 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <benchmark/benchmark.h>
+#include <boost/histogram/algorithm/sum.hpp>
+#include <boost/histogram/axis/regular.hpp>
+#include <boost/histogram/histogram.hpp>
+#include <boost/histogram/make_histogram.hpp>
+#include <boost/histogram/storage_adaptor.hpp>
+#include <boost/histogram/unlimited_storage.hpp>
+#include <random>
+#include "../test/throw_exception.hpp"
+
+#include <cassert>
+struct assert_check {
+  assert_check() {
+    assert(false); // don't run with asserts enabled
+  }
+} _;
+
+using namespace boost::histogram;
+
+template <class Storage>
+auto make_filled_histogram(unsigned n) {
+  auto h = make_histogram_with(Storage(), axis::regular<>(n, 0, 1));
+  std::default_random_engine gen(1);
+  std::uniform_real_distribution<> x(-0.1, 1.1);
+  for (unsigned i = 0; i < 2 * n; ++i) h(x(gen));
+  return h;
+}
+
+template <class Storage>
+static void Default(benchmark::State& state) {
+  const auto h = make_filled_histogram<Storage>(state.range(0));
+  for (auto _ : state) benchmark::DoNotOptimize(algorithm::sum(h));
+  state.SetItemsProcessed(state.iterations() * h.size());
+}
+
+template <class Storage>
+static void Threads(benchmark::State& state) {
+  const auto h = make_filled_histogram<Storage>(state.range(0));
+  const auto t = threads(static_cast<unsigned>(state.range(1)));
+  for (auto _ : state) benchmark::DoNotOptimize(algorithm::sum(t, h));
+  state.SetItemsProcessed(state.iterations() * h.size());
+}
+
+template <class Storage>
+static void ThreadsInner(benchmark::State& state) {
+  const auto h = make_filled_histogram<Storage>(state.range(0));
+  const auto t = threads(static_cast<unsigned>(state.range(1)));
+  for (auto _ : state) benchmark::DoNotOptimize(algorithm::sum(t, h, coverage::inner));
+  state.SetItemsProcessed(state.iterations() * h.size());
+}
+
+#define BENCH(Type, Storage)                                                   \
+  BENCHMARK_TEMPLATE(Type, Storage)->RangeMultiplier(32)->Range(1 << 10, 1 << 20)
+#define BENCH_THREADS(Type, Storage)                                           \
+  BENCHMARK_TEMPLATE(Type, Storage)                                            \
+      ->Ranges({{1 << 10, 1 << 20}, {1, 4}})                                   \
+      ->RangeMultiplier(32)                                                    \
+      ->UseRealTime()
+
+BENCH(Default, dense_storage<double>);
+BENCH_THREADS(Threads, dense_storage<double>);
+BENCH_THREADS(ThreadsInner, dense_storage<double>);
+BENCH(Default, dense_storage<int>);
+BENCH_THREADS(Threads, dense_storage<int>);
+BENCH(Default, unlimited_storage<>);
+BENCH_THREADS(Threads, unlimited_storage<>);
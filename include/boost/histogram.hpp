@@ -26,12 +26,21 @@
 #include <boost/histogram/accumulators.hpp>
 #include <boost/histogram/algorithm.hpp>
 #include <boost/histogram/axis.hpp>
+#include <boost/histogram/fill_group.hpp>
 #include <boost/histogram/histogram.hpp>
+#include <boost/histogram/hybrid_storage.hpp>
 #include <boost/histogram/indexed.hpp>
 #include <boost/histogram/literals.hpp>
 #include <boost/histogram/make_histogram.hpp>
 #include <boost/histogram/make_profile.hpp>
+#include <boost/histogram/mapped_storage.hpp>
+#include <boost/histogram/sharded_histogram.hpp>
+#include <boost/histogram/sparse_storage.hpp>
 #include <boost/histogram/storage_adaptor.hpp>
+#include <boost/histogram/striped_storage.hpp>
+#include <boost/histogram/tracking_storage.hpp>
+#include <boost/histogram/unlimited_block_storage.hpp>
 #include <boost/histogram/unlimited_storage.hpp>
+#include <boost/histogram/view_storage.hpp>
 
 #endif
@@ -8,10 +8,12 @@
 #define BOOST_HISTOGRAM_ACCUMULATORS_MEAN_HPP
 
 #include <boost/core/nvp.hpp>
+#include <boost/histogram/detail/spin_mutex.hpp>
 #include <boost/histogram/detail/square.hpp>
 #include <boost/histogram/fwd.hpp> // for mean<>
 #include <boost/throw_exception.hpp>
 #include <cassert>
+#include <mutex>
 #include <stdexcept>
 #include <type_traits>
 
@@ -23,9 +25,19 @@ namespace accumulators {
 
   Uses Welfords's incremental algorithm to improve the numerical
   stability of mean and variance computation.
+
+  Inserting samples and adds can optionally be made thread-safe. Each accumulator then
+  holds a lock, which is taken for each update. Reading, assignment, and scaling are not
+  thread-safe.
+
+  @tparam ValueType type of the sums.
+  @tparam ThreadSafe Set to true to make inserting samples and adds thread-safe.
 */
-template <class ValueType>
-class mean {
+template <class ValueType, bool ThreadSafe>
+class mean : detail::accumulator_mutex_base<ThreadSafe> {
+  using mutex_base = detail::accumulator_mutex_base<ThreadSafe>;
+  using lock_type = std::lock_guard<typename mutex_base::type>;
+
 public:
   using value_type = ValueType;
   using const_reference = const value_type&;
@@ -33,8 +45,8 @@ public:
   mean() = default;
 
   /// Allow implicit conversion from mean<T>.
-  template <class T>
-  mean(const mean<T>& o) noexcept
+  template <class T, bool B>
+  mean(const mean<T, B>& o) noexcept
       : sum_{o.sum_}, mean_{o.mean_}, sum_of_deltas_squared_{o.sum_of_deltas_squared_} {}
 
   /// Initialize to external count, mean, and variance.
@@ -43,6 +55,7 @@ public:
 
   /// Insert sample x.
   void operator()(const_reference x) noexcept {
+    lock_type lock(mutex_base::get());
     sum_ += static_cast<value_type>(1);
     const auto delta = x - mean_;
     mean_ += delta / sum_;
@@ -51,6 +64,7 @@ public:
 
   /// Insert sample x with weight w.
   void operator()(const weight_type<value_type>& w, const_reference x) noexcept {
+    lock_type lock(mutex_base::get());
     sum_ += w.value;
     const auto delta = x - mean_;
     mean_ += w.value * delta / sum_;
@@ -60,6 +74,7 @@ public:
   /// Add another mean accumulator.
   mean& operator+=(const mean& rhs) noexcept {
     if (rhs.sum_ == 0) return *this;
+    lock_type lock(mutex_base::get());
 
     /*
       sum_of_deltas_squared
@@ -130,6 +145,8 @@ public:
   */
   value_type variance() const noexcept { return sum_of_deltas_squared_ / (sum_ - 1); }
 
+  static constexpr bool thread_safe() noexcept { return ThreadSafe; }
+
   template <class Archive>
   void serialize(Archive& ar, unsigned version) {
     if (version == 0) {
@@ -148,6 +165,9 @@ private:
   value_type sum_{};
   value_type mean_{};
   value_type sum_of_deltas_squared_{};
+
+  template <class T, bool B>
+  friend class mean;
 };
 
 } // namespace accumulators
@@ -163,19 +183,19 @@ template <class T>
 struct version;
 
 // version 1 for boost::histogram::accumulators::mean<T>
-template <class T>
-struct version<boost::histogram::accumulators::mean<T>> : std::integral_constant<int, 1> {
-};
+template <class T, bool B>
+struct version<boost::histogram::accumulators::mean<T, B>>
+    : std::integral_constant<int, 1> {};
 
 } // namespace serialization
 } // namespace boost
 
 namespace std {
-template <class T, class U>
+template <class T, class U, bool B1, bool B2>
 /// Specialization for boost::histogram::accumulators::mean.
-struct common_type<boost::histogram::accumulators::mean<T>,
-                   boost::histogram::accumulators::mean<U>> {
-  using type = boost::histogram::accumulators::mean<common_type_t<T, U>>;
+struct common_type<boost::histogram::accumulators::mean<T, B1>,
+                   boost::histogram::accumulators::mean<U, B2>> {
+  using type = boost::histogram::accumulators::mean<common_type_t<T, U>, (B1 || B2)>;
 };
 } // namespace std
 
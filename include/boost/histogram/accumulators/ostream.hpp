@@ -67,25 +67,25 @@ std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>&
   return detail::handle_nonzero_width(os, x);
 }
 
-template <class CharT, class Traits, class U>
+template <class CharT, class Traits, class U, bool B>
 std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os,
-                                              const weighted_sum<U>& x) {
+                                              const weighted_sum<U, B>& x) {
   if (os.width() == 0)
     return os << "weighted_sum(" << x.value() << ", " << x.variance() << ")";
   return detail::handle_nonzero_width(os, x);
 }
 
-template <class CharT, class Traits, class U>
+template <class CharT, class Traits, class U, bool B>
 std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os,
-                                              const mean<U>& x) {
+                                              const mean<U, B>& x) {
   if (os.width() == 0)
     return os << "mean(" << x.count() << ", " << x.value() << ", " << x.variance() << ")";
   return detail::handle_nonzero_width(os, x);
 }
 
-template <class CharT, class Traits, class U>
+template <class CharT, class Traits, class U, bool B>
 std::basic_ostream<CharT, Traits>& operator<<(std::basic_ostream<CharT, Traits>& os,
-                                              const weighted_mean<U>& x) {
+                                              const weighted_mean<U, B>& x) {
   if (os.width() == 0)
     return os << "weighted_mean(" << x.sum_of_weights() << ", " << x.value() << ", "
               << x.variance() << ")";
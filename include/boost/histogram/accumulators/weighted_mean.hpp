@@ -8,10 +8,12 @@
 #define BOOST_HISTOGRAM_ACCUMULATORS_WEIGHTED_MEAN_HPP
 
 #include <boost/core/nvp.hpp>
+#include <boost/histogram/detail/spin_mutex.hpp>
 #include <boost/histogram/detail/square.hpp>
 #include <boost/histogram/fwd.hpp> // for weighted_mean<>
 #include <boost/histogram/weight.hpp>
 #include <cassert>
+#include <mutex>
 #include <type_traits>
 
 namespace boost {
@@ -23,9 +25,19 @@ namespace accumulators {
 
   Uses West's incremental algorithm to improve numerical stability
   of mean and variance computation.
+
+  Inserting samples and adds can optionally be made thread-safe. Each accumulator then
+  holds a lock, which is taken for each update. Reading, assignment, and scaling are not
+  thread-safe.
+
+  @tparam ValueType type of the sums.
+  @tparam ThreadSafe Set to true to make inserting samples and adds thread-safe.
 */
-template <class ValueType>
-class weighted_mean {
+template <class ValueType, bool ThreadSafe>
+class weighted_mean : detail::accumulator_mutex_base<ThreadSafe> {
+  using mutex_base = detail::accumulator_mutex_base<ThreadSafe>;
+  using lock_type = std::lock_guard<typename mutex_base::type>;
+
 public:
   using value_type = ValueType;
   using const_reference = const value_type&;
@@ -33,8 +45,8 @@ public:
   weighted_mean() = default;
 
   /// Allow implicit conversion from other weighted_means.
-  template <class T>
-  weighted_mean(const weighted_mean<T>& o)
+  template <class T, bool B>
+  weighted_mean(const weighted_mean<T, B>& o)
       : sum_of_weights_{o.sum_of_weights_}
       , sum_of_weights_squared_{o.sum_of_weights_squared_}
       , weighted_mean_{o.weighted_mean_}
@@ -54,6 +66,7 @@ public:
 
   /// Insert sample x with weight w.
   void operator()(const weight_type<value_type>& w, const_reference x) {
+    lock_type lock(mutex_base::get());
     sum_of_weights_ += w.value;
     sum_of_weights_squared_ += w.value * w.value;
     const auto delta = x - weighted_mean_;
@@ -64,6 +77,7 @@ public:
   /// Add another weighted_mean.
   weighted_mean& operator+=(const weighted_mean& rhs) {
     if (rhs.sum_of_weights_ == 0) return *this;
+    lock_type lock(mutex_base::get());
 
     // see mean.hpp for derivation of correct formula
 
@@ -139,6 +153,8 @@ public:
            (sum_of_weights_ - sum_of_weights_squared_ / sum_of_weights_);
   }
 
+  static constexpr bool thread_safe() noexcept { return ThreadSafe; }
+
   template <class Archive>
   void serialize(Archive& ar, unsigned /* version */) {
     ar& make_nvp("sum_of_weights", sum_of_weights_);
@@ -152,6 +168,9 @@ private:
   value_type sum_of_weights_squared_{};
   value_type weighted_mean_{};
   value_type sum_of_weighted_deltas_squared_{};
+
+  template <class T, bool B>
+  friend class weighted_mean;
 };
 
 } // namespace accumulators
@@ -160,11 +179,12 @@ private:
 
 #ifndef BOOST_HISTOGRAM_DOXYGEN_INVOKED
 namespace std {
-template <class T, class U>
+template <class T, class U, bool B1, bool B2>
 /// Specialization for boost::histogram::accumulators::weighted_mean.
-struct common_type<boost::histogram::accumulators::weighted_mean<T>,
-                   boost::histogram::accumulators::weighted_mean<U>> {
-  using type = boost::histogram::accumulators::weighted_mean<common_type_t<T, U>>;
+struct common_type<boost::histogram::accumulators::weighted_mean<T, B1>,
+                   boost::histogram::accumulators::weighted_mean<U, B2>> {
+  using type =
+      boost::histogram::accumulators::weighted_mean<common_type_t<T, U>, (B1 || B2)>;
 };
 } // namespace std
 #endif
@@ -8,16 +8,29 @@
 #define BOOST_HISTOGRAM_ACCUMULATORS_WEIGHTED_SUM_HPP
 
 #include <boost/core/nvp.hpp>
+#include <boost/histogram/detail/spin_mutex.hpp>
 #include <boost/histogram/fwd.hpp> // for weighted_sum<>
+#include <mutex>
 #include <type_traits>
 
 namespace boost {
 namespace histogram {
 namespace accumulators {
 
-/// Holds sum of weights and its variance estimate
-template <class ValueType>
-class weighted_sum {
+/** Holds sum of weights and its variance estimate.
+
+  Increments and adds can optionally be made thread-safe. Each accumulator then holds a
+  lock, which is taken for each update. Reading, assignment, and scaling are not
+  thread-safe.
+
+  @tparam ValueType type of the sums.
+  @tparam ThreadSafe Set to true to make increments and adds thread-safe.
+*/
+template <class ValueType, bool ThreadSafe>
+class weighted_sum : detail::accumulator_mutex_base<ThreadSafe> {
+  using mutex_base = detail::accumulator_mutex_base<ThreadSafe>;
+  using lock_type = std::lock_guard<typename mutex_base::type>;
+
 public:
   using value_type = ValueType;
   using const_reference = const value_type&;
@@ -28,8 +41,8 @@ public:
   weighted_sum(const_reference value) noexcept : weighted_sum(value, value) {}
 
   /// Allow implicit conversion from sum<T>
-  template <class T>
-  weighted_sum(const weighted_sum<T>& s) noexcept
+  template <class T, bool B>
+  weighted_sum(const weighted_sum<T, B>& s) noexcept
       : weighted_sum(s.value(), s.variance()) {}
 
   /// Initialize sum to value and variance
@@ -38,6 +51,7 @@ public:
 
   /// Increment by one.
   weighted_sum& operator++() {
+    lock_type lock(mutex_base::get());
     ++sum_of_weights_;
     ++sum_of_weights_squared_;
     return *this;
@@ -45,6 +59,7 @@ public:
 
   /// Increment by weight.
   weighted_sum& operator+=(const weight_type<value_type>& w) {
+    lock_type lock(mutex_base::get());
     sum_of_weights_ += w.value;
     sum_of_weights_squared_ += w.value * w.value;
     return *this;
@@ -52,6 +67,7 @@ public:
 
   /// Added another weighted sum.
   weighted_sum& operator+=(const weighted_sum& rhs) {
+    lock_type lock(mutex_base::get());
     sum_of_weights_ += rhs.sum_of_weights_;
     sum_of_weights_squared_ += rhs.sum_of_weights_squared_;
     return *this;
@@ -80,6 +96,8 @@ public:
   // lossy conversion must be explicit
   explicit operator const_reference() const { return sum_of_weights_; }
 
+  static constexpr bool thread_safe() noexcept { return ThreadSafe; }
+
   template <class Archive>
   void serialize(Archive& ar, unsigned /* version */) {
     ar& make_nvp("sum_of_weights", sum_of_weights_);
@@ -97,20 +115,21 @@ private:
 
 #ifndef BOOST_HISTOGRAM_DOXYGEN_INVOKED
 namespace std {
-template <class T, class U>
-struct common_type<boost::histogram::accumulators::weighted_sum<T>,
-                   boost::histogram::accumulators::weighted_sum<U>> {
-  using type = boost::histogram::accumulators::weighted_sum<common_type_t<T, U>>;
+template <class T, class U, bool B1, bool B2>
+struct common_type<boost::histogram::accumulators::weighted_sum<T, B1>,
+                   boost::histogram::accumulators::weighted_sum<U, B2>> {
+  using type =
+      boost::histogram::accumulators::weighted_sum<common_type_t<T, U>, (B1 || B2)>;
 };
 
-template <class T, class U>
-struct common_type<boost::histogram::accumulators::weighted_sum<T>, U> {
-  using type = boost::histogram::accumulators::weighted_sum<common_type_t<T, U>>;
+template <class T, class U, bool B>
+struct common_type<boost::histogram::accumulators::weighted_sum<T, B>, U> {
+  using type = boost::histogram::accumulators::weighted_sum<common_type_t<T, U>, B>;
 };
 
-template <class T, class U>
-struct common_type<T, boost::histogram::accumulators::weighted_sum<U>> {
-  using type = boost::histogram::accumulators::weighted_sum<common_type_t<T, U>>;
+template <class T, class U, bool B>
+struct common_type<T, boost::histogram::accumulators::weighted_sum<U, B>> {
+  using type = boost::histogram::accumulators::weighted_sum<common_type_t<T, U>, B>;
 };
 } // namespace std
 #endif
@@ -13,6 +13,7 @@
 */
 
 #include <boost/histogram/algorithm/empty.hpp>
+#include <boost/histogram/algorithm/materialize.hpp>
 #include <boost/histogram/algorithm/project.hpp>
 #include <boost/histogram/algorithm/reduce.hpp>
 #include <boost/histogram/algorithm/sum.hpp>
@@ -0,0 +1,56 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_ALGORITHM_MATERIALIZE_HPP
+#define BOOST_HISTOGRAM_ALGORITHM_MATERIALIZE_HPP
+
+#include <boost/histogram/detail/make_default.hpp>
+#include <boost/histogram/detail/strided_sum.hpp>
+#include <boost/histogram/histogram.hpp>
+#include <boost/histogram/threads.hpp>
+#include <boost/histogram/unsafe_access.hpp>
+#include <boost/histogram/view_storage.hpp>
+
+namespace boost {
+namespace histogram {
+namespace algorithm {
+
+/**
+  Returns a normal histogram with the cells of a view, using several threads.
+
+  The cells of the original histogram are summed in one pass over its storage, as in
+  reduce() and project(), and the result is equal to the result of these algorithms.
+  The storage of the result has the type of the original storage.
+
+  @param t number of threads, created with the threads() helper function.
+  @param v view created by reduce_view() or project_view().
+*/
+template <class A, class S>
+histogram<A, S> materialize(const threads_type& t,
+                            const histogram<A, view_storage<S>>& v) {
+  const auto& vs = unsafe_access::storage(v);
+  auto result =
+      histogram<A, S>(unsafe_access::axes(v), detail::make_default(vs.storage()));
+  detail::strided_sum_storage(t.value, vs.offsets(), vs.storage(),
+                              unsafe_access::storage(result));
+  return result;
+}
+
+/**
+  Returns a normal histogram with the cells of a view.
+
+  @param v view created by reduce_view() or project_view().
+*/
+template <class A, class S>
+histogram<A, S> materialize(const histogram<A, view_storage<S>>& v) {
+  return materialize(threads(1), v);
+}
+
+} // namespace algorithm
+} // namespace histogram
+} // namespace boost
+
+#endif
@@ -8,13 +8,16 @@
 #define BOOST_HISTOGRAM_ALGORITHM_PROJECT_HPP
 
 #include <algorithm>
+#include <boost/histogram/axis/traits.hpp>
 #include <boost/histogram/axis/variant.hpp>
 #include <boost/histogram/detail/detect.hpp>
 #include <boost/histogram/detail/make_default.hpp>
 #include <boost/histogram/detail/static_if.hpp>
+#include <boost/histogram/detail/strided_sum.hpp>
 #include <boost/histogram/histogram.hpp>
-#include <boost/histogram/indexed.hpp>
+#include <boost/histogram/threads.hpp>
 #include <boost/histogram/unsafe_access.hpp>
+#include <boost/histogram/view_storage.hpp>
 #include <boost/mp11/list.hpp>
 #include <boost/mp11/set.hpp>
 #include <boost/mp11/utility.hpp>
@@ -25,22 +28,15 @@
 
 namespace boost {
 namespace histogram {
-namespace algorithm {
-
-/**
-  Returns a lower-dimensional histogram, summing over removed axes.
+namespace detail {
 
-  Arguments are the source histogram and compile-time numbers, the remaining indices of
-  the axes. Returns a new histogram which only contains the subset of axes. The source
-  histogram is summed over the removed axes.
-*/
-template <class A, class S, unsigned N, typename... Ns>
-auto project(const histogram<A, S>& h, std::integral_constant<unsigned, N>, Ns...) {
+// kept axes in the order of the compile-time indices
+template <class Axes, unsigned N, class... Ns>
+auto project_axes(const Axes& old_axes, std::integral_constant<unsigned, N>, Ns...) {
   using LN = mp11::mp_list<std::integral_constant<unsigned, N>, Ns...>;
   static_assert(mp11::mp_is_set<LN>::value, "indices must be unique");
 
-  const auto& old_axes = unsafe_access::axes(h);
-  auto axes = detail::static_if<detail::is_tuple<A>>(
+  return static_if<is_tuple<Axes>>(
       [&](const auto& old_axes) {
         return std::make_tuple(std::get<N>(old_axes), std::get<Ns::value>(old_axes)...);
       },
@@ -48,55 +44,168 @@ auto project(const histogram<A, S>& h, std::integral_constant<unsigned, N>, Ns..
         return std::decay_t<decltype(old_axes)>({old_axes[N], old_axes[Ns::value]...});
       },
       old_axes);
+}
+
+// kept axes in the order of the indices in the iterable range; axes is always
+// std::vector<...>, even if Axes is tuple
+template <class Axes, class Iterable, class = requires_iterable<Iterable>>
+auto project_axes(const Axes& old_axes, const Iterable& c) {
+  auto axes = make_empty_dynamic_axes(old_axes);
+  axes.reserve(c.size());
+  auto seen = make_stack_buffer(old_axes, false);
+  for (auto d : c) {
+    if (static_cast<unsigned>(d) >= axes_rank(old_axes))
+      BOOST_THROW_EXCEPTION(std::invalid_argument("invalid axis index"));
+    if (seen[d]) BOOST_THROW_EXCEPTION(std::invalid_argument("indices are not unique"));
+    seen[d] = true;
+    axes.emplace_back(axis_get(old_axes, d));
+  }
+  return axes;
+}
+
+// offsets of the cells of the source axes in the storage of the projection; cells of
+// removed axes are summed, kept axes are laid out in the order of the indices
+template <class Axes, class Iterable>
+cell_offsets make_project_offsets(const Axes& axes, const Iterable& kept) {
+  cell_offsets offsets;
+  offsets.reserve(axes_rank(axes));
+  for_each_axis(axes, [&offsets](const auto& a) {
+    offsets.emplace_back(static_cast<std::size_t>(axis::traits::extent(a)), 0);
+  });
+  std::size_t stride = 1;
+  for (auto d : kept) {
+    auto& o = offsets[static_cast<unsigned>(d)];
+    for (std::size_t j = 0; j < o.size(); ++j) o[j] = j * stride;
+    stride *= o.size();
+  }
+  return offsets;
+}
+
+template <class A, class S, class Axes, class Iterable>
+auto make_project_view(const histogram<A, S>& h, Axes&& axes, const Iterable& kept) {
+  const auto& old_axes = unsafe_access::axes(h);
+  const auto kept_strides = view_strides(axes);
+  std::vector<std::size_t> strides(axes_rank(old_axes), 0);
+  std::size_t i = 0;
+  for (auto d : kept) strides[static_cast<unsigned>(d)] = kept_strides[i++];
+  const auto n = bincount(axes);
+  return histogram<std::decay_t<Axes>, view_storage<S>>(
+      std::forward<Axes>(axes),
+      view_storage<S>(unsafe_access::storage(h), make_project_offsets(old_axes, kept),
+                      strides, n));
+}
+
+} // namespace detail
+
+namespace algorithm {
+
+/**
+  Returns a lower-dimensional histogram, summing over removed axes, using several threads.
+
+  The cells of the source are summed with precomputed strides directly on the storage.
+  With several threads, the cells of the source are split along the last axis.
+
+  @param t number of threads, created with the threads() helper function.
+  @param h source histogram.
+  @param n, ns compile-time numbers, the remaining indices of the axes.
+*/
+template <class A, class S, unsigned N, typename... Ns>
+auto project(const threads_type& t, const histogram<A, S>& h,
+             std::integral_constant<unsigned, N> n, Ns... ns) {
+  const auto& old_axes = unsafe_access::axes(h);
+  auto axes = detail::project_axes(old_axes, n, ns...);
 
   const auto& old_storage = unsafe_access::storage(h);
   using A2 = decltype(axes);
   auto result = histogram<A2, S>(std::move(axes), detail::make_default(old_storage));
-  auto idx = detail::make_stack_buffer<int>(unsafe_access::axes(result));
-  for (auto&& x : indexed(h, coverage::all)) {
-    auto i = idx.begin();
-    mp11::mp_for_each<LN>([&i, &x](auto J) { *i++ = x.index(J); });
-    result.at(idx) += *x;
-  }
+  const unsigned kept[] = {N, Ns::value...};
+  detail::strided_sum_storage(t.value, detail::make_project_offsets(old_axes, kept),
+                              old_storage, unsafe_access::storage(result));
   return result;
 }
 
 /**
   Returns a lower-dimensional histogram, summing over removed axes.
 
+  Arguments are the source histogram and compile-time numbers, the remaining indices of
+  the axes. Returns a new histogram which only contains the subset of axes. The source
+  histogram is summed over the removed axes.
+*/
+template <class A, class S, unsigned N, typename... Ns>
+auto project(const histogram<A, S>& h, std::integral_constant<unsigned, N> n, Ns... ns) {
+  return project(threads(1), h, n, ns...);
+}
+
+/**
+  Returns a lower-dimensional histogram, summing over removed axes, using several threads.
+
   This version accepts a source histogram and an iterable range containing the remaining
   indices.
+
+  @param t number of threads, created with the threads() helper function.
+  @param h source histogram.
+  @param c iterable range of the remaining indices of the axes.
 */
 template <class A, class S, class Iterable, class = detail::requires_iterable<Iterable>>
-auto project(const histogram<A, S>& h, const Iterable& c) {
-  using namespace boost::mp11;
+auto project(const threads_type& t, const histogram<A, S>& h, const Iterable& c) {
   const auto& old_axes = unsafe_access::axes(h);
-
-  // axes is always std::vector<...>, even if A is tuple
-  auto axes = detail::make_empty_dynamic_axes(old_axes);
-  axes.reserve(c.size());
-  auto seen = detail::make_stack_buffer(old_axes, false);
-  for (auto d : c) {
-    if (static_cast<unsigned>(d) >= h.rank())
-      BOOST_THROW_EXCEPTION(std::invalid_argument("invalid axis index"));
-    if (seen[d]) BOOST_THROW_EXCEPTION(std::invalid_argument("indices are not unique"));
-    seen[d] = true;
-    axes.emplace_back(detail::axis_get(old_axes, d));
-  }
+  auto axes = detail::project_axes(old_axes, c);
 
   const auto& old_storage = unsafe_access::storage(h);
   auto result =
       histogram<decltype(axes), S>(std::move(axes), detail::make_default(old_storage));
-  auto idx = detail::make_stack_buffer<int>(unsafe_access::axes(result));
-  for (auto&& x : indexed(h, coverage::all)) {
-    auto i = idx.begin();
-    for (auto d : c) *i++ = x.index(d);
-    result.at(idx) += *x;
-  }
-
+  detail::strided_sum_storage(t.value, detail::make_project_offsets(old_axes, c),
+                              old_storage, unsafe_access::storage(result));
   return result;
 }
 
+/**
+  Returns a lower-dimensional histogram, summing over removed axes.
+
+  This version accepts a source histogram and an iterable range containing the remaining
+  indices.
+*/
+template <class A, class S, class Iterable, class = detail::requires_iterable<Iterable>>
+auto project(const histogram<A, S>& h, const Iterable& c) {
+  return project(threads(1), h, c);
+}
+
+/**
+  Returns a lazy view of a lower-dimensional histogram, summing over removed axes.
+
+  Takes the same arguments as project(), but returns a histogram with a view_storage,
+  which computes its cells on access by summing the cells of the original histogram
+  over the removed axes. The original histogram must outlive the view. Use
+  materialize() to turn the view into a normal histogram, which is then equal to the
+  result of project().
+
+  @param h source histogram.
+  @param n, ns compile-time numbers, the remaining indices of the axes.
+*/
+template <class A, class S, unsigned N, typename... Ns>
+auto project_view(const histogram<A, S>& h, std::integral_constant<unsigned, N> n,
+                  Ns... ns) {
+  auto axes = detail::project_axes(unsafe_access::axes(h), n, ns...);
+  const unsigned kept[] = {N, Ns::value...};
+  return detail::make_project_view(h, std::move(axes), kept);
+}
+
+/**
+  Returns a lazy view of a lower-dimensional histogram, summing over removed axes.
+
+  This version accepts a source histogram and an iterable range containing the remaining
+  indices.
+*/
+template <class A, class S, class Iterable, class = detail::requires_iterable<Iterable>>
+auto project_view(const histogram<A, S>& h, const Iterable& c) {
+  auto axes = detail::project_axes(unsafe_access::axes(h), c);
+  return detail::make_project_view(h, std::move(axes), c);
+}
+
+// a view of a temporary would dangle
+template <class A, class S, class... Ts>
+void project_view(histogram<A, S>&&, const Ts&...) = delete;
+
 } // namespace algorithm
 } // namespace histogram
 } // namespace boost
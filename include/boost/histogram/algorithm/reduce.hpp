@@ -12,9 +12,11 @@
 #include <boost/histogram/detail/make_default.hpp>
 #include <boost/histogram/detail/reduce_command.hpp>
 #include <boost/histogram/detail/static_if.hpp>
+#include <boost/histogram/detail/strided_sum.hpp>
 #include <boost/histogram/fwd.hpp>
-#include <boost/histogram/indexed.hpp>
+#include <boost/histogram/threads.hpp>
 #include <boost/histogram/unsafe_access.hpp>
+#include <boost/histogram/view_storage.hpp>
 #include <boost/throw_exception.hpp>
 #include <cassert>
 #include <cmath>
@@ -24,6 +26,124 @@
 
 namespace boost {
 namespace histogram {
+namespace detail {
+
+// applies reduce commands to the axes; fills in the index ranges of the commands
+template <class Axes, class Opts>
+auto reduce_axes(const Axes& old_axes, Opts& opts) {
+  using axis::index_type;
+  return axes_transform(old_axes, [&opts](std::size_t iaxis, const auto& a_in) {
+    using A = std::decay_t<decltype(a_in)>;
+    using AO = axis::traits::get_options<A>;
+    auto& o = opts[iaxis];
+    o.is_ordered = axis::traits::ordered(a_in);
+    if (o.merge > 0) { // option is set?
+      o.use_underflow_bin = AO::test(axis::option::underflow);
+      o.use_overflow_bin = AO::test(axis::option::overflow);
+      return detail::static_if_c<axis::traits::is_reducible<A>::value>(
+          [&o](const auto& a_in) {
+            if (o.range == reduce_command::range_t::none) {
+              // no range restriction, pure rebin
+              o.begin.index = 0;
+              o.end.index = a_in.size();
+            } else {
+              // range striction, convert values to indices as needed
+              if (o.range == reduce_command::range_t::values) {
+                const auto end_value = o.end.value;
+                o.begin.index = axis::traits::index(a_in, o.begin.value);
+                o.end.index = axis::traits::index(a_in, o.end.value);
+                // end = index + 1, unless end_value equal to upper bin edge
+                if (axis::traits::value_as<double>(a_in, o.end.index) != end_value)
+                  ++o.end.index;
+              }
+
+              // crop flow bins if index range does not include them
+              if (o.crop) {
+                o.use_underflow_bin &= o.begin.index < 0;
+                o.use_overflow_bin &= o.end.index > a_in.size();
+              }
+
+              // now limit [begin, end] to [0, size()]
+              if (o.begin.index < 0) o.begin.index = 0;
+              if (o.end.index > a_in.size()) o.end.index = a_in.size();
+            }
+            // shorten the index range to a multiple of o.merge;
+            // example [1, 4] with merge = 2 is reduced to [1, 3]
+            o.end.index -=
+                (o.end.index - o.begin.index) % static_cast<index_type>(o.merge);
+            using A = std::decay_t<decltype(a_in)>;
+            return A(a_in, o.begin.index, o.end.index, o.merge);
+          },
+          [iaxis](const auto& a_in) {
+            return BOOST_THROW_EXCEPTION(std::invalid_argument(
+                       "axis " + std::to_string(iaxis) + " is not reducible")),
+                   a_in;
+          },
+          a_in);
+    } else {
+      // command was not set for this axis; fill noop values and copy original axis
+      o.use_underflow_bin = AO::test(axis::option::underflow);
+      o.use_overflow_bin = AO::test(axis::option::overflow);
+      o.merge = 1;
+      o.begin.index = 0;
+      o.end.index = a_in.size();
+      return a_in;
+    }
+  });
+}
+
+// offsets of the cells of the source axes in the storage of the reduced histogram, or
+// invalid_index if the cells are discarded; reduced axes have the options of the source
+template <class Axes, class Opts>
+cell_offsets make_reduce_offsets(const Axes& old_axes, const Axes& axes,
+                                 const Opts& opts) {
+  using axis::index_type;
+  auto stride = make_stack_buffer<std::size_t>(axes);
+  std::size_t n = 1;
+  auto s = stride.begin();
+  for_each_axis(axes, [&n, &s](const auto& a) {
+    *s++ = n;
+    n *= static_cast<std::size_t>(axis::traits::extent(a));
+  });
+
+  cell_offsets offsets;
+  offsets.reserve(axes_rank(old_axes));
+  s = stride.begin();
+  auto o = opts.begin();
+  for_each_axis(old_axes, [&](const auto& a) {
+    using AO = axis::traits::get_options<std::decay_t<decltype(a)>>;
+    const index_type shift = AO::test(axis::option::underflow) ? 1 : 0;
+    const index_type reduced_axis_end =
+        (o->end.index - o->begin.index) / static_cast<index_type>(o->merge);
+    offsets.emplace_back(static_cast<std::size_t>(axis::traits::extent(a)));
+    auto& off = offsets.back();
+    for (index_type j = -shift; j + shift < static_cast<index_type>(off.size()); ++j) {
+      auto i = j - o->begin.index;
+      bool skip = false;
+      if (o->is_ordered && i <= -1) {
+        i = -1;
+        if (!o->use_underflow_bin) skip = true;
+      } else {
+        if (i >= 0)
+          i /= static_cast<index_type>(o->merge);
+        else
+          i = o->end.index;
+        if (i >= reduced_axis_end) {
+          i = reduced_axis_end;
+          if (!o->use_overflow_bin) skip = true;
+        }
+      }
+      off[static_cast<std::size_t>(j + shift)] =
+          skip ? invalid_index : static_cast<std::size_t>(i + shift) * *s;
+    }
+    ++s;
+    ++o;
+  });
+  return offsets;
+}
+
+} // namespace detail
+
 namespace algorithm {
 
 /** Holder for a reduce command.
@@ -332,114 +452,44 @@ inline reduce_command slice_and_rebin(axis::index_type begin, axis::index_type e
 
   An overload allows one to pass reduce_command as positional arguments.
 
+  The cells of the original histogram are added to the reduced histogram in memory
+  order, using a precomputed table of the new cell positions for each axis. With
+  several threads, the cells are split along the last axis.
+
+  @param t number of threads, created with the threads() helper function.
   @param hist original histogram.
   @param options iterable sequence of reduce commands: `shrink`, `slice`, `rebin`,
   `shrink_and_rebin`, or `slice_and_rebin`. The element type of the iterable should be
   `reduce_command`.
 */
 template <class Histogram, class Iterable, class = detail::requires_iterable<Iterable>>
-Histogram reduce(const Histogram& hist, const Iterable& options) {
-  using axis::index_type;
-
+Histogram reduce(const threads_type& t, const Histogram& hist, const Iterable& options) {
   const auto& old_axes = unsafe_access::axes(hist);
   auto opts = detail::make_stack_buffer(old_axes, reduce_command{});
   detail::normalize_reduce_commands(opts, options);
 
-  auto axes =
-      detail::axes_transform(old_axes, [&opts](std::size_t iaxis, const auto& a_in) {
-        using A = std::decay_t<decltype(a_in)>;
-        using AO = axis::traits::get_options<A>;
-        auto& o = opts[iaxis];
-        o.is_ordered = axis::traits::ordered(a_in);
-        if (o.merge > 0) { // option is set?
-          o.use_underflow_bin = AO::test(axis::option::underflow);
-          o.use_overflow_bin = AO::test(axis::option::overflow);
-          return detail::static_if_c<axis::traits::is_reducible<A>::value>(
-              [&o](const auto& a_in) {
-                if (o.range == reduce_command::range_t::none) {
-                  // no range restriction, pure rebin
-                  o.begin.index = 0;
-                  o.end.index = a_in.size();
-                } else {
-                  // range striction, convert values to indices as needed
-                  if (o.range == reduce_command::range_t::values) {
-                    const auto end_value = o.end.value;
-                    o.begin.index = axis::traits::index(a_in, o.begin.value);
-                    o.end.index = axis::traits::index(a_in, o.end.value);
-                    // end = index + 1, unless end_value equal to upper bin edge
-                    if (axis::traits::value_as<double>(a_in, o.end.index) != end_value)
-                      ++o.end.index;
-                  }
-
-                  // crop flow bins if index range does not include them
-                  if (o.crop) {
-                    o.use_underflow_bin &= o.begin.index < 0;
-                    o.use_overflow_bin &= o.end.index > a_in.size();
-                  }
-
-                  // now limit [begin, end] to [0, size()]
-                  if (o.begin.index < 0) o.begin.index = 0;
-                  if (o.end.index > a_in.size()) o.end.index = a_in.size();
-                }
-                // shorten the index range to a multiple of o.merge;
-                // example [1, 4] with merge = 2 is reduced to [1, 3]
-                o.end.index -=
-                    (o.end.index - o.begin.index) % static_cast<index_type>(o.merge);
-                using A = std::decay_t<decltype(a_in)>;
-                return A(a_in, o.begin.index, o.end.index, o.merge);
-              },
-              [iaxis](const auto& a_in) {
-                return BOOST_THROW_EXCEPTION(std::invalid_argument(
-                           "axis " + std::to_string(iaxis) + " is not reducible")),
-                       a_in;
-              },
-              a_in);
-        } else {
-          // command was not set for this axis; fill noop values and copy original axis
-          o.use_underflow_bin = AO::test(axis::option::underflow);
-          o.use_overflow_bin = AO::test(axis::option::overflow);
-          o.merge = 1;
-          o.begin.index = 0;
-          o.end.index = a_in.size();
-          return a_in;
-        }
-      });
-
+  auto axes = detail::reduce_axes(old_axes, opts);
   auto result =
       Histogram(std::move(axes), detail::make_default(unsafe_access::storage(hist)));
 
-  auto idx = detail::make_stack_buffer<index_type>(unsafe_access::axes(result));
-  for (auto&& x : indexed(hist, coverage::all)) {
-    auto i = idx.begin();
-    auto o = opts.begin();
-    bool skip = false;
-
-    for (auto j : x.indices()) {
-      *i = (j - o->begin.index);
-      if (o->is_ordered && *i <= -1) {
-        *i = -1;
-        if (!o->use_underflow_bin) skip = true;
-      } else {
-        if (*i >= 0)
-          *i /= static_cast<index_type>(o->merge);
-        else
-          *i = o->end.index;
-        const auto reduced_axis_end =
-            (o->end.index - o->begin.index) / static_cast<index_type>(o->merge);
-        if (*i >= reduced_axis_end) {
-          *i = reduced_axis_end;
-          if (!o->use_overflow_bin) skip = true;
-        }
-      }
+  detail::strided_sum_storage(
+      t.value, detail::make_reduce_offsets(old_axes, unsafe_access::axes(result), opts),
+      unsafe_access::storage(hist), unsafe_access::storage(result));
+  return result;
+}
 
-      ++i;
-      ++o;
-    }
+/** Shrink, crop, slice, and/or rebin axes of a histogram.
 
-    if (!skip) result.at(idx) += *x;
-  }
+  See reduce(t, hist, options) for details, this version uses one thread.
 
-  return result;
+  @param hist original histogram.
+  @param options iterable sequence of reduce commands: `shrink`, `slice`, `rebin`,
+  `shrink_and_rebin`, or `slice_and_rebin`. The element type of the iterable should be
+  `reduce_command`.
+*/
+template <class Histogram, class Iterable, class = detail::requires_iterable<Iterable>>
+Histogram reduce(const Histogram& hist, const Iterable& options) {
+  return reduce(threads(1), hist, options);
 }
 
 /** Shrink, slice, and/or rebin axes of a histogram.
@@ -463,9 +513,73 @@ Histogram reduce(const Histogram& hist, const Iterable& options) {
 template <class Histogram, class... Ts>
 Histogram reduce(const Histogram& hist, const reduce_command& opt, const Ts&... opts) {
   // this must be in one line, because any of the ts could be a temporary
-  return reduce(hist, std::initializer_list<reduce_command>{opt, opts...});
+  return reduce(threads(1), hist, std::initializer_list<reduce_command>{opt, opts...});
+}
+
+/** Shrink, slice, and/or rebin axes of a histogram, using several threads.
+
+  Like reduce(hist, opt, opts...), see reduce(t, hist, options) for details.
+
+  @param t number of threads, created with the threads() helper function.
+  @param hist original histogram.
+  @param opt first reduce command; one of `shrink`, `slice`, `rebin`,
+  `shrink_and_rebin`, or `slice_or_rebin`.
+  @param opts more reduce commands.
+*/
+template <class Histogram, class... Ts>
+Histogram reduce(const threads_type& t, const Histogram& hist, const reduce_command& opt,
+                 const Ts&... opts) {
+  // this must be in one line, because any of the ts could be a temporary
+  return reduce(t, hist, std::initializer_list<reduce_command>{opt, opts...});
+}
+
+/** Lazy view of a shrunk, cropped, sliced, and/or rebinned histogram.
+
+  Takes the same commands as reduce(), but returns a histogram with a view_storage,
+  which computes its cells on access from the cells of the original histogram. The
+  original histogram must outlive the view. Use materialize() to turn the view into a
+  normal histogram, which is then equal to the result of reduce().
+
+  @param hist original histogram.
+  @param options iterable sequence of reduce commands: `shrink`, `slice`, `rebin`,
+  `shrink_and_rebin`, or `slice_and_rebin`. The element type of the iterable should be
+  `reduce_command`.
+*/
+template <class A, class S, class Iterable, class = detail::requires_iterable<Iterable>>
+auto reduce_view(const histogram<A, S>& hist, const Iterable& options) {
+  const auto& old_axes = unsafe_access::axes(hist);
+  auto opts = detail::make_stack_buffer(old_axes, reduce_command{});
+  detail::normalize_reduce_commands(opts, options);
+
+  auto axes = detail::reduce_axes(old_axes, opts);
+  auto offsets = detail::make_reduce_offsets(old_axes, axes, opts);
+  const auto strides = detail::view_strides(axes);
+  const auto n = detail::bincount(axes);
+  return histogram<A, view_storage<S>>(
+      std::move(axes),
+      view_storage<S>(unsafe_access::storage(hist), std::move(offsets), strides, n));
+}
+
+/** Lazy view of a shrunk, sliced, and/or rebinned histogram.
+
+  Like reduce_view(hist, options), with reduce commands as positional arguments.
+
+  @param hist original histogram.
+  @param opt first reduce command; one of `shrink`, `slice`, `rebin`,
+  `shrink_and_rebin`, or `slice_or_rebin`.
+  @param opts more reduce commands.
+*/
+template <class A, class S, class... Ts>
+auto reduce_view(const histogram<A, S>& hist, const reduce_command& opt,
+                 const Ts&... opts) {
+  // this must be in one line, because any of the ts could be a temporary
+  return reduce_view(hist, std::initializer_list<reduce_command>{opt, opts...});
 }
 
+// a view of a temporary would dangle
+template <class A, class S, class... Ts>
+void reduce_view(histogram<A, S>&&, const Ts&...) = delete;
+
 } // namespace algorithm
 } // namespace histogram
 } // namespace boost
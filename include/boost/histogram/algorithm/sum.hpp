@@ -8,13 +8,133 @@
 #define BOOST_HISTOGRAM_ALGORITHM_SUM_HPP
 
 #include <boost/histogram/accumulators/sum.hpp>
+#include <boost/histogram/axis/traits.hpp>
+#include <boost/histogram/detail/axes.hpp>
+#include <boost/histogram/detail/lane_sum.hpp>
+#include <boost/histogram/detail/parallel_for.hpp>
 #include <boost/histogram/fwd.hpp>
 #include <boost/histogram/indexed.hpp>
+#include <boost/histogram/threads.hpp>
+#include <boost/histogram/unlimited_storage.hpp>
+#include <boost/histogram/unsafe_access.hpp>
 #include <boost/mp11/utility.hpp>
+#include <algorithm>
+#include <cstddef>
 #include <type_traits>
+#include <vector>
 
 namespace boost {
 namespace histogram {
+namespace detail {
+
+// Calls f(t, i, n) for each run of n consecutive covered cells starting at index i,
+// where t is the index of the thread. With coverage::all, the cells form one run which
+// is split between the threads. Otherwise, the inner cells along the first axis form
+// the runs, which are distributed over the threads.
+template <class Axes, class F>
+void for_each_covered_run(unsigned nthreads, const Axes& axes, const coverage cov,
+                          F&& f) {
+  // begin, size and stride of the inner cells along each axis
+  std::vector<std::size_t> begin, size, stride;
+  std::size_t n = 1;
+  for_each_axis(axes, [&](const auto& a) {
+    const std::size_t u = (axis::traits::options(a) & axis::option::underflow) ? 1 : 0;
+    const bool inner = cov == coverage::inner;
+    begin.push_back(inner ? u : 0);
+    size.push_back(static_cast<std::size_t>(inner ? a.size() : axis::traits::extent(a)));
+    stride.push_back(n);
+    n *= static_cast<std::size_t>(axis::traits::extent(a));
+  });
+  if (cov == coverage::all) {
+    begin.assign(1, 0);
+    size.assign(1, n);
+  }
+  if (begin.empty()) {
+    // histogram without axes has one cell
+    begin.push_back(0);
+    size.push_back(1);
+    stride.push_back(1);
+  }
+
+  const std::size_t run = size[0];
+  std::size_t rows = 1;
+  for (std::size_t k = 1; k < size.size(); ++k) rows *= size[k];
+  if (run == 0 || rows == 0) return;
+
+  if (rows == 1) {
+    nthreads = static_cast<unsigned>((std::min)(std::size_t{nthreads}, run));
+    if (nthreads <= 1) return f(0u, begin[0], run);
+    parallel_for(nthreads, [&](unsigned t) {
+      const auto first = t * run / nthreads, last = (t + 1) * run / nthreads;
+      f(t, begin[0] + first, last - first);
+    });
+    return;
+  }
+
+  const auto rows_range = [&](unsigned t, std::size_t first, std::size_t last) {
+    for (std::size_t r = first; r < last; ++r) {
+      std::size_t i = begin[0];
+      for (std::size_t k = 1, q = r; k < size.size(); ++k) {
+        i += (begin[k] + q % size[k]) * stride[k];
+        q /= size[k];
+      }
+      f(t, i, run);
+    }
+  };
+  nthreads = static_cast<unsigned>((std::min)(std::size_t{nthreads}, rows));
+  if (nthreads <= 1) return rows_range(0u, 0, rows);
+  parallel_for(nthreads, [&](unsigned t) {
+    rows_range(t, t * rows / nthreads, (t + 1) * rows / nthreads);
+  });
+}
+
+// arithmetic values
+template <class A, class S>
+double threaded_sum(std::true_type, unsigned nthreads, const A& axes, const S& s,
+                    const coverage cov) {
+  std::vector<accumulators::sum<double>> partial((std::max)(nthreads, 1u));
+  for_each_covered_run(nthreads, axes, cov,
+                       [&](unsigned t, std::size_t i, std::size_t n) {
+                         lane_sum(s, i, n, partial[t]);
+                       });
+  accumulators::sum<double> result;
+  for (auto&& x : partial) result += x;
+  return result.value();
+}
+
+// type of the cells is looked up once
+template <class A, class Alloc>
+double threaded_sum(std::true_type, unsigned nthreads, const A& axes,
+                    const unlimited_storage<Alloc>& s, const coverage cov) {
+  return unsafe_access::unlimited_storage_buffer(s).visit([&](const auto* p) {
+    std::vector<accumulators::sum<double>> partial((std::max)(nthreads, 1u));
+    for_each_covered_run(nthreads, axes, cov,
+                         [&](unsigned t, std::size_t i, std::size_t n) {
+                           lane_sum(p, i, n, partial[t]);
+                         });
+    accumulators::sum<double> result;
+    for (auto&& x : partial) result += x;
+    return result.value();
+  });
+}
+
+// accumulators and other values
+template <class A, class S>
+auto threaded_sum(std::false_type, unsigned nthreads, const A& axes, const S& s,
+                  const coverage cov) {
+  using T = typename S::value_type;
+  std::vector<T> partial((std::max)(nthreads, 1u));
+  for_each_covered_run(nthreads, axes, cov,
+                       [&](unsigned t, std::size_t i, std::size_t n) {
+                         for (const auto end = i + n; i < end; ++i) partial[t] += s[i];
+                       });
+  T result = partial[0];
+  for (std::size_t t = 1; t < partial.size(); ++t) result += partial[t];
+  return result;
+}
+
+} // namespace detail
+
 namespace algorithm {
 
 /** Compute the sum over all histogram cells (underflow/overflow included by default).
@@ -26,6 +146,10 @@ namespace algorithm {
   is double if the value type of the histogram is integral or floating point, and the
   original value type otherwise.
 
+  A faster algorithm with the same accuracy guarantee, which can also use several
+  threads, is selected by passing threads() as the first argument, see
+  sum(t, hist, cov).
+
   If you need a different trade-off, you can write your own loop or use `std::accumulate`:
   ```
   // iterate over all bins
@@ -61,6 +185,37 @@ auto sum(const histogram<A, S>& hist, const coverage cov = coverage::all) {
   return static_cast<R>(sum);
 }
 
+/** Compute the sum over all histogram cells with a faster algorithm and several threads.
+
+  Selects a faster summation policy with the same accuracy guarantee as sum(hist, cov);
+  the result may differ in the last bits. The cells are read directly from the storage,
+  skipping underflow and overflow bins with coverage::inner.
+
+  If the value type of the histogram is a floating point type, the cells are summed
+  with the Neumaier algorithm in several independent lanes, which the compiler can
+  vectorize. Integers with up to 32 bits are summed exactly. For unlimited_storage, the
+  type of the cells is looked up once. Other value types are summed with their
+  operator+=.
+
+  The cells are split into consecutive ranges, one per thread. Each thread computes a
+  partial sum, and the partial sums are added in a fixed order, so the result does not
+  depend on the scheduling of the threads. Pass threads(1) to use the fast algorithm
+  with only the calling thread.
+
+  @returns accumulator type or double
+
+  @param t number of threads, created with the threads() helper function.
+  @param hist Const reference to the histogram.
+  @param cov  Iterate over all or only inner bins (optional, default: all).
+*/
+template <class A, class S>
+auto sum(const threads_type& t, const histogram<A, S>& hist,
+         const coverage cov = coverage::all) {
+  using T = typename histogram<A, S>::value_type;
+  return detail::threaded_sum(std::is_arithmetic<T>{}, t.value, unsafe_access::axes(hist),
+                              unsafe_access::storage(hist), cov);
+}
+
 } // namespace algorithm
 } // namespace histogram
 } // namespace boost
@@ -16,6 +16,9 @@
 #include <boost/histogram/detail/relaxed_equal.hpp>
 #include <boost/histogram/fwd.hpp>
 #include <boost/throw_exception.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
@@ -32,7 +35,9 @@ namespace axis {
   The axis maps a set of values to bins, following the order of arguments in the
   constructor. The optional overflow bin for this axis counts input values that
   are not part of the set. Binning has O(N) complexity, but with a very small
-  factor. For small N (the typical use case) it beats other kinds of lookup.
+  factor. For small N (the typical use case) it beats other kinds of lookup. For large
+  N, a hash table is used if `std::hash` is available for the value type, which makes
+  binning a O(1) operation.
 
   @tparam Value input value type, must be equal-comparable.
   @tparam MetaData type to store meta data.
@@ -52,6 +57,10 @@ class category : public iterator_mixin<category<Value, MetaData, Options, Alloca
   using options_type = detail::replace_default<Options, option::overflow_t>;
   using allocator_type = Allocator;
   using vector_type = std::vector<value_type, allocator_type>;
+  using table_type = std::vector<
+      index_type,
+      typename std::allocator_traits<allocator_type>::template rebind_alloc<index_type>>;
+  using is_hashable = detail::is_hashable<value_type>;
 
   static_assert(!options_type::test(option::underflow),
                 "category axis cannot have underflow");
@@ -63,7 +72,7 @@ class category : public iterator_mixin<category<Value, MetaData, Options, Alloca
 
 public:
   constexpr category() = default;
-  explicit category(allocator_type alloc) : vec_(alloc) {}
+  explicit category(allocator_type alloc) : vec_(alloc), table_(alloc) {}
 
   /** Construct from iterator range of unique values.
    *
@@ -74,12 +83,13 @@ public:
    */
   template <class It, class = detail::requires_iterator<It>>
   category(It begin, It end, metadata_type meta = {}, allocator_type alloc = {})
-      : metadata_base(std::move(meta)), vec_(alloc) {
+      : metadata_base(std::move(meta)), vec_(alloc), table_(alloc) {
     if (std::distance(begin, end) < 0)
       BOOST_THROW_EXCEPTION(
           std::invalid_argument("end must be reachable by incrementing begin"));
     vec_.reserve(std::distance(begin, end));
     while (begin != end) vec_.emplace_back(*begin++);
+    make_table(is_hashable{});
   }
 
   /** Construct axis from iterable sequence of unique values.
@@ -117,6 +127,7 @@ public:
 
   /// Return index for value argument.
   index_type index(const value_type& x) const noexcept {
+    if (!table_.empty()) return find_index(is_hashable{}, x);
     const auto beg = vec_.begin();
     const auto end = vec_.end();
     return static_cast<index_type>(std::distance(beg, std::find(beg, end, x)));
@@ -127,6 +138,7 @@ public:
     const auto i = index(x);
     if (i < size()) return {i, 0};
     vec_.emplace_back(x);
+    insert_last(is_hashable{});
     return {i, -1};
   }
 
@@ -176,10 +188,62 @@ public:
   void serialize(Archive& ar, unsigned /* version */) {
     ar& make_nvp("seq", vec_);
     ar& make_nvp("meta", this->metadata());
+    make_table(is_hashable{}); // table is not serialized, it is recomputed after loading
   }
 
 private:
+  // The hash table uses open addressing with linear probing. It stores indices of
+  // values in vec_, empty slots are marked with -1. If vec_ contains equal values,
+  // only the first is entered, so that lookup gives the same result as std::find.
+  // For few values, the linear search is faster, so no table is made.
+  static constexpr std::size_t table_min_size = 64;
+
+  void make_table(std::false_type) noexcept {}
+
+  void make_table(std::true_type) {
+    table_.clear();
+    if (vec_.size() < table_min_size) return;
+    // keep load factor below 1/2
+    table_bits_ = 1;
+    while ((std::size_t{1} << table_bits_) < 2 * vec_.size()) ++table_bits_;
+    table_.assign(std::size_t{1} << table_bits_, -1);
+    for (index_type i = 0; i < size(); ++i) {
+      auto& slot = table_[find_slot(vec_[i])];
+      if (slot < 0) slot = i;
+    }
+  }
+
+  void insert_last(std::false_type) noexcept {}
+
+  void insert_last(std::true_type) {
+    if (2 * vec_.size() > table_.size())
+      make_table(std::true_type{});
+    else
+      table_[find_slot(vec_.back())] = size() - 1;
+  }
+
+  index_type find_index(std::false_type, const value_type&) const noexcept {
+    return size(); // never called, table is always empty
+  }
+
+  index_type find_index(std::true_type, const value_type& x) const noexcept {
+    const auto i = table_[find_slot(x)];
+    return i < 0 ? size() : i;
+  }
+
+  // returns slot which holds the index of x or the empty slot where it belongs
+  std::size_t find_slot(const value_type& x) const noexcept {
+    const auto mask = table_.size() - 1;
+    // Fibonacci hashing, since std::hash is often the identity for integers
+    const auto h = static_cast<std::uint64_t>(std::hash<value_type>{}(x));
+    auto k = static_cast<std::size_t>((h * 0x9E3779B97F4A7C15ull) >> (64 - table_bits_));
+    while (table_[k] >= 0 && !(vec_[table_[k]] == x)) k = (k + 1) & mask;
+    return k;
+  }
+
   vector_type vec_;
+  table_type table_;
+  unsigned table_bits_ = 0;
 
   template <class V, class M, class O, class A>
   friend class category;
@@ -20,6 +20,7 @@
 #include <boost/throw_exception.hpp>
 #include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <limits>
 #include <stdexcept>
 #include <string>
@@ -308,6 +309,37 @@ public:
     return size(); // also returned if x is NaN
   }
 
+  /** Compute indices for n values at once.
+
+    Gives the same results as calling index() for each value. The loop has no
+    branches, so that the compiler can vectorize it if the transform allows it.
+
+    @param x pointer to first value.
+    @param n number of values.
+    @param out pointer to first of n indices to write.
+  */
+  template <class U, class = std::enable_if_t<std::is_convertible<U, value_type>::value>>
+  void index_n(const U* x, std::size_t n, index_type* out) const noexcept {
+    // Runs in hot loop, please measure impact of changes
+    const auto s = static_cast<internal_value_type>(size());
+    for (const U* const xend = x + n; x != xend; ++x, ++out) {
+      const value_type v = *x;
+      auto z = (this->forward(v / unit_type{}) - min_) / delta_;
+      if (options_type::test(option::circular)) {
+        // same as std::isfinite(z), but vectorizable
+        const bool finite =
+            std::abs(z) <= (std::numeric_limits<internal_value_type>::max)();
+        z = finite ? z - std::floor(z) : 0;
+        *out = finite ? static_cast<index_type>(z * s) : size();
+      } else {
+        const bool inside = (z >= 0) & (z < 1);
+        // compute index with a valid z always to avoid undefined behavior in the cast
+        const auto i = static_cast<index_type>((inside ? z : 0) * s);
+        *out = inside ? i : (z < 0 ? -1 : size()); // size() also returned if x is NaN
+      }
+    }
+  }
+
   /// Returns index and shift (if axis has grown) for the passed argument.
   std::pair<index_type, index_type> update(value_type x) noexcept {
     assert(options_type::test(option::growth));
@@ -24,6 +24,7 @@
 #include <cmath>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
@@ -37,8 +38,10 @@ namespace axis {
 /**
   Axis for non-equidistant bins on the real line.
 
-  Binning is a O(log(N)) operation. If speed matters and the problem domain
-  allows it, prefer a regular axis, possibly with a transform.
+  Binning is a O(log(N)) operation. Axes with many bins and a finite range use a guide
+  table which makes binning a O(1) operation if the bin widths do not vary too much.
+  If speed matters and the problem domain allows it, prefer a regular axis, possibly
+  with a transform.
 
   @tparam Value input value type, must be floating point.
   @tparam MetaData type to store meta data.
@@ -56,6 +59,9 @@ class variable : public iterator_mixin<variable<Value, MetaData, Options, Alloca
       detail::replace_default<Options, decltype(option::underflow | option::overflow)>;
   using allocator_type = Allocator;
   using vector_type = std::vector<Value, allocator_type>;
+  using table_type = std::vector<
+      index_type,
+      typename std::allocator_traits<allocator_type>::template rebind_alloc<index_type>>;
 
   static_assert(
       std::is_floating_point<value_type>::value,
@@ -69,7 +75,7 @@ class variable : public iterator_mixin<variable<Value, MetaData, Options, Alloca
 
 public:
   constexpr variable() = default;
-  explicit variable(allocator_type alloc) : vec_(alloc) {}
+  explicit variable(allocator_type alloc) : vec_(alloc), table_(alloc) {}
 
   /** Construct from iterator range of bin edges.
    *
@@ -80,7 +86,7 @@ public:
    */
   template <class It, class = detail::requires_iterator<It>>
   variable(It begin, It end, metadata_type meta = {}, allocator_type alloc = {})
-      : metadata_base(std::move(meta)), vec_(std::move(alloc)) {
+      : metadata_base(std::move(meta)), vec_(alloc), table_(alloc) {
     if (std::distance(begin, end) < 2)
       BOOST_THROW_EXCEPTION(std::invalid_argument("bins > 0 required"));
 
@@ -94,6 +100,7 @@ public:
     if (!strictly_ascending)
       BOOST_THROW_EXCEPTION(
           std::invalid_argument("input sequence must be strictly ascending"));
+    make_table();
   }
 
   /** Construct variable axis from iterable range of bin edges.
@@ -120,13 +127,14 @@ public:
 
   /// Constructor used by algorithm::reduce to shrink and rebin (not for users).
   variable(const variable& src, index_type begin, index_type end, unsigned merge)
-      : metadata_base(src), vec_(src.get_allocator()) {
+      : metadata_base(src), vec_(src.get_allocator()), table_(src.get_allocator()) {
     assert((end - begin) % merge == 0);
     if (options_type::test(option::circular) && !(begin == 0 && end == src.size()))
       BOOST_THROW_EXCEPTION(std::invalid_argument("cannot shrink circular axis"));
     vec_.reserve((end - begin) / merge);
     const auto beg = src.vec_.begin();
     for (index_type i = begin; i <= end; i += merge) vec_.emplace_back(*(beg + i));
+    make_table();
   }
 
   /// Return index for value argument.
@@ -136,6 +144,15 @@ public:
       const auto b = vec_[size()];
       x -= std::floor((x - a) / (b - a)) * (b - a);
     }
+    if (!table_.empty()) {
+      // same result as upper_bound below, but only edges in bucket of x are searched
+      if (x < vec_.front()) return -1;
+      if (!(x < vec_.back())) return size(); // also returned if x is NaN
+      const auto k = bucket(x);
+      const auto first = vec_.begin();
+      return static_cast<index_type>(
+          std::upper_bound(first + table_[k], first + table_[k + 1], x) - first - 1);
+    }
     return static_cast<index_type>(std::upper_bound(vec_.begin(), vec_.end(), x) -
                                    vec_.begin() - 1);
   }
@@ -208,10 +225,36 @@ public:
   void serialize(Archive& ar, unsigned /* version */) {
     ar& make_nvp("seq", vec_);
     ar& make_nvp("meta", this->metadata());
+    make_table(); // table is not serialized, it is recomputed after loading
   }
 
 private:
+  // The guide table splits the axis range into equidistant buckets. table_[k] is the
+  // number of edges which fall into buckets lower than k. Since the bucket number is
+  // a monotonic function of the value, the edges that enclose a value in bucket k
+  // have the indices table_[k] - 1 to table_[k + 1].
+  void make_table() {
+    table_.clear();
+    const auto n = size();
+    // growing axes do not use a table, rebuilding it would make growth expensive;
+    // for a small number of bins, upper_bound is as fast as the table
+    if (options_type::test(option::growth) || n < 64) return;
+    if (!std::isfinite(vec_.front()) || !std::isfinite(vec_.back())) return;
+    scale_ = n / (vec_.back() - vec_.front());
+    table_.assign(static_cast<std::size_t>(n) + 2, 0);
+    for (auto&& x : vec_) ++table_[bucket(x) + 1];
+    std::partial_sum(table_.begin(), table_.end(), table_.begin());
+  }
+
+  // precondition: x >= vec_.front()
+  index_type bucket(value_type x) const noexcept {
+    return static_cast<index_type>(
+        (std::min)((x - vec_.front()) * scale_, static_cast<value_type>(size())));
+  }
+
   vector_type vec_;
+  table_type table_;
+  value_type scale_ = 0;
 
   template <class V, class M, class O, class A>
   friend class variable;
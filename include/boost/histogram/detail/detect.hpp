@@ -11,6 +11,7 @@
 #include <boost/mp11/function.hpp> // mp_and, mp_or
 #include <boost/mp11/integral.hpp> // mp_not
 #include <boost/mp11/list.hpp>     // mp_first
+#include <functional>                // std::hash
 #include <iterator>
 #include <tuple>
 #include <type_traits>
@@ -68,6 +69,18 @@ BOOST_HISTOGRAM_DETAIL_DETECT(has_method_reset, t.reset(0));
 
 BOOST_HISTOGRAM_DETAIL_DETECT(is_indexable, t[0]);
 
+BOOST_HISTOGRAM_DETAIL_DETECT(is_hashable, (std::hash<T>{}(t)));
+
+BOOST_HISTOGRAM_DETAIL_DETECT_BINARY(
+    has_method_index_n,
+    (t.index_n(&cref<U>(), std::size_t{}, static_cast<axis::index_type*>(nullptr))));
+
+BOOST_HISTOGRAM_DETAIL_DETECT_BINARY(has_method_increment_n,
+                                     (t.increment_n(&cref<U>(), std::size_t{})));
+
+BOOST_HISTOGRAM_DETAIL_DETECT_BINARY(has_method_grow,
+                                     (t.grow(std::size_t{}, std::size_t{}, u)));
+
 BOOST_HISTOGRAM_DETAIL_DETECT_BINARY(is_transform, (t.inverse(t.forward(u))));
 
 BOOST_HISTOGRAM_DETAIL_DETECT(is_indexable_container,
@@ -13,8 +13,10 @@
 #include <boost/histogram/axis/variant.hpp>
 #include <boost/histogram/detail/argument_traits.hpp>
 #include <boost/histogram/detail/axes.hpp>
+#include <boost/histogram/detail/detect.hpp>
 #include <boost/histogram/detail/linearize.hpp>
 #include <boost/histogram/detail/make_default.hpp>
+#include <boost/histogram/detail/mutex_base.hpp>
 #include <boost/histogram/detail/optional_index.hpp>
 #include <boost/histogram/detail/priority.hpp>
 #include <boost/histogram/detail/tuple_slice.hpp>
@@ -25,8 +27,10 @@
 #include <boost/mp11/utility.hpp>
 #include <cassert>
 #include <mutex>
+#include <shared_mutex>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 
 namespace boost {
 namespace histogram {
@@ -85,44 +89,79 @@ struct storage_grower {
 
   template <class S>
   void apply(S& storage, const axis::index_type* shifts) {
+    using in_place =
+        mp11::mp_and<is_vector_like<S>, std::is_reference<typename S::reference>>;
+    using method =
+        mp11::mp_int<(has_method_grow<S, relocator>::value ? 2 : in_place::value)>;
+    apply_impl(method{}, storage, shifts);
+  }
+
+private:
+  // moves the cells of a storage with a grow method into their new positions
+  struct relocator {
+    storage_grower& grower;
+    const axis::index_type* shifts;
+    std::size_t old_size, offset;
+
+    template <class T>
+    void operator()(T* p) const {
+      grower.relocate(p, old_size, offset, shifts);
+    }
+  };
+
+  // sets multi-dimensional index to position of cell i in old storage
+  void set_index(std::size_t i) noexcept {
+    for (auto dit = data_; dit != data_ + axes_rank(axes_); ++dit) {
+      dit->idx = static_cast<axis::index_type>(i % dit->old_extent);
+      i /= dit->old_extent;
+    }
+  }
+
+  // returns position of current cell in new storage
+  std::size_t new_index(const axis::index_type* sit) const noexcept {
+    std::size_t j = 0;
+    auto dit = data_;
+    for_each_axis(axes_, [&](const auto& a) {
+      using opt = axis::traits::get_options<std::decay_t<decltype(a)>>;
+      if (opt::test(axis::option::underflow)) {
+        if (dit->idx == 0) {
+          // axis has underflow and we are in the underflow bin:
+          // keep storage pointer unchanged
+          ++dit;
+          ++sit;
+          return;
+        }
+      }
+      if (opt::test(axis::option::overflow)) {
+        if (dit->idx == dit->old_extent - 1) {
+          // axis has overflow and we are in the overflow bin:
+          // move storage pointer to corresponding overflow bin position
+          j += (axis::traits::extent(a) - 1) * dit->new_stride;
+          ++dit;
+          ++sit;
+          return;
+        }
+      }
+      // we are in a normal bin:
+      // move storage pointer to index position; apply positive shifts if any
+      j += (dit->idx + (*sit >= 0 ? *sit : 0)) * dit->new_stride;
+      ++dit;
+      ++sit;
+    });
+    return j;
+  }
+
+  // generic case: copy cells into new storage
+  template <class S>
+  void apply_impl(mp11::mp_int<0>, S& storage, const axis::index_type* shifts) {
     auto new_storage = make_default(storage);
     new_storage.reset(new_size_);
     const auto dlast = data_ + axes_rank(axes_) - 1;
     for (auto&& x : storage) {
-      auto ns = new_storage.begin();
-      auto sit = shifts;
-      auto dit = data_;
-      for_each_axis(axes_, [&](const auto& a) {
-        using opt = axis::traits::get_options<std::decay_t<decltype(a)>>;
-        if (opt::test(axis::option::underflow)) {
-          if (dit->idx == 0) {
-            // axis has underflow and we are in the underflow bin:
-            // keep storage pointer unchanged
-            ++dit;
-            ++sit;
-            return;
-          }
-        }
-        if (opt::test(axis::option::overflow)) {
-          if (dit->idx == dit->old_extent - 1) {
-            // axis has overflow and we are in the overflow bin:
-            // move storage pointer to corresponding overflow bin position
-            ns += (axis::traits::extent(a) - 1) * dit->new_stride;
-            ++dit;
-            ++sit;
-            return;
-          }
-        }
-        // we are in a normal bin:
-        // move storage pointer to index position; apply positive shifts if any
-        ns += (dit->idx + (*sit >= 0 ? *sit : 0)) * dit->new_stride;
-        ++dit;
-        ++sit;
-      });
       // assign old value to new location
-      *ns = x;
+      *(new_storage.begin() + new_index(shifts)) = x;
       // advance multi-dimensional index
-      dit = data_;
+      auto dit = data_;
       ++dit->idx;
       while (dit != dlast && dit->idx == dit->old_extent) {
         dit->idx = 0;
@@ -131,6 +170,76 @@ struct storage_grower {
     }
     storage = std::move(new_storage);
   }
+
+  // Optimization for vector-like storage: resize and move cells in place. The vector
+  // grows its capacity geometrically, so when an axis grows by a few bins at a time,
+  // most growth events neither allocate nor touch the bulk of the cells.
+  template <class S>
+  void apply_impl(mp11::mp_int<1>, S& storage, const axis::index_type* shifts) {
+    const auto old_size = storage.size();
+    storage.resize(new_size_);
+    relocate(storage, old_size, 0, shifts);
+  }
+
+  // Optimization for storages which keep free space in front of and after the cells,
+  // like unlimited_storage: the storage moves all cells by the offset, which consumes
+  // free space in front of the cells if there is enough, so that only the remaining
+  // cells are moved here. The offset is the displacement of the cell in the middle,
+  // which is that of most cells, for example, of all cells but the underflow bins if
+  // the last axis grows at its lower end.
+  template <class S>
+  void apply_impl(mp11::mp_int<2>, S& storage, const axis::index_type* shifts) {
+    const auto old_size = storage.size();
+    std::size_t offset = 0;
+    if (old_size > 0) {
+      set_index(old_size / 2);
+      offset = new_index(shifts) - old_size / 2;
+    }
+    storage.grow(new_size_, offset, relocator{*this, shifts, old_size, offset});
+  }
+
+  // Moves cells to their new positions, where cell i is currently at position i +
+  // offset. Cells only move to higher positions in the new storage and the displacement
+  // never decreases with the position. Therefore, the cells which have to move up form
+  // a tail, which is moved starting from the last cell, and the cells which have to
+  // move down form a head, which is moved starting from the first cell. The cells in
+  // between stay where they are.
+  template <class T>
+  void relocate(T& a, const std::size_t old_size, const std::size_t offset,
+                const axis::index_type* shifts) {
+    using value_type = std::decay_t<decltype(a[0])>;
+    if (old_size == 0) return;
+    const auto dlast = data_ + axes_rank(axes_) - 1;
+    set_index(old_size - 1);
+    for (auto i = old_size; i-- > 0;) {
+      const auto j = new_index(shifts);
+      if (j <= i + offset) break;
+      a[j] = std::move(a[i + offset]);
+      a[i + offset] = value_type{};
+      // step back multi-dimensional index
+      auto dit = data_;
+      while (dit != dlast && dit->idx == 0) {
+        dit->idx = dit->old_extent - 1;
+        ++dit;
+      }
+      --dit->idx;
+    }
+    set_index(0);
+    for (std::size_t i = 0; i < old_size; ++i) {
+      const auto j = new_index(shifts);
+      assert(j >= i);
+      if (j >= i + offset) break;
+      a[j] = std::move(a[i + offset]);
+      a[i + offset] = value_type{};
+      // advance multi-dimensional index
+      auto dit = data_;
+      ++dit->idx;
+      while (dit != dlast && dit->idx == dit->old_extent) {
+        dit->idx = 0;
+        ++(++dit)->idx;
+      }
+    }
+  }
 };
 
 template <class T, class... Us>
@@ -270,6 +379,24 @@ auto fill_2(ArgTraits, mp11::mp_true, const std::size_t, Storage& st, Axes& axes
                       args);
 }
 
+// at least one axis is growing; fills only if no axis needs to grow, so that the axes
+// are not modified, otherwise sets grow to true and returns end of storage
+template <class ArgTraits, class Storage, class Axes, class Args>
+auto fill_2_if_no_growth(ArgTraits, Storage& st, const Axes& axes, const Args& args,
+                         bool& grow) {
+  mp11::mp_if<has_non_inclusive_axis<Axes>, optional_index, std::size_t> idx{0};
+  std::size_t stride = 1;
+  mp11::mp_for_each<mp11::mp_iota_c<min<Axes>(ArgTraits::nargs::value)>>([&](auto i) {
+    const auto extent = linearize_if_no_growth(
+        idx, stride, axis_get<i>(axes), std::get<(ArgTraits::start::value + i)>(args));
+    grow |= extent == 0;
+    stride *= extent;
+  });
+  if (grow) return st.end();
+  return fill_storage(typename ArgTraits::wpos{}, typename ArgTraits::spos{}, st, idx,
+                      args);
+}
+
 // pack original args tuple into another tuple (which is unpacked later)
 template <int Start, int Size, class IW, class IS, class Args>
 decltype(auto) pack_args(IW, IS, const Args& args) noexcept {
@@ -296,11 +423,10 @@ decltype(auto) pack_args(mp11::mp_int<-1>, mp11::mp_int<-1>, const Args& args) n
 #pragma warning(disable : 4702) // fixing warning would reduce code readability a lot
 #endif
 
-template <class ArgTraits, class S, class A, class Args>
-auto fill(std::true_type, ArgTraits, const std::size_t offset, S& storage, A& axes,
-          const Args& args) -> typename S::iterator {
-  using growing = has_growing_axis<A>;
-
+// Calls f with the argument traits and the arguments, which are repacked if needed.
+template <class ArgTraits, class A, class Args, class F>
+auto fill_dispatch(ArgTraits, const A& axes, const Args& args, F&& f)
+    -> decltype(f(ArgTraits{}, args)) {
   // Sometimes we need to pack the tuple into another tuple:
   // - histogram contains one axis which accepts tuple
   // - user passes tuple to fill(...)
@@ -314,20 +440,26 @@ auto fill(std::true_type, ArgTraits, const std::size_t offset, S& storage, A& ax
   //   3d tuple)
 
   if (axes_rank(axes) == ArgTraits::nargs::value)
-    return fill_2(ArgTraits{}, growing{}, offset, storage, axes, args);
+    return f(ArgTraits{}, args);
   else if (axes_rank(axes) == 1 &&
            axis::traits::rank(axis_get<0>(axes)) == ArgTraits::nargs::value)
-    return fill_2(
+    return f(
         argument_traits_holder<
             1, 0, (ArgTraits::wpos::value >= 0 ? 1 : -1),
             (ArgTraits::spos::value >= 0 ? (ArgTraits::wpos::value >= 0 ? 2 : 1) : -1),
             typename ArgTraits::sargs>{},
-        growing{}, offset, storage, axes,
         pack_args<ArgTraits::start::value, ArgTraits::nargs::value>(
             typename ArgTraits::wpos{}, typename ArgTraits::spos{}, args));
-  return BOOST_THROW_EXCEPTION(
-             std::invalid_argument("number of arguments != histogram rank")),
-         storage.end();
+  BOOST_THROW_EXCEPTION(std::invalid_argument("number of arguments != histogram rank"));
+}
+
+template <class ArgTraits, class S, class A, class Args>
+auto fill(std::true_type, ArgTraits, const std::size_t offset, S& storage, A& axes,
+          const Args& args) -> typename S::iterator {
+  using growing = has_growing_axis<A>;
+  return fill_dispatch(ArgTraits{}, axes, args, [&](auto traits, const auto& args) {
+    return fill_2(traits, growing{}, offset, storage, axes, args);
+  });
 }
 
 #if BOOST_WORKAROUND(BOOST_MSVC, >= 0)
@@ -341,6 +473,34 @@ auto fill(std::false_type, ArgTraits, const std::size_t, S& storage, A&, const A
   return storage.end();
 }
 
+// fill while holding lock on mutex of histogram
+template <class B, class ArgTraits, class S, class A, class Args, class Mutex>
+auto fill(B, ArgTraits, const std::size_t offset, S& storage, A& axes, const Args& args,
+          Mutex& m) -> typename S::iterator {
+  std::lock_guard<Mutex> guard{m};
+  return fill(B{}, ArgTraits{}, offset, storage, axes, args);
+}
+
+// Optimization for thread-safe storage and growing axes: axes only grow rarely, so
+// threads first fill under a shared lock, which does not modify the axes. Only if an
+// axis needs to grow, the fill is repeated under an exclusive lock.
+template <class ArgTraits, class S, class A, class Args>
+auto fill(std::true_type, ArgTraits, const std::size_t offset, S& storage, A& axes,
+          const Args& args, reader_writer_mutex& m) -> typename S::iterator {
+  {
+    std::shared_lock<reader_writer_mutex> guard{m};
+    bool grow = false;
+    const A& caxes = axes;
+    const auto it =
+        fill_dispatch(ArgTraits{}, caxes, args, [&](auto traits, const auto& args) {
+          return fill_2_if_no_growth(traits, storage, caxes, args, grow);
+        });
+    if (!grow) return it;
+  }
+  std::lock_guard<reader_writer_mutex> guard{m};
+  return fill(std::true_type{}, ArgTraits{}, offset, storage, axes, args);
+}
+
 } // namespace detail
 } // namespace histogram
 } // namespace boost
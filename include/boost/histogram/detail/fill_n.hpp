@@ -8,6 +8,7 @@
 #define BOOST_HISTOGRAM_DETAIL_FILL_N_HPP
 
 #include <algorithm>
+#include <atomic>
 #include <boost/histogram/axis/option.hpp>
 #include <boost/histogram/axis/traits.hpp>
 #include <boost/histogram/detail/axes.hpp>
@@ -16,19 +17,24 @@
 #include <boost/histogram/detail/linearize.hpp>
 #include <boost/histogram/detail/nonmember_container_access.hpp>
 #include <boost/histogram/detail/optional_index.hpp>
+#include <boost/histogram/detail/parallel_for.hpp>
 #include <boost/histogram/detail/span.hpp>
 #include <boost/histogram/detail/static_if.hpp>
 #include <boost/histogram/fwd.hpp>
+#include <boost/histogram/weight.hpp>
 #include <boost/mp11/algorithm.hpp>
 #include <boost/mp11/bind.hpp>
 #include <boost/mp11/utility.hpp>
 #include <boost/throw_exception.hpp>
 #include <boost/variant2/variant.hpp>
 #include <cassert>
+#include <exception>
 #include <initializer_list>
+#include <memory>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace boost {
 namespace histogram {
@@ -95,9 +101,49 @@ struct index_visitor {
   void call_1(std::false_type, const T& iterable) const {
     // T is iterable; fill N values
     const auto* tp = dtl::data(iterable) + start_;
+    using U = std::remove_const_t<std::remove_reference_t<decltype(*tp)>>;
+    grow(IsGrowing{}, tp);
+    call_n(mp11::mp_and<mp11::mp_not<IsGrowing>, has_method_index_n<Axis, U>>{}, tp);
+  }
+
+  template <class T>
+  void grow(std::false_type, const T*) const {}
+
+  template <class T>
+  void grow(std::true_type, const T* tp) const {
+    // Optimization: grow the axis to cover all values before computing indices.
+    // Otherwise, each growth at the lower end would shift all previously computed
+    // indices, which is quadratic in the number of values for a descending input.
+    // Growth in the following index computation is still handled correctly; it may
+    // happen in rare cases due to round-off.
+    if (!(axis::traits::options(axis_) & axis::option::growth)) return;
+    for (auto it = tp; it != tp + size_; ++it) {
+      const auto shift =
+          update_shift(axis_, try_cast<value_type, std::invalid_argument>(*it));
+      if (shift > 0) *shift_ += shift;
+    }
+  }
+
+  template <class T>
+  void call_n(std::false_type, const T* tp) const {
     for (auto it = begin_; it != begin_ + size_; ++it) call_2(IsGrowing{}, it, *tp++);
   }
 
+  template <class T>
+  void call_n(std::true_type, const T* tp) const {
+    // Optimization: axis computes indices for a block of values in one call, which
+    // allows the compiler to vectorize the computation
+    constexpr std::size_t block_size = 128;
+    constexpr auto opts = Opt{} & (axis::option::underflow | axis::option::overflow);
+    axis::index_type idx[block_size];
+    for (std::size_t i = 0; i < size_; i += block_size) {
+      const std::size_t n = std::min(block_size, size_ - i);
+      axis_.index_n(tp + i, n, idx);
+      for (std::size_t k = 0; k < n; ++k)
+        linearize(opts, begin_[i + k], stride_, axis_.size(), idx[k]);
+    }
+  }
+
   template <class T>
   void call_1(std::true_type, const T& value) const {
     // T is compatible value; fill single value N times
@@ -182,12 +228,173 @@ void fill_n_storage(S& s, const Index idx, weight_type<T>&& w, Ts&&... ps) noexc
   (void)std::initializer_list<int>{(ps.second ? (++ps.first, 0) : 0)...};
 }
 
+template <class S, class Index, class... Ts>
+void fill_n_storage_n(std::false_type, S& s, const Index* indices, const std::size_t n,
+                      Ts&&... ts) {
+  for (auto&& idx : make_span(indices, n))
+    fill_n_storage(s, idx, std::forward<Ts>(ts)...);
+}
+
+template <class S, class Index>
+void fill_n_storage_n(std::false_type, S& s, const Index* indices, const std::size_t n) {
+  static_if<has_method_increment_n<S, Index>>(
+      // Optimization: storage increments all cells in one call; this avoids the
+      // overhead of proxy references, like those of unlimited_storage
+      [indices, n](auto& s) { s.increment_n(indices, n); },
+      [indices, n](auto& s) {
+        for (auto&& idx : make_span(indices, n)) fill_n_storage(s, idx);
+      },
+      s);
+}
+
+// Optimization for storages of arithmetic values with plain references: an invalid
+// index is replaced by the first cell, to which zero is added. The loop then has no
+// branch which depends on the data. This is much faster if a large fraction of the
+// values is outside of an axis without flow bins, because the branch would often be
+// mispredicted.
+template <class S, class Index>
+void fill_n_storage_n(std::true_type, S& s, const Index* indices, const std::size_t n) {
+  using T = typename S::value_type;
+  if (s.size() == 0) return; // all indices are invalid
+  for (auto&& idx : make_span(indices, n)) {
+    // mask is all ones for valid index and zero otherwise
+    const auto mask = std::size_t{0} - is_valid(idx);
+    s[idx & mask] += static_cast<T>(mask & 1);
+  }
+}
+
+template <class S, class Index, class T>
+void fill_n_storage_n(std::true_type, S& s, const Index* indices, const std::size_t n,
+                      weight_type<T>&& w) {
+  if (s.size() == 0) { // all indices are invalid
+    if (w.value.second) w.value.first += n;
+    return;
+  }
+  for (auto&& idx : make_span(indices, n)) {
+    // mask is all ones for valid index and zero otherwise
+    const auto mask = std::size_t{0} - is_valid(idx);
+    s[idx & mask] += mask ? *w.value.first : 0;
+    if (w.value.second) ++w.value.first;
+  }
+}
+
+// samples or other arguments: no optimization
+template <class S, class Index, class... Ts>
+void fill_n_storage_n(std::true_type, S& s, const Index* indices, const std::size_t n,
+                      Ts&&... ts) {
+  fill_n_storage_n(std::false_type{}, s, indices, n, std::forward<Ts>(ts)...);
+}
+
+// arithmetic type of the counters in a thread-safe storage, void for other cells
+template <class T>
+struct atomic_counter_value {
+  using type = mp11::mp_if<std::is_arithmetic<T>, T, void>;
+};
+
+template <class T>
+struct atomic_counter_value<accumulators::count<T, true>> {
+  using type = T;
+};
+
+template <class S, class... Ts>
+struct can_preaggregate : std::false_type {};
+
+template <class S>
+struct can_preaggregate<S>
+    : mp11::mp_bool<(S::has_threading_support &&
+                     !std::is_void<typename atomic_counter_value<
+                         typename S::value_type>::type>::value)> {};
+
+// weights are summed per cell, which is only exact enough for floating point counters
+template <class S, class T>
+struct can_preaggregate<S, weight_type<T>>
+    : mp11::mp_and<can_preaggregate<S>,
+                   std::is_floating_point<typename atomic_counter_value<
+                       typename S::value_type>::type>> {};
+
+template <class T>
+void preaggregate_element(T& x) noexcept {
+  ++x;
+}
+
+template <class T, class U>
+void preaggregate_element(T& x, weight_type<U>& w) noexcept {
+  x += static_cast<T>(*w.value.first);
+}
+
+template <class S, class Index, class... Ts>
+void fill_n_storage_preaggregated(std::false_type, S&, const Index*, const std::size_t,
+                                  Ts&&...) {}
+
+// Optimization for thread-safe storages of counters: the increments are first summed
+// per cell in a thread-local buffer, and then each touched cell is updated with one
+// atomic operation. This is much faster if the values fall into few cells, since
+// atomic operations on the same cell from several threads are very slow.
+template <class S, class Index, class... Ts>
+void fill_n_storage_preaggregated(std::true_type, S& s, const Index* indices,
+                                  const std::size_t n, Ts&&... ws) {
+  using T = typename atomic_counter_value<typename S::value_type>::type;
+  static thread_local std::vector<T> buffer;
+  if (buffer.size() < s.size()) buffer.resize(s.size());
+  for (auto&& idx : make_span(indices, n)) {
+    if (is_valid(idx)) {
+      assert(idx < s.size());
+      preaggregate_element(buffer[idx], ws...);
+    }
+    // operator folding emulation
+    (void)std::initializer_list<int>{(ws.value.second ? (++ws.value.first, 0) : 0)...};
+  }
+  for (std::size_t i = 0; i < s.size(); ++i) {
+    if (buffer[i] == T{}) continue;
+    s[i] += buffer[i];
+    buffer[i] = T{};
+  }
+}
+
+// fill storage cells for n indices; invalid indices are skipped
+template <class S, class Index, class... Ts>
+void fill_n_storage_n(S& s, const Index* indices, const std::size_t n, Ts&&... ts) {
+  using preaggregate = can_preaggregate<S, std::decay_t<Ts>...>;
+  // the buffer is scanned once per call, which only pays off if cells are reused
+  if (preaggregate::value && s.size() <= n) {
+    fill_n_storage_preaggregated(preaggregate{}, s, indices, n, std::forward<Ts>(ts)...);
+    return;
+  }
+  // storages with increment_n handle the loop themselves, tracking_storage must not see
+  // the accesses to the first cell for invalid indices
+  using branchless = mp11::mp_and<std::is_same<Index, optional_index>,
+                                  std::is_reference<typename S::reference>,
+                                  std::is_arithmetic<typename S::value_type>,
+                                  mp11::mp_not<has_method_increment_n<S, Index>>>;
+  fill_n_storage_n(branchless{}, s, indices, n, std::forward<Ts>(ts)...);
+}
+
+template <class P>
+decltype(auto) value_at(const P& p, const std::size_t i) noexcept {
+  return p.second ? p.first[i] : *p.first;
+}
+
+// like fill_n_storage, but access the i-th element of the extra arguments
+template <class S, class Index, class... Ts>
+void fill_n_storage_at(S& s, const Index idx, const std::size_t i,
+                       const Ts&... ps) noexcept {
+  assert(idx < s.size());
+  (void)i; // may be unused if there are no extra arguments
+  fill_storage_element(s[idx], value_at(ps, i)...);
+}
+
+template <class S, class Index, class T, class... Ts>
+void fill_n_storage_at(S& s, const Index idx, const std::size_t i,
+                       const weight_type<T>& w, const Ts&... ps) noexcept {
+  assert(idx < s.size());
+  fill_storage_element(s[idx], weight(value_at(w.value, i)), value_at(ps, i)...);
+}
+
 // general Nd treatment
 template <class Index, class S, class A, class T, class... Ts>
-void fill_n_nd(const std::size_t offset, S& storage, A& axes, const std::size_t vsize,
-               const T* values, Ts&&... ts) {
+void fill_n_nd(const unsigned nthreads, const std::size_t offset, S& storage, A& axes,
+               const std::size_t vsize, const T* values, Ts&&... ts) {
   constexpr std::size_t buffer_size = 1ul << 14;
-  Index indices[buffer_size];
 
   /*
     Parallelization options.
@@ -215,29 +422,142 @@ void fill_n_nd(const std::size_t offset, S& storage, A& axes, const std::size_t
     compete to increment the same cell, no further synchronization is required.
 
     In all cases, growing axes cannot be parallelized.
+
+    B) and C) are implemented below. Each thread computes the indices for one buffer
+    per round. C) is used if the storage is large and distinct cells can be written
+    concurrently, which is not the case if the storage returns proxy references (the
+    proxies of unlimited_storage may reallocate the whole buffer, for example).
+    Instead of a full sort, the range of cell indices is split into one contiguous
+    subrange per thread and the value positions are bucketed by subrange with a
+    counting sort, which keeps the original order inside each bucket. In both cases,
+    each cell receives its updates in the original order of the values, so the
+    result is identical to the single-threaded result.
   */
 
+  bool growing = false;
+  for_each_axis(axes, [&growing](const auto& a) {
+    growing |= (axis::traits::options(a) & axis::option::growth) != 0;
+  });
+
+  const auto nbuffers = (vsize + buffer_size - 1) / buffer_size;
+  const auto nt = static_cast<unsigned>(std::min<std::size_t>(nthreads, nbuffers));
+  if (nt > 1 && !growing) {
+    const std::size_t round_size = nt * buffer_size;
+    barrier sync(nt);
+    std::atomic<bool> failed{false};
+    // computes the indices for the values handled by thread tid in the current round
+    auto compute_indices = [&](Index* indices, const std::size_t rstart,
+                               const unsigned tid) {
+      std::exception_ptr error;
+      const std::size_t start = rstart + tid * buffer_size;
+      if (start < vsize) {
+        try {
+          fill_n_indices(indices + tid * buffer_size, start,
+                         std::min(buffer_size, vsize - start), offset, storage, axes,
+                         values);
+        } catch (...) {
+          error = std::current_exception();
+          failed = true;
+        }
+      }
+      return error;
+    };
+
+    if (std::is_reference<typename S::reference>::value &&
+        storage.size() > buffer_size) {
+      // C) cells can be written independently and the storage is large
+      std::unique_ptr<Index[]> indices(new Index[round_size]);
+      std::unique_ptr<std::size_t[]> order(new std::size_t[round_size]);
+      std::vector<std::size_t> counts(nt * nt), positions(nt * nt);
+      const std::size_t cells_per_thread = (storage.size() + nt - 1) / nt;
+      parallel_for(nt, [&](const unsigned tid) {
+        const auto pos = positions.begin() + tid * nt;
+        const std::size_t kbegin = tid * buffer_size;
+        for (std::size_t rstart = 0; rstart < vsize; rstart += round_size) {
+          const std::size_t kend =
+              kbegin + std::min(buffer_size, vsize - std::min(vsize, rstart + kbegin));
+          // compute indices and count how many fall into the range of each thread...
+          const auto error = compute_indices(indices.get(), rstart, tid);
+          const auto cnt = counts.begin() + tid * nt;
+          std::fill(cnt, cnt + nt, 0);
+          if (!error) {
+            for (std::size_t k = kbegin; k < kend; ++k)
+              if (is_valid(indices[k])) ++cnt[indices[k] / cells_per_thread];
+          }
+          sync.wait();
+          if (error) std::rethrow_exception(error);
+          if (failed) return;
+          // ...then sort the value positions by range, order inside a range is kept...
+          std::size_t range_begin = 0, my_begin = 0, my_end = 0;
+          for (unsigned r = 0; r < nt; ++r) {
+            std::size_t n = 0;
+            for (unsigned t = 0; t < nt; ++t) {
+              if (t == tid) pos[r] = range_begin + n;
+              n += counts[t * nt + r];
+            }
+            if (r == tid) {
+              my_begin = range_begin;
+              my_end = range_begin + n;
+            }
+            range_begin += n;
+          }
+          for (std::size_t k = kbegin; k < kend; ++k)
+            if (is_valid(indices[k])) order[pos[indices[k] / cells_per_thread]++] = k;
+          sync.wait();
+          // ...and fill the cells in own range
+          for (std::size_t j = my_begin; j < my_end; ++j) {
+            const auto k = order[j];
+            fill_n_storage_at(storage, indices[k], rstart + k, ts...);
+          }
+          sync.wait();
+        }
+      });
+      return;
+    }
+
+    // B) the index buffer is doubled, so that the main thread can fill the storage
+    // from the indices of the previous round while the other threads already
+    // compute the next round
+    std::unique_ptr<Index[]> buffer(new Index[2 * round_size]);
+    parallel_for(nt, [&](const unsigned tid) {
+      for (std::size_t round = 0, rstart = 0; rstart < vsize;
+           ++round, rstart += round_size) {
+        Index* const indices = buffer.get() + (round % 2) * round_size;
+        const auto error = compute_indices(indices, rstart, tid);
+        sync.wait();
+        if (error) std::rethrow_exception(error);
+        if (failed) return;
+        if (tid == 0)
+          fill_n_storage_n(storage, indices, std::min(round_size, vsize - rstart),
+                           std::forward<Ts>(ts)...);
+      }
+    });
+    return;
+  }
+
+  Index indices[buffer_size];
   for (std::size_t start = 0; start < vsize; start += buffer_size) {
     const std::size_t n = std::min(buffer_size, vsize - start);
     // fill buffer of indices...
     fill_n_indices(indices, start, n, offset, storage, axes, values);
     // ...and fill corresponding storage cells
-    for (auto&& idx : make_span(indices, n))
-      fill_n_storage(storage, idx, std::forward<Ts>(ts)...);
+    fill_n_storage_n(storage, indices, n, std::forward<Ts>(ts)...);
   }
 }
 
 template <class S, class... As, class T, class... Us>
-void fill_n_1(const std::size_t offset, S& storage, std::tuple<As...>& axes,
-              const std::size_t vsize, const T* values, Us&&... us) {
+void fill_n_1(const unsigned nthreads, const std::size_t offset, S& storage,
+              std::tuple<As...>& axes, const std::size_t vsize, const T* values,
+              Us&&... us) {
   using index_type =
       mp11::mp_if<has_non_inclusive_axis<std::tuple<As...>>, optional_index, std::size_t>;
-  fill_n_nd<index_type>(offset, storage, axes, vsize, values, std::forward<Us>(us)...);
+  fill_n_nd<index_type>(nthreads, offset, storage, axes, vsize, values,
+                        std::forward<Us>(us)...);
 }
 
 template <class S, class A, class T, class... Us>
-void fill_n_1(const std::size_t offset, S& storage, A& axes, const std::size_t vsize,
-              const T* values, Us&&... us) {
+void fill_n_1(const unsigned nthreads, const std::size_t offset, S& storage, A& axes,
+              const std::size_t vsize, const T* values, Us&&... us) {
   bool all_inclusive = true;
   for_each_axis(axes,
                 [&](const auto& ax) { all_inclusive &= axis::traits::inclusive(ax); });
@@ -246,15 +566,16 @@ void fill_n_1(const std::size_t offset, S& storage, A& axes, const std::size_t v
     axis::visit(
         [&](auto& ax) {
           std::tuple<decltype(ax)> axes{ax};
-          fill_n_1(offset, storage, axes, vsize, values, std::forward<Us>(us)...);
+          fill_n_1(nthreads, offset, storage, axes, vsize, values,
+                   std::forward<Us>(us)...);
         },
         axes[0]);
   } else {
     if (all_inclusive)
-      fill_n_nd<std::size_t>(offset, storage, axes, vsize, values,
+      fill_n_nd<std::size_t>(nthreads, offset, storage, axes, vsize, values,
                              std::forward<Us>(us)...);
     else
-      fill_n_nd<optional_index>(offset, storage, axes, vsize, values,
+      fill_n_nd<optional_index>(nthreads, offset, storage, axes, vsize, values,
                                 std::forward<Us>(us)...);
   }
 }
@@ -310,8 +631,8 @@ void fill_n_check_extra_args(std::size_t size, weight_type<T>&& w, Ts&&... ts) {
 }
 
 template <class S, class A, class T, std::size_t N, class... Us>
-void fill_n(std::true_type, const std::size_t offset, S& storage, A& axes,
-            const dtl::span<const T, N> values, Us&&... us) {
+void fill_n(std::true_type, const unsigned nthreads, const std::size_t offset,
+            S& storage, A& axes, const dtl::span<const T, N> values, Us&&... us) {
   // supported cases (T = value type; CT = containter of T; V<T, CT, ...> = variant):
   // - span<T, N>: only valid for 1D histogram, N > 1 allowed
   // - span<CT, N>: for any histogram, N == rank
@@ -323,7 +644,8 @@ void fill_n(std::true_type, const std::size_t offset, S& storage, A& axes,
           BOOST_THROW_EXCEPTION(
               std::invalid_argument("number of arguments must match histogram rank"));
         fill_n_check_extra_args(values.size(), std::forward<Us>(us)...);
-        fill_n_1(offset, storage, axes, values.size(), &values, std::forward<Us>(us)...);
+        fill_n_1(nthreads, offset, storage, axes, values.size(), &values,
+                 std::forward<Us>(us)...);
       },
       [&](const auto& values, auto&&... us) {
         // generic ND case
@@ -332,7 +654,8 @@ void fill_n(std::true_type, const std::size_t offset, S& storage, A& axes,
               std::invalid_argument("number of arguments must match histogram rank"));
         const auto vsize = get_total_size(axes, values);
         fill_n_check_extra_args(vsize, std::forward<Us>(us)...);
-        fill_n_1(offset, storage, axes, vsize, values.data(), std::forward<Us>(us)...);
+        fill_n_1(nthreads, offset, storage, axes, vsize, values.data(),
+                 std::forward<Us>(us)...);
       },
       values, std::forward<Us>(us)...);
 }
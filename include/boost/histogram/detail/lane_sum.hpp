@@ -0,0 +1,91 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_DETAIL_LANE_SUM_HPP
+#define BOOST_HISTOGRAM_DETAIL_LANE_SUM_HPP
+
+#include <boost/histogram/accumulators/sum.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace boost {
+namespace histogram {
+namespace detail {
+
+/*
+  Kernels to add a run of consecutive cells to an accurate sum, used by algorithm::sum.
+
+  Floating point values are summed in several independent lanes. Each lane keeps a
+  large and a small part like accumulators::sum, but computes the rounding error of each
+  addition with the TwoSum algorithm of Knuth instead of comparing magnitudes. This gives
+  the same error bound as the Neumaier algorithm without branches. The lanes break the
+  dependency chain between successive additions, so that the compiler can vectorize the
+  loop. The parts of all lanes are added to the result at the end of the run.
+
+  Small integers are summed exactly with a wide integer type in chunks that cannot
+  overflow; each chunk sum is then added to the result.
+
+  Like accumulators::sum, this relies on strict floating point semantics. With
+  -ffast-math, the compiler may remove the compensation.
+*/
+constexpr unsigned lane_sum_lanes = 8;
+
+// floating point values, 64 bit integers, and other values convertible to double
+template <class Src>
+void lane_sum(std::false_type, const Src& src, std::size_t i, const std::size_t n,
+              accumulators::sum<double>& result) {
+  constexpr unsigned L = lane_sum_lanes;
+  double large[L] = {}, small[L] = {};
+  const auto end = i + n;
+  for (; i + L <= end; i += L) {
+    for (unsigned k = 0; k < L; ++k) {
+      const auto x = static_cast<double>(src[i + k]);
+      const auto t = large[k] + x;
+      const auto b = t - large[k];
+      small[k] += (large[k] - (t - b)) + (x - b);
+      large[k] = t;
+    }
+  }
+  for (; i < end; ++i) result += static_cast<double>(src[i]);
+  for (unsigned k = 0; k < L; ++k) result += large[k];
+  double s = 0;
+  for (unsigned k = 0; k < L; ++k) s += small[k];
+  result += s;
+}
+
+// integers with at most 32 bits; a chunk of 2^31 values cannot overflow a 64 bit sum
+template <class Src>
+void lane_sum(std::true_type, const Src& src, std::size_t i, const std::size_t n,
+              accumulators::sum<double>& result) {
+  using T = std::decay_t<decltype(src[0])>;
+  using U = std::conditional_t<std::is_signed<T>::value, std::int64_t, std::uint64_t>;
+  constexpr std::size_t chunk = std::size_t{1} << 31;
+  for (const auto end = i + n; i < end;) {
+    const auto chunk_end = end - i > chunk ? i + chunk : end;
+    U s = 0;
+    for (; i < chunk_end; ++i) s += static_cast<U>(src[i]);
+    result += static_cast<double>(s);
+  }
+}
+
+template <class T>
+using use_integer_lane_sum =
+    std::integral_constant<bool, std::is_integral<T>::value && sizeof(T) <= 4>;
+
+// adds the values src[i], ..., src[i + n - 1] to result
+template <class Src>
+void lane_sum(const Src& src, std::size_t i, const std::size_t n,
+              accumulators::sum<double>& result) {
+  using T = std::decay_t<decltype(src[0])>;
+  lane_sum(use_integer_lane_sum<T>{}, src, i, n, result);
+}
+
+} // namespace detail
+} // namespace histogram
+} // namespace boost
+
+#endif
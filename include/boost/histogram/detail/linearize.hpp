@@ -42,11 +42,11 @@ std::size_t linearize(Opts, optional_index& out, const std::size_t stride,
   constexpr bool o = Opts::test(axis::option::overflow);
   assert(idx >= -1);
   assert(idx < size + 1);
-  const bool is_valid = (u || idx >= 0) && (o || idx < size);
-  if (is_valid)
-    out += idx * stride;
-  else
-    out = invalid_index;
+  // computed with a bit mask instead of branches, because is_valid is often
+  // unpredictable; mask is all ones if index is valid and zero otherwise
+  const auto mask = std::size_t{0} - ((u | (idx >= 0)) & (o | (idx < size)) &
+                                      (out.value != invalid_index));
+  out = ((out.value + idx * stride) & mask) | ~mask;
   return size + u + o;
 }
 
@@ -84,6 +84,33 @@ std::size_t linearize_growth(Index& out, axis::index_type& shift,
   return axis::traits::extent(a);
 }
 
+/**
+  Like linearize_growth, but never grows the axis, so that the axis is not modified.
+  Returns zero if the axis would need to grow to include the value.
+
+  Initial offset of `out` must be zero.
+*/
+template <class Index, class Axis, class Value>
+std::size_t linearize_if_no_growth(Index& out, const std::size_t stride, const Axis& a,
+                                   const Value& v) {
+  using opts = axis::traits::get_options<Axis>;
+  constexpr axis::index_type u = opts::test(axis::option::underflow);
+  constexpr axis::index_type o = opts::test(axis::option::overflow);
+  const auto idx = axis::traits::index(a, v);
+  if (opts::test(axis::option::growth) && (idx < 0 || idx >= a.size())) return 0;
+  if (-u <= idx && idx < a.size() + o)
+    out += (idx + u) * stride;
+  else
+    out = invalid_index;
+  return axis::traits::extent(a);
+}
+
+// grow axis to include value, return shift
+template <class Axis, class Value>
+axis::index_type update_shift(Axis& a, const Value& v) {
+  return axis::traits::update(a, v).second;
+}
+
 // initial offset of out must be zero
 template <class A>
 std::size_t linearize_index(optional_index& out, const std::size_t stride, const A& ax,
@@ -125,6 +152,18 @@ std::size_t linearize_growth(Index& o, axis::index_type& sh, const std::size_t s
   return axis::visit([&](auto& a) { return linearize_growth(o, sh, st, a, v); }, a);
 }
 
+template <class Index, class... Ts, class Value>
+std::size_t linearize_if_no_growth(Index& o, const std::size_t s,
+                                   const axis::variant<Ts...>& a, const Value& v) {
+  return axis::visit([&](const auto& a) { return linearize_if_no_growth(o, s, a, v); },
+                     a);
+}
+
+template <class... Ts, class Value>
+axis::index_type update_shift(axis::variant<Ts...>& a, const Value& v) {
+  return axis::visit([&v](auto& a) { return update_shift(a, v); }, a);
+}
+
 } // namespace detail
 } // namespace histogram
 } // namespace boost
@@ -7,23 +7,31 @@
 #ifndef BOOST_HISTOGRAM_DETAIL_MAKE_DEFAULT_HPP
 #define BOOST_HISTOGRAM_DETAIL_MAKE_DEFAULT_HPP
 
+#include <boost/histogram/detail/priority.hpp>
+
 namespace boost {
 namespace histogram {
 namespace detail {
 
+// storages with a configuration beyond the allocator provide make_default
+template <class T>
+T make_default_impl(const T& t, priority<2>, decltype(t.make_default(), 0) = 0) {
+  return t.make_default();
+}
+
 template <class T>
-T make_default_impl(const T& t, decltype(t.get_allocator(), 0)) {
+T make_default_impl(const T& t, priority<1>, decltype(t.get_allocator(), 0) = 0) {
   return T(t.get_allocator());
 }
 
 template <class T>
-T make_default_impl(const T&, float) {
+T make_default_impl(const T&, priority<0>) {
   return T{};
 }
 
 template <class T>
 T make_default(const T& t) {
-  return make_default_impl(t, 0);
+  return make_default_impl(t, priority<2>{});
 }
 
 } // namespace detail
@@ -9,23 +9,51 @@
 
 #include <boost/core/empty_value.hpp>
 #include <boost/histogram/detail/axes.hpp>
+#include <boost/histogram/detail/spin_mutex.hpp>
 #include <boost/mp11/utility.hpp> // mp_if
+#include <atomic>
 #include <mutex>
+#include <thread>
 
 namespace boost {
 namespace histogram {
 namespace detail {
 
-struct null_mutex {
-  bool try_lock() noexcept { return true; }
-  void lock() noexcept {}
-  void unlock() noexcept {}
+// Reader-writer lock for data which is rarely modified. Shared locking and unlocking
+// take one atomic operation each if there is no writer; a waiting writer blocks new
+// readers and spins until the current readers are done.
+class reader_writer_mutex {
+public:
+  void lock_shared() noexcept {
+    while (state_.fetch_add(1, std::memory_order_acquire) & writer) {
+      // back off while writer holds or waits for the lock
+      state_.fetch_sub(1, std::memory_order_relaxed);
+      while (state_.load(std::memory_order_relaxed) & writer) std::this_thread::yield();
+    }
+  }
+
+  void unlock_shared() noexcept { state_.fetch_sub(1, std::memory_order_release); }
+
+  void lock() noexcept {
+    while (state_.fetch_or(writer, std::memory_order_acquire) & writer)
+      std::this_thread::yield();
+    while (state_.load(std::memory_order_acquire) != writer) std::this_thread::yield();
+  }
+
+  // readers which are backing off may still hold a count, so only clear writer bit
+  void unlock() noexcept { state_.fetch_and(~writer, std::memory_order_release); }
+
+private:
+  static constexpr unsigned writer = 1u << 31;
+  std::atomic<unsigned> state_{0};
 };
 
+// Filling with growing axes and thread-safe storage takes a shared lock if no axis
+// needs to grow and an exclusive lock otherwise, see detail/fill.hpp.
 template <class Axes, class Storage,
           class DetailMutex = mp11::mp_if_c<(Storage::has_threading_support &&
                                              detail::has_growing_axis<Axes>::value),
-                                            std::mutex, detail::null_mutex>>
+                                            reader_writer_mutex, detail::null_mutex>>
 struct mutex_base : empty_value<DetailMutex> {
   mutex_base() = default;
   // do not copy or move mutex
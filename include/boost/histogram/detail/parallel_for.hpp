@@ -0,0 +1,72 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_DETAIL_PARALLEL_FOR_HPP
+#define BOOST_HISTOGRAM_DETAIL_PARALLEL_FOR_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace boost {
+namespace histogram {
+namespace detail {
+
+// reusable thread barrier, std::barrier is only available in C++20
+class barrier {
+public:
+  explicit barrier(unsigned n) noexcept : size_(n), waiting_(n) {}
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto generation = generation_;
+    if (--waiting_ == 0) {
+      waiting_ = size_;
+      ++generation_;
+      cv_.notify_all();
+    } else {
+      cv_.wait(lock, [this, generation] { return generation != generation_; });
+    }
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  const unsigned size_;
+  unsigned waiting_;
+  std::size_t generation_ = 0;
+};
+
+// Calls f(i) for i in [0, n), each call runs in its own thread; f(0) runs in the
+// calling thread. Returns after all threads have finished. If any call throws, the
+// first exception is rethrown in the calling thread.
+template <class F>
+void parallel_for(const unsigned n, F&& f) {
+  std::vector<std::exception_ptr> errors(n);
+  auto guarded = [&f, &errors](unsigned i) {
+    try {
+      f(i);
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(n);
+  for (unsigned i = 1; i < n; ++i) threads.emplace_back(guarded, i);
+  guarded(0);
+  for (auto&& t : threads) t.join();
+  for (auto&& e : errors)
+    if (e) std::rethrow_exception(e);
+}
+
+} // namespace detail
+} // namespace histogram
+} // namespace boost
+
+#endif
@@ -0,0 +1,57 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_DETAIL_SPIN_MUTEX_HPP
+#define BOOST_HISTOGRAM_DETAIL_SPIN_MUTEX_HPP
+
+#include <boost/core/empty_value.hpp>
+#include <boost/mp11/utility.hpp> // mp_if_c
+#include <atomic>
+#include <thread>
+
+namespace boost {
+namespace histogram {
+namespace detail {
+
+struct null_mutex {
+  bool try_lock() noexcept { return true; }
+  void lock() noexcept {}
+  void unlock() noexcept {}
+};
+
+// Mutex for very short critical sections, like the update of an accumulator. It has
+// the size of a bool, so that each cell of a storage can have its own. Copies are
+// always unlocked, so that accumulators which contain it remain copyable.
+class spin_mutex {
+public:
+  spin_mutex() noexcept = default;
+  spin_mutex(const spin_mutex&) noexcept {}
+  spin_mutex& operator=(const spin_mutex&) noexcept { return *this; }
+
+  bool try_lock() noexcept { return !locked_.exchange(true, std::memory_order_acquire); }
+
+  void lock() noexcept {
+    while (locked_.exchange(true, std::memory_order_acquire))
+      // wait without writing to the cache line
+      while (locked_.load(std::memory_order_relaxed)) std::this_thread::yield();
+  }
+
+  void unlock() noexcept { locked_.store(false, std::memory_order_release); }
+
+private:
+  std::atomic<bool> locked_{false};
+};
+
+// base class for accumulators, which takes no space if no thread-safety is requested
+template <bool ThreadSafe>
+using accumulator_mutex_base =
+    empty_value<mp11::mp_if_c<ThreadSafe, spin_mutex, null_mutex>>;
+
+} // namespace detail
+} // namespace histogram
+} // namespace boost
+
+#endif
@@ -0,0 +1,242 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_DETAIL_STRIDED_SUM_HPP
+#define BOOST_HISTOGRAM_DETAIL_STRIDED_SUM_HPP
+
+#include <algorithm>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/detail/optional_index.hpp>
+#include <boost/histogram/detail/parallel_for.hpp>
+#include <boost/histogram/detail/static_if.hpp>
+#include <boost/histogram/unlimited_storage.hpp>
+#include <boost/histogram/unsafe_access.hpp>
+#include <boost/mp11/utility.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace boost {
+namespace histogram {
+namespace detail {
+
+/*
+  Kernel to sum the cells of a source storage into the cells of a destination buffer,
+  used by algorithms which remove, merge, or drop cells of a histogram.
+
+  For each axis of the source, the kernel gets the offset in the destination of each
+  cell along that axis (flow cells included), or invalid_index if cells at that position
+  are dropped. A source cell is added to the destination cell at the sum of its offsets.
+
+  The kernel walks through the source storage in memory order and computes offsets only
+  once per run of cells along the innermost axes. If the leading axes are summed over
+  (all offsets are zero), their cells are contiguous and are reduced with independent
+  partial sums, which the compiler can vectorize. Otherwise, the cells of the first axis
+  are added one by one, without a table lookup if the offsets have a constant stride.
+*/
+using cell_offsets = std::vector<std::vector<std::size_t>>;
+
+inline bool all_zero(const std::vector<std::size_t>& v) noexcept {
+  return std::all_of(v.begin(), v.end(), [](std::size_t x) { return x == 0; });
+}
+
+// returns s if v is 0, s, 2 s, ... with s > 0, else zero
+inline std::size_t constant_stride(const std::vector<std::size_t>& v) noexcept {
+  const std::size_t s = v.size() > 1 ? v[1] : 1;
+  if (s == 0 || s == invalid_index) return 0;
+  for (std::size_t i = 0; i < v.size(); ++i)
+    if (v[i] != i * s) return 0;
+  return s;
+}
+
+// true if the valid offsets in v never decrease
+inline bool is_ascending(const std::vector<std::size_t>& v) noexcept {
+  std::size_t prev = 0;
+  for (auto x : v) {
+    if (x == invalid_index) continue;
+    if (x < prev) return false;
+    prev = x;
+  }
+  return true;
+}
+
+// arithmetic values: four independent partial sums break the dependency chain
+template <class Src, class T>
+void sum_run(std::true_type, const Src& src, std::size_t i, const std::size_t n,
+             T& dst) {
+  T s[4] = {};
+  const auto end = i + n;
+  for (; i + 4 <= end; i += 4) {
+    s[0] += src[i];
+    s[1] += src[i + 1];
+    s[2] += src[i + 2];
+    s[3] += src[i + 3];
+  }
+  for (; i < end; ++i) s[0] += src[i];
+  dst += (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+// accumulators and other values: add one by one
+template <class Src, class T>
+void sum_run(std::false_type, const Src& src, std::size_t i, const std::size_t n,
+             T& dst) {
+  for (const auto end = i + n; i < end; ++i) dst += src[i];
+}
+
+// sums source cells whose index on the outermost axis is in [first, last)
+template <class Src, class Dst>
+void strided_sum_range(const cell_offsets& offsets, const Src& src, Dst& dst,
+                       const std::size_t first, const std::size_t last) {
+  using T = std::decay_t<decltype(dst[0])>;
+  const std::size_t rank = offsets.size();
+  // source has no cells if any axis has none
+  for (auto&& o : offsets)
+    if (o.empty()) return;
+
+  // leading axes which are summed over form one contiguous run
+  std::size_t m = 0, run = 1;
+  while (m < rank && all_zero(offsets[m])) run *= offsets[m++].size();
+  if (m == rank) {
+    if (run > 0) sum_run(std::is_arithmetic<T>{}, src, 0, run, dst[0]);
+    return;
+  }
+  const auto& inner = offsets[0];
+  if (m == 0 && rank == 1) {
+    for (std::size_t j = first; j < last; ++j)
+      if (inner[j] != invalid_index) dst[inner[j]] += src[j];
+    return;
+  }
+  // else the run consists of the cells along the first axis
+  const bool reduce = m > 0;
+  if (!reduce) {
+    run = offsets[0].size();
+    m = 1;
+  }
+  const std::size_t stride = reduce ? 0 : constant_stride(inner);
+
+  std::vector<std::size_t> idx(rank, 0);
+  idx[rank - 1] = first;
+  std::size_t i = first * run;
+  for (std::size_t k = m; k + 1 < rank; ++k) i *= offsets[k].size();
+  while (idx[rank - 1] < last) {
+    std::size_t o = 0;
+    for (std::size_t k = m; k < rank; ++k) {
+      const auto ok = offsets[k][idx[k]];
+      if (ok == invalid_index) {
+        o = invalid_index;
+        break;
+      }
+      o += ok;
+    }
+    if (o != invalid_index) {
+      if (reduce) {
+        sum_run(std::is_arithmetic<T>{}, src, i, run, dst[o]);
+      } else if (stride == 1) {
+        for (std::size_t j = 0; j < run; ++j) dst[o + j] += src[i + j];
+      } else if (stride > 0) {
+        for (std::size_t j = 0; j < run; ++j) dst[o + j * stride] += src[i + j];
+      } else {
+        for (std::size_t j = 0; j < run; ++j)
+          if (inner[j] != invalid_index) dst[o + inner[j]] += src[i + j];
+      }
+    }
+    i += run;
+    // advance index of outer axes
+    std::size_t k = m;
+    while (k + 1 < rank && ++idx[k] == offsets[k].size()) idx[k++] = 0;
+    if (k + 1 == rank) ++idx[k];
+  }
+}
+
+// Adds the cells of src to dst, see above. With several threads, the cells along the
+// outermost axis are split into ranges. If the offsets of the outermost axis ascend,
+// the ranges are chosen so that the threads write to different destination cells.
+// Otherwise, each thread sums into its own buffer, and the buffers are added at the end.
+template <class Src, class T>
+void strided_sum(unsigned nthreads, const cell_offsets& offsets, const Src& src,
+                 std::vector<T>& dst) {
+  const std::size_t rank = offsets.size();
+  const std::size_t n = rank > 0 ? offsets[rank - 1].size() : 0;
+  std::size_t nleading = 0;
+  while (nleading < rank && all_zero(offsets[nleading])) ++nleading;
+  nthreads = static_cast<unsigned>((std::min)(std::size_t{nthreads}, n));
+  if (nthreads <= 1 || nleading == rank) {
+    strided_sum_range(offsets, src, dst, 0, n);
+    return;
+  }
+
+  const auto& outer = offsets[rank - 1];
+  const bool shared = !all_zero(outer) && is_ascending(outer);
+  std::vector<std::size_t> bounds(nthreads + 1, n);
+  for (unsigned t = 0; t < nthreads; ++t) {
+    auto b = t * n / nthreads;
+    // cells with the same offset must be handled by the same thread
+    if (shared) {
+      std::size_t prev = invalid_index;
+      for (auto j = b; j > 0 && prev == invalid_index;) prev = outer[--j];
+      while (b < n && (outer[b] == invalid_index || outer[b] == prev)) ++b;
+    }
+    bounds[t] = (std::max)(b, t > 0 ? bounds[t - 1] : 0);
+  }
+
+  std::vector<std::vector<T>> buffers(shared ? 0 : nthreads - 1,
+                                      std::vector<T>(dst.size()));
+  parallel_for(nthreads, [&](unsigned t) {
+    auto& d = (shared || t == 0) ? dst : buffers[t - 1];
+    strided_sum_range(offsets, src, d, bounds[t], bounds[t + 1]);
+  });
+  for (auto&& b : buffers)
+    for (std::size_t i = 0; i < dst.size(); ++i) dst[i] += b[i];
+}
+
+// values are summed in a plain buffer, which is then copied into the storage; values
+// without operator== cannot be compared with zero and are all copied
+template <class Buffer, class S>
+void copy_nonzero(const Buffer& buffer, S& s) {
+  using T = typename Buffer::value_type;
+  static_if<has_operator_equal<T>>(
+      [&s](const auto& b) {
+        for (std::size_t i = 0; i < b.size(); ++i)
+          if (!(b[i] == T{})) s[i] = b[i];
+      },
+      [&s](const auto& b) {
+        for (std::size_t i = 0; i < b.size(); ++i) s[i] = b[i];
+      },
+      buffer);
+}
+
+// Sums the cells of storage src into the empty storage dst, see strided_sum.
+template <class S>
+void strided_sum_storage(unsigned nthreads, const cell_offsets& offsets, const S& src,
+                         S& dst) {
+  std::vector<typename S::value_type> buffer(dst.size());
+  strided_sum(nthreads, offsets, src, buffer);
+  copy_nonzero(buffer, dst);
+}
+
+// type of the cells is looked up once and the sums are computed with a type that
+// cannot overflow; the result is stored with the smallest type that fits
+template <class A>
+void strided_sum_storage(unsigned nthreads, const cell_offsets& offsets,
+                         const unlimited_storage<A>& src, unlimited_storage<A>& dst) {
+  using large_int = typename unlimited_storage<A>::large_int;
+  unsafe_access::unlimited_storage_buffer(src).visit([&](const auto* p) {
+    using T = std::decay_t<decltype(*p)>;
+    using U = mp11::mp_cond<std::is_same<T, std::uint64_t>, large_int,
+                            std::is_integral<T>, std::uint64_t, std::true_type, T>;
+    std::vector<U> buffer(dst.size());
+    strided_sum(nthreads, offsets, p, buffer);
+    copy_nonzero(buffer, dst);
+  });
+}
+
+} // namespace detail
+} // namespace histogram
+} // namespace boost
+
+#endif
@@ -0,0 +1,364 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_FILL_GROUP_HPP
+#define BOOST_HISTOGRAM_FILL_GROUP_HPP
+
+#include <algorithm>
+#include <boost/histogram/axis/option.hpp>
+#include <boost/histogram/axis/traits.hpp>
+#include <boost/histogram/axis/variant.hpp>
+#include <boost/histogram/detail/accumulator_traits.hpp>
+#include <boost/histogram/detail/axes.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/detail/fill.hpp>
+#include <boost/histogram/detail/fill_n.hpp>
+#include <boost/histogram/detail/nonmember_container_access.hpp>
+#include <boost/histogram/detail/optional_index.hpp>
+#include <boost/histogram/detail/span.hpp>
+#include <boost/histogram/detail/static_if.hpp>
+#include <boost/histogram/fwd.hpp>
+#include <boost/histogram/sample.hpp>
+#include <boost/histogram/unsafe_access.hpp>
+#include <boost/histogram/weight.hpp>
+#include <boost/mp11/tuple.hpp>
+#include <boost/throw_exception.hpp>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace histogram {
+namespace detail {
+
+// histogram of a fill group together with its columns and extra arguments
+template <class Histogram, class Args>
+struct fill_group_entry {
+  Histogram& hist;
+  std::vector<unsigned> columns;
+  // weight and sample arguments as pointer-size pairs, see to_ptr_size
+  Args args;
+};
+
+// unique address for each type, used to compare axes of different types
+template <class T>
+const void* fill_group_type_id() noexcept {
+  static const char id = 0;
+  return &id;
+}
+
+// axis whose indices are computed once for all entries with an equal axis on the
+// same column
+struct fill_group_axis {
+  unsigned column;
+  const void* type;
+  const void* axis;
+  // computes the index of each value along the axis, or invalid_index
+  std::function<void(optional_index*, std::size_t, std::size_t)> compute;
+};
+
+template <class T>
+auto fill_group_weight(const weight_type<T>& w) {
+  return std::make_tuple(weight(to_ptr_size(w.value)));
+}
+
+template <class... Ts>
+auto fill_group_sample(const sample_type<std::tuple<Ts...>>& s) {
+  return mp11::tuple_apply(
+      [](const auto&... xs) { return std::make_tuple(to_ptr_size(xs)...); }, s.value);
+}
+
+template <class Histogram, class Weight, class Sample>
+auto make_fill_group_entry(Histogram& h, std::vector<unsigned> columns, Weight&& w,
+                           Sample&& s) {
+  auto args = std::tuple_cat(std::forward<Weight>(w), std::forward<Sample>(s));
+  return fill_group_entry<Histogram, decltype(args)>{h, std::move(columns),
+                                                     std::move(args)};
+}
+
+template <class Histogram>
+std::vector<unsigned> default_fill_group_columns(const Histogram& h) {
+  std::vector<unsigned> columns(h.rank());
+  for (unsigned i = 0; i < columns.size(); ++i) columns[i] = i;
+  return columns;
+}
+
+// number of values in the column, or zero if the column holds a single value
+template <class Axis, class T>
+std::size_t fill_group_column_size(const Axis&, const T& column) {
+  using AV = axis::traits::value_type<Axis>;
+  std::size_t size = 0;
+  maybe_visit(
+      [&size](const auto& v) {
+        using V = std::remove_const_t<std::remove_reference_t<decltype(v)>>;
+        static_if_c<(std::is_convertible<decltype(v), AV>::value ||
+                     !is_iterable<V>::value)>(
+            [](const auto&) {}, [&size](const auto& v) { size = dtl::size(v); }, v);
+      },
+      column);
+  return size;
+}
+
+template <class T, class Entry>
+void fill_group_register(std::vector<fill_group_axis>& shared,
+                         std::vector<std::size_t>& map,
+                         std::vector<std::size_t>& strides, std::size_t& vsize,
+                         const dtl::span<const T> values, const Entry& e) {
+  const auto& axes = unsafe_access::axes(e.hist);
+  if (e.columns.size() != axes_rank(axes))
+    BOOST_THROW_EXCEPTION(
+        std::invalid_argument("number of columns must match histogram rank"));
+  auto cit = e.columns.begin();
+  std::size_t stride = 1;
+  for_each_axis(axes, [&](const auto& a) {
+    axis::visit(
+        [&](const auto& ax) {
+          using A = std::decay_t<decltype(ax)>;
+          const auto c = *cit++;
+          if (c >= values.size())
+            BOOST_THROW_EXCEPTION(std::invalid_argument("column index out of range"));
+          if (axis::traits::options(ax) & axis::option::growth)
+            BOOST_THROW_EXCEPTION(
+                std::invalid_argument("growing axes cannot be filled in a group"));
+          const auto n = fill_group_column_size(ax, values[c]);
+          if (n > 0) {
+            if (vsize > 0 && vsize != n)
+              BOOST_THROW_EXCEPTION(
+                  std::invalid_argument("spans must have compatible lengths"));
+            vsize = n;
+          }
+          strides.push_back(stride);
+          stride *= static_cast<std::size_t>(axis::traits::extent(ax));
+          const auto type = fill_group_type_id<A>();
+          for (std::size_t k = 0; k < shared.size(); ++k) {
+            const auto& s = shared[k];
+            if (s.column == c && s.type == type && *static_cast<const A*>(s.axis) == ax) {
+              map.push_back(k);
+              return;
+            }
+          }
+          map.push_back(shared.size());
+          const T* column = values.data() + c;
+          shared.push_back(
+              {c, type, &ax, [&ax, column](optional_index* out, std::size_t start,
+                                           std::size_t size) {
+                 // the index of the first bin is zero, including the underflow bin
+                 constexpr bool u = axis::traits::get_options<A>::test(
+                     axis::option::underflow);
+                 std::fill(out, out + size, u ? 1 : 0);
+                 std::size_t unit_stride = 1;
+                 axis::index_type shift = 0;
+                 // index_visitor does not modify a non-growing axis
+                 maybe_visit(index_visitor<optional_index, A, std::false_type>{
+                                 const_cast<A&>(ax), unit_stride, start, size, out,
+                                 &shift},
+                             *column);
+               }});
+        },
+        a);
+  });
+}
+
+// combines the indices along the axes of a histogram into indices of its cells
+inline void fill_group_linearize(optional_index* out, const optional_index* in,
+                                 const std::size_t stride, const std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    // mask is all ones if both indices are valid and zero otherwise
+    const auto mask = std::size_t{0} - (is_valid(out[i]) & is_valid(in[i]));
+    out[i] = ((out[i].value + in[i].value * stride) & mask) | ~mask;
+  }
+}
+
+template <class Entry>
+void fill_group_storage(Entry& e, const optional_index* indices, const std::size_t n) {
+  // pointers in the extra arguments are advanced by the values that were filled
+  mp11::tuple_apply(
+      [&](auto&... xs) {
+        fill_n_storage_n(unsafe_access::storage(e.hist), indices, n, std::move(xs)...);
+      },
+      e.args);
+}
+
+} // namespace detail
+
+/** Create an entry for a group of histograms that are filled together.
+
+  The entry refers to the histogram and the weight or sample arguments, which must
+  outlive the call to fill_group(). Pass the entries directly to fill_group().
+
+  @param h histogram to fill.
+  @param columns index of the column for each axis of the histogram.
+*/
+template <class Axes, class Storage>
+auto fill_entry(histogram<Axes, Storage>& h, std::vector<unsigned> columns) {
+  using acc_traits = detail::accumulator_traits<typename Storage::value_type>;
+  detail::sample_args_passed_vs_expected<std::tuple<>, typename acc_traits::args>();
+  return detail::make_fill_group_entry(h, std::move(columns), std::tuple<>{},
+                                       std::tuple<>{});
+}
+
+/** Create an entry for a group of histograms that are filled together.
+
+  @param h histogram to fill.
+  @param columns index of the column for each axis of the histogram.
+  @param weights single weight or an iterable of weights.
+*/
+template <class Axes, class Storage, class T>
+auto fill_entry(histogram<Axes, Storage>& h, std::vector<unsigned> columns,
+                const weight_type<T>& weights) {
+  using acc_traits = detail::accumulator_traits<typename Storage::value_type>;
+  static_assert(acc_traits::weight_support,
+                "error: accumulator does not support weights");
+  detail::sample_args_passed_vs_expected<std::tuple<>, typename acc_traits::args>();
+  return detail::make_fill_group_entry(
+      h, std::move(columns), detail::fill_group_weight(weights), std::tuple<>{});
+}
+
+/** Create an entry for a group of histograms that are filled together.
+
+  @param h histogram to fill.
+  @param columns index of the column for each axis of the histogram.
+  @param samples single sample or an iterable of samples.
+*/
+template <class Axes, class Storage, class... Ts>
+auto fill_entry(histogram<Axes, Storage>& h, std::vector<unsigned> columns,
+                const sample_type<std::tuple<Ts...>>& samples) {
+  using acc_traits = detail::accumulator_traits<typename Storage::value_type>;
+  using sample_args_passed =
+      std::tuple<decltype(*detail::to_ptr_size(std::declval<Ts>()).first)...>;
+  detail::sample_args_passed_vs_expected<sample_args_passed,
+                                         typename acc_traits::args>();
+  return detail::make_fill_group_entry(h, std::move(columns), std::tuple<>{},
+                                       detail::fill_group_sample(samples));
+}
+
+/** Create an entry for a group of histograms that are filled together.
+
+  @param h histogram to fill.
+  @param columns index of the column for each axis of the histogram.
+  @param weights single weight or an iterable of weights.
+  @param samples single sample or an iterable of samples.
+*/
+template <class Axes, class Storage, class T, class... Ts>
+auto fill_entry(histogram<Axes, Storage>& h, std::vector<unsigned> columns,
+                const weight_type<T>& weights,
+                const sample_type<std::tuple<Ts...>>& samples) {
+  using acc_traits = detail::accumulator_traits<typename Storage::value_type>;
+  static_assert(acc_traits::weight_support,
+                "error: accumulator does not support weights");
+  using sample_args_passed =
+      std::tuple<decltype(*detail::to_ptr_size(std::declval<Ts>()).first)...>;
+  detail::sample_args_passed_vs_expected<sample_args_passed,
+                                         typename acc_traits::args>();
+  return detail::make_fill_group_entry(h, std::move(columns),
+                                       detail::fill_group_weight(weights),
+                                       detail::fill_group_sample(samples));
+}
+
+/** Create an entry for a group of histograms that are filled together.
+
+  The axes of the histogram are filled from the first columns in order.
+
+  @param h histogram to fill.
+*/
+template <class Axes, class Storage>
+auto fill_entry(histogram<Axes, Storage>& h) {
+  return fill_entry(h, detail::default_fill_group_columns(h));
+}
+
+/** Fill several histograms with values from the same columns.
+
+  This is equivalent to calling histogram::fill for each histogram with the columns
+  selected by its entry, but faster if histograms share axes. The bin indices are
+  computed once for all axes that are equal and filled from the same column, and the
+  cells of each histogram are then updated from these shared indices. For a histogram
+  with a single axis, the shared indices are used directly, and the cell indices are
+  computed only once for histograms with equal axes that are filled from the same
+  columns. The values are processed in blocks, so that the indices stay in the cache
+  while the histograms are filled.
+
+  Histograms with growing axes cannot be filled in a group. If an exception is thrown
+  during the index computation, histograms may be partially filled.
+
+  @param columns iterable of columns; a column may be a value, an iterable with
+  contiguous storage over values, or a variant of both, as in histogram::fill.
+  @param entries histograms with their columns and extra arguments, created with
+  fill_entry().
+*/
+template <class Iterable, class... Entries, class = detail::requires_iterable<Iterable>>
+void fill_group(const Iterable& columns, Entries... entries) {
+  constexpr std::size_t buffer_size = 1ul << 14;
+  const auto values = detail::make_span(columns);
+
+  // find unique axes and check arguments before anything is filled
+  std::vector<detail::fill_group_axis> shared;
+  std::vector<std::size_t> map, strides;
+  std::size_t vsize = 0;
+  (void)std::initializer_list<int>{(
+      detail::fill_group_register(shared, map, strides, vsize, values, entries), 0)...};
+  if (vsize == 0) vsize = 1; // all columns hold single values
+  (void)std::initializer_list<int>{(mp11::tuple_apply(
+                                        [vsize](auto... xs) {
+                                          detail::fill_n_check_extra_args(
+                                              vsize, std::move(xs)...);
+                                        },
+                                        entries.args),
+                                    0)...};
+  if (shared.empty()) return;
+
+  // histograms with one axis use the shared indices directly; cell indices are
+  // computed once for all histograms with the same axes filled from the same columns
+  const std::vector<std::size_t> ranks = {entries.columns.size()...};
+  std::vector<std::size_t> slots;
+  // position in map and rank of the first histogram that uses each cell index buffer
+  std::vector<std::pair<std::size_t, std::size_t>> cells;
+  for (std::size_t e = 0, pos = 0; e < ranks.size(); pos += ranks[e++]) {
+    if (ranks[e] == 1) {
+      slots.push_back(map[pos]);
+      continue;
+    }
+    std::size_t k = 0;
+    for (; k < cells.size(); ++k)
+      if (cells[k].second == ranks[e] &&
+          std::equal(map.begin() + pos, map.begin() + pos + ranks[e],
+                     map.begin() + cells[k].first))
+        break;
+    if (k == cells.size()) cells.emplace_back(pos, ranks[e]);
+    slots.push_back(shared.size() + k);
+  }
+
+  std::unique_ptr<detail::optional_index[]> buffer(
+      new detail::optional_index[(shared.size() + cells.size()) * buffer_size]);
+  auto buffer_at = [&buffer](std::size_t k) { return buffer.get() + k * buffer_size; };
+  for (std::size_t start = 0; start < vsize; start += buffer_size) {
+    const std::size_t n = std::min(buffer_size, vsize - start);
+    // compute indices once for each unique axis...
+    for (std::size_t k = 0; k < shared.size(); ++k)
+      shared[k].compute(buffer_at(k), start, n);
+    // ...combine them into cell indices...
+    for (std::size_t k = 0; k < cells.size(); ++k) {
+      const auto out = buffer_at(shared.size() + k);
+      const auto pos = cells[k].first;
+      std::copy(buffer_at(map[pos]), buffer_at(map[pos]) + n, out);
+      for (std::size_t i = pos + 1; i < pos + cells[k].second; ++i)
+        detail::fill_group_linearize(out, buffer_at(map[i]), strides[i], n);
+    }
+    // ...and fill the cells of each histogram
+    auto slot = slots.begin();
+    (void)std::initializer_list<int>{
+        (detail::fill_group_storage(entries, buffer_at(*slot++), n), 0)...};
+  }
+}
+
+} // namespace histogram
+} // namespace boost
+
+#endif
@@ -97,13 +97,13 @@ class count;
 template <class ValueType = double>
 class sum;
 
-template <class ValueType = double>
+template <class ValueType = double, bool ThreadSafe = false>
 class weighted_sum;
 
-template <class ValueType = double>
+template <class ValueType = double, bool ThreadSafe = false>
 class mean;
 
-template <class ValueType = double>
+template <class ValueType = double, bool ThreadSafe = false>
 class weighted_mean;
 
 template <class T>
@@ -119,9 +119,30 @@ struct unsafe_access;
 template <class Allocator = std::allocator<char>>
 class unlimited_storage;
 
+template <class Allocator = std::allocator<char>>
+class unlimited_block_storage;
+
 template <class T>
 class storage_adaptor;
 
+template <class T, class Allocator = std::allocator<T>>
+class striped_storage;
+
+template <class T, class Allocator = std::allocator<T>>
+class sparse_storage;
+
+template <class T, class Allocator = std::allocator<T>>
+class hybrid_storage;
+
+template <class T>
+class mapped_storage;
+
+template <class Storage>
+class tracking_storage;
+
+template <class Storage>
+class view_storage;
+
 #endif // BOOST_HISTOGRAM_DOXYGEN_INVOKED
 
 /// Vector-like storage for fast zero-overhead access to cells.
@@ -146,6 +167,9 @@ using weighted_profile_storage = dense_storage<accumulators::weighted_mean<>>;
 template <class Axes, class Storage = default_storage>
 class BOOST_ATTRIBUTE_NODISCARD histogram;
 
+template <class Axes, class Storage = default_storage>
+class sharded_histogram;
+
 #endif // BOOST_HISTOGRAM_DOXYGEN_INVOKED
 
 namespace detail {
@@ -23,6 +23,7 @@
 #include <boost/histogram/multi_index.hpp>
 #include <boost/histogram/sample.hpp>
 #include <boost/histogram/storage_adaptor.hpp>
+#include <boost/histogram/threads.hpp>
 #include <boost/histogram/unsafe_access.hpp>
 #include <boost/histogram/weight.hpp>
 #include <boost/mp11/integral.hpp>
@@ -205,9 +206,8 @@ public:
                                            typename acc_traits::args>();
     constexpr bool sample_valid =
         std::is_convertible<typename arg_traits::sargs, typename acc_traits::args>::value;
-    std::lock_guard<typename mutex_base::type> guard{mutex_base::get()};
     return detail::fill(mp11::mp_bool<(weight_valid && sample_valid)>{}, arg_traits{},
-                        offset_, storage_, axes_, args);
+                        offset_, storage_, axes_, args, mutex_base::get());
   }
 
   /** Fill histogram with several values at once.
@@ -227,14 +227,32 @@ public:
   */
   template <class Iterable, class = detail::requires_iterable<Iterable>>
   void fill(const Iterable& args) {
+    fill(threads(1), args);
+  }
+
+  /** Fill histogram with several values at once using several threads.
+
+    The conversion of values into bin indices is distributed over the threads. If the
+    storage is large and returns plain references to its cells, the cells are updated
+    in parallel as well, each thread updates a disjoint range of cells. Otherwise, the
+    storage is only accessed from the calling thread. The result is identical to that
+    of the single-threaded call. This pays off for large batches of values and
+    works with any storage. Histograms with growing axes are always filled by the
+    calling thread only.
+
+    @param t number of threads, created with the threads() helper function.
+    @param args iterable of values, see fill(const Iterable&).
+  */
+  template <class Iterable, class = detail::requires_iterable<Iterable>>
+  void fill(const threads_type& t, const Iterable& args) {
     using acc_traits = detail::accumulator_traits<value_type>;
     constexpr unsigned n_sample_args_expected =
         std::tuple_size<typename acc_traits::args>::value;
     static_assert(n_sample_args_expected == 0,
                   "sample argument is missing but required by accumulator");
     std::lock_guard<typename mutex_base::type> guard{mutex_base::get()};
-    detail::fill_n(mp11::mp_bool<(n_sample_args_expected == 0)>{}, offset_, storage_,
-                   axes_, detail::make_span(args));
+    detail::fill_n(mp11::mp_bool<(n_sample_args_expected == 0)>{}, t.value, offset_,
+                   storage_, axes_, detail::make_span(args));
   }
 
   /** Fill histogram with several values and weights at once.
@@ -244,6 +262,17 @@ public:
   */
   template <class Iterable, class T, class = detail::requires_iterable<Iterable>>
   void fill(const Iterable& args, const weight_type<T>& weights) {
+    fill(threads(1), args, weights);
+  }
+
+  /** Fill histogram with several values and weights at once using several threads.
+
+    @param t number of threads, created with the threads() helper function.
+    @param args iterable of values.
+    @param weights single weight or an iterable of weights.
+  */
+  template <class Iterable, class T, class = detail::requires_iterable<Iterable>>
+  void fill(const threads_type& t, const Iterable& args, const weight_type<T>& weights) {
     using acc_traits = detail::accumulator_traits<value_type>;
     constexpr bool weight_valid = acc_traits::weight_support;
     static_assert(weight_valid, "error: accumulator does not support weights");
@@ -251,8 +280,8 @@ public:
     constexpr bool sample_valid =
         std::is_convertible<std::tuple<>, typename acc_traits::args>::value;
     std::lock_guard<typename mutex_base::type> guard{mutex_base::get()};
-    detail::fill_n(mp11::mp_bool<(weight_valid && sample_valid)>{}, offset_, storage_,
-                   axes_, detail::make_span(args),
+    detail::fill_n(mp11::mp_bool<(weight_valid && sample_valid)>{}, t.value, offset_,
+                   storage_, axes_, detail::make_span(args),
                    weight(detail::to_ptr_size(weights.value)));
   }
 
@@ -273,6 +302,18 @@ public:
   */
   template <class Iterable, class... Ts, class = detail::requires_iterable<Iterable>>
   void fill(const Iterable& args, const sample_type<std::tuple<Ts...>>& samples) {
+    fill(threads(1), args, samples);
+  }
+
+  /** Fill histogram with several values and samples at once using several threads.
+
+    @param t number of threads, created with the threads() helper function.
+    @param args iterable of values.
+    @param samples single sample or an iterable of samples.
+  */
+  template <class Iterable, class... Ts, class = detail::requires_iterable<Iterable>>
+  void fill(const threads_type& t, const Iterable& args,
+            const sample_type<std::tuple<Ts...>>& samples) {
     using acc_traits = detail::accumulator_traits<value_type>;
     using sample_args_passed =
         std::tuple<decltype(*detail::to_ptr_size(std::declval<Ts>()).first)...>;
@@ -283,8 +324,8 @@ public:
         [&](const auto&... sargs) {
           constexpr bool sample_valid =
               std::is_convertible<sample_args_passed, typename acc_traits::args>::value;
-          detail::fill_n(mp11::mp_bool<(sample_valid)>{}, offset_, storage_, axes_,
-                         detail::make_span(args), detail::to_ptr_size(sargs)...);
+          detail::fill_n(mp11::mp_bool<(sample_valid)>{}, t.value, offset_, storage_,
+                         axes_, detail::make_span(args), detail::to_ptr_size(sargs)...);
         },
         samples.value);
   }
@@ -303,6 +344,21 @@ public:
             class = detail::requires_iterable<Iterable>>
   void fill(const Iterable& args, const weight_type<T>& weights,
             const sample_type<std::tuple<Ts...>>& samples) {
+    fill(threads(1), args, weights, samples);
+  }
+
+  /** Fill histogram with several values, weights, and samples at once using several
+    threads.
+
+    @param t number of threads, created with the threads() helper function.
+    @param args iterable of values.
+    @param weights single weight or an iterable of weights.
+    @param samples single sample or an iterable of samples.
+  */
+  template <class Iterable, class T, class... Ts,
+            class = detail::requires_iterable<Iterable>>
+  void fill(const threads_type& t, const Iterable& args, const weight_type<T>& weights,
+            const sample_type<std::tuple<Ts...>>& samples) {
     using acc_traits = detail::accumulator_traits<value_type>;
     using sample_args_passed =
         std::tuple<decltype(*detail::to_ptr_size(std::declval<Ts>()).first)...>;
@@ -315,8 +371,8 @@ public:
           static_assert(weight_valid, "error: accumulator does not support weights");
           constexpr bool sample_valid =
               std::is_convertible<sample_args_passed, typename acc_traits::args>::value;
-          detail::fill_n(mp11::mp_bool<(weight_valid && sample_valid)>{}, offset_,
-                         storage_, axes_, detail::make_span(args),
+          detail::fill_n(mp11::mp_bool<(weight_valid && sample_valid)>{}, t.value,
+                         offset_, storage_, axes_, detail::make_span(args),
                          weight(detail::to_ptr_size(weights.value)),
                          detail::to_ptr_size(sargs)...);
         },
@@ -446,8 +502,7 @@ public:
   operator+=(const histogram<A, S>& rhs) {
     if (!detail::axes_equal(axes_, unsafe_access::axes(rhs)))
       BOOST_THROW_EXCEPTION(std::invalid_argument("axes of histograms differ"));
-    auto rit = unsafe_access::storage(rhs).begin();
-    for (auto&& x : storage_) x += *rit++;
+    add_storage(unsafe_access::storage(rhs));
     return *this;
   }
 
@@ -463,8 +518,7 @@ public:
   operator+=(const histogram<axes_type, S>& rhs) {
     const auto& raxes = unsafe_access::axes(rhs);
     if (detail::axes_equal(axes_, unsafe_access::axes(rhs))) {
-      auto rit = unsafe_access::storage(rhs).begin();
-      for (auto&& x : storage_) x += *rit++;
+      add_storage(unsafe_access::storage(rhs));
       return *this;
     }
 
@@ -607,6 +661,19 @@ public:
   }
 
 private:
+  template <class S>
+  void add_storage(const S& rhs) {
+    // use special storage implementation of adding if available,
+    // else fallback to adding item by item
+    detail::static_if<detail::has_operator_radd<storage_type, S>>(
+        [](auto& s, const auto& r) { s += r; },
+        [](auto& s, const auto& r) {
+          auto rit = r.begin();
+          for (auto&& x : s) x += *rit++;
+        },
+        storage_, rhs);
+  }
+
   axes_type axes_;
   storage_type storage_;
   std::size_t offset_ = 0;
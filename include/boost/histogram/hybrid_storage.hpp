@@ -0,0 +1,358 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_HYBRID_STORAGE_HPP
+#define BOOST_HISTOGRAM_HYBRID_STORAGE_HPP
+
+#include <algorithm>
+#include <boost/core/nvp.hpp>
+#include <boost/histogram/detail/array_wrapper.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/detail/iterator_adaptor.hpp>
+#include <boost/histogram/detail/optional_index.hpp>
+#include <boost/histogram/fwd.hpp>
+#include <boost/histogram/sparse_storage.hpp>
+#include <boost/throw_exception.hpp>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace histogram {
+
+/**
+  Storage which switches from a sparse to a dense representation when it fills up.
+
+  The storage starts out as a sparse_storage, so that a histogram with many cells
+  consumes little memory as long as only few cells were written to. When the fraction of
+  occupied cells exceeds a threshold, the cells are moved into a contiguous array and
+  the storage stays dense from then on, so that a histogram which turns out to be dense
+  is filled at the speed of a dense_storage. Resetting the storage releases the array and
+  returns to the sparse representation.
+
+  The default threshold of 1/4 is roughly where the hash table of the sparse
+  representation consumes as much memory as the array for 8-byte cells.
+
+  @tparam T type of the cells, an arithmetic type or an accumulator.
+  @tparam Allocator allocator used for the hash table and the array.
+*/
+template <class T, class Allocator>
+class hybrid_storage {
+  using sparse_type = sparse_storage<T, Allocator>;
+  using dense_type = std::vector<T, Allocator>;
+
+public:
+  static constexpr bool has_threading_support = false;
+
+  using allocator_type = Allocator;
+  using value_type = T;
+  using const_reference = const value_type&;
+
+  /// implementation detail
+  class reference {
+  public:
+    reference(hybrid_storage& s, std::size_t i) noexcept : sref_(s), idx_(i) {
+      assert(idx_ < sref_.size());
+    }
+
+    reference(const reference&) noexcept = default;
+
+    // references do not rebind, assign through
+    reference& operator=(const reference& x) {
+      return operator=(static_cast<const_reference>(x));
+    }
+
+    reference& operator=(const_reference x) {
+      sref_.apply(idx_, [&x](auto& c) { c = x; });
+      return *this;
+    }
+
+    operator const_reference() const noexcept {
+      return static_cast<const hybrid_storage&>(sref_)[idx_];
+    }
+
+    template <class V = value_type,
+              class = std::enable_if_t<detail::has_operator_preincrement<V>::value>>
+    reference& operator++() {
+      sref_.apply(idx_, [](auto& c) { ++c; });
+      return *this;
+    }
+
+    template <class U, class V = value_type,
+              class = std::enable_if_t<detail::has_operator_radd<V, U>::value>>
+    reference& operator+=(const U& x) {
+      sref_.apply(idx_, [&x](auto& c) { c += x; });
+      return *this;
+    }
+
+    template <class U, class V = value_type,
+              class = std::enable_if_t<detail::has_operator_rsub<V, U>::value>>
+    reference& operator-=(const U& x) {
+      sref_.apply(idx_, [&x](auto& c) { c -= x; });
+      return *this;
+    }
+
+    template <class U, class V = value_type,
+              class = std::enable_if_t<detail::has_operator_rmul<V, U>::value>>
+    reference& operator*=(const U& x) {
+      sref_.apply(idx_, [&x](auto& c) { c *= x; });
+      return *this;
+    }
+
+    template <class U, class V = value_type,
+              class = std::enable_if_t<detail::has_operator_rdiv<V, U>::value>>
+    reference& operator/=(const U& x) {
+      sref_.apply(idx_, [&x](auto& c) { c /= x; });
+      return *this;
+    }
+
+    template <class U, class = std::enable_if_t<
+                           detail::has_operator_equal<value_type, U>::value>>
+    bool operator==(const U& rhs) const {
+      return operator const_reference() == rhs;
+    }
+
+    template <class U, class = std::enable_if_t<
+                           detail::has_operator_equal<value_type, U>::value>>
+    bool operator!=(const U& rhs) const {
+      return !operator==(rhs);
+    }
+
+    template <class... Ts>
+    auto operator()(const Ts&... args)
+        -> decltype(void(std::declval<value_type&>()(args...))) {
+      sref_.apply(idx_, [&args...](auto& c) { c(args...); });
+    }
+
+  private:
+    hybrid_storage& sref_;
+    std::size_t idx_;
+  };
+
+private:
+  template <class Value, class Reference, class Storage>
+  class iterator_impl
+      : public detail::iterator_adaptor<iterator_impl<Value, Reference, Storage>,
+                                        std::size_t, Reference, Value> {
+  public:
+    iterator_impl() = default;
+    template <class V, class R, class S>
+    iterator_impl(const iterator_impl<V, R, S>& it)
+        : iterator_impl::iterator_adaptor_(it.base()), storage_(it.storage_) {}
+    iterator_impl(Storage* s, std::size_t i) noexcept
+        : iterator_impl::iterator_adaptor_(i), storage_(s) {}
+
+    Reference operator*() const noexcept { return (*storage_)[this->base()]; }
+
+    template <class V, class R, class S>
+    friend class iterator_impl;
+
+  private:
+    Storage* storage_ = nullptr;
+  };
+
+public:
+  using const_iterator =
+      iterator_impl<const value_type, const_reference, const hybrid_storage>;
+  using iterator = iterator_impl<value_type, reference, hybrid_storage>;
+
+  explicit hybrid_storage(const allocator_type& a = {}) : sparse_(a), dense_(a) {}
+
+  /** Construct storage with a custom threshold.
+
+    @param max_occupancy fraction of occupied cells above which the storage becomes
+    dense; must be in the interval [0, 1]. With 1, the storage never becomes dense.
+    @param a allocator instance.
+  */
+  explicit hybrid_storage(double max_occupancy, const allocator_type& a = {})
+      : sparse_(a), dense_(a), max_occupancy_(max_occupancy) {
+    if (!(max_occupancy >= 0 && max_occupancy <= 1))
+      BOOST_THROW_EXCEPTION(std::invalid_argument("max_occupancy must be in [0, 1]"));
+  }
+
+  hybrid_storage(const hybrid_storage&) = default;
+  hybrid_storage& operator=(const hybrid_storage&) = default;
+  hybrid_storage(hybrid_storage&&) = default;
+  hybrid_storage& operator=(hybrid_storage&&) = default;
+
+  template <class Iterable, class = detail::requires_iterable<Iterable>>
+  explicit hybrid_storage(const Iterable& s) {
+    using std::begin;
+    using std::end;
+    reset(static_cast<std::size_t>(std::distance(begin(s), end(s))));
+    std::size_t i = 0;
+    for (auto&& x : s) (*this)[i++] = x;
+  }
+
+  template <class Iterable, class = detail::requires_iterable<Iterable>>
+  hybrid_storage& operator=(const Iterable& s) {
+    *this = hybrid_storage(s);
+    return *this;
+  }
+
+  allocator_type get_allocator() const { return dense_.get_allocator(); }
+
+  /// Return empty storage with the same allocator and max_occupancy.
+  hybrid_storage make_default() const {
+    return hybrid_storage(max_occupancy_, get_allocator());
+  }
+
+  /// Set number of cells, make all cells empty and return to the sparse representation.
+  void reset(std::size_t n) {
+    dense_type(get_allocator()).swap(dense_);
+    is_dense_ = false;
+    sparse_.reset(n);
+    max_occupied_ = static_cast<std::size_t>(max_occupancy_ * static_cast<double>(n));
+  }
+
+  /// Return number of cells.
+  std::size_t size() const noexcept { return is_dense_ ? dense_.size() : sparse_.size(); }
+
+  /// Return true if the cells are stored in a contiguous array.
+  bool is_dense() const noexcept { return is_dense_; }
+
+  /// Return fraction of occupied cells above which the storage becomes dense.
+  double max_occupancy() const noexcept { return max_occupancy_; }
+
+  reference operator[](std::size_t i) noexcept { return {*this, i}; }
+
+  const_reference operator[](std::size_t i) const noexcept {
+    return is_dense_ ? dense_[i] : sparse_[i];
+  }
+
+  bool operator==(const hybrid_storage& x) const {
+    if (!is_dense_ && !x.is_dense_) return sparse_ == x.sparse_;
+    if (size() != x.size()) return false;
+    return std::equal(begin(), end(), x.begin());
+  }
+
+  template <class Iterable>
+  bool operator==(const Iterable& iterable) const {
+    if (size() != iterable.size()) return false;
+    return std::equal(begin(), end(), std::begin(iterable));
+  }
+
+  /// Add another hybrid storage, the result is dense if the argument is dense.
+  template <class V = value_type,
+            class = std::enable_if_t<detail::has_operator_radd<V, V>::value>>
+  hybrid_storage& operator+=(const hybrid_storage& x) {
+    assert(size() == x.size());
+    if (x.is_dense_) {
+      if (!is_dense_) make_dense();
+      auto it = x.dense_.begin();
+      for (auto&& c : dense_) c += *it++;
+    } else {
+      x.sparse_.for_each_occupied(
+          [this](std::size_t i, const_reference v) { (*this)[i] += v; });
+    }
+    return *this;
+  }
+
+  /// Scale all cells, in the sparse representation only the occupied cells.
+  template <class V = value_type,
+            class = std::enable_if_t<detail::has_operator_rmul<V, double>::value>>
+  hybrid_storage& operator*=(const double x) {
+    if (is_dense_)
+      for (auto&& c : dense_) c *= x;
+    else
+      sparse_ *= x;
+    return *this;
+  }
+
+  iterator begin() noexcept { return {this, 0}; }
+  iterator end() noexcept { return {this, size()}; }
+  const_iterator begin() const noexcept { return {this, 0}; }
+  const_iterator end() const noexcept { return {this, size()}; }
+
+  /// implementation detail; increments cells at n indices, skips invalid indices
+  template <class Index, class V = value_type,
+            class = std::enable_if_t<detail::has_operator_preincrement<V>::value>>
+  void increment_n(const Index* indices, std::size_t n) {
+    auto it = indices;
+    const auto end = indices + n;
+    // the storage may become dense in the middle of the batch
+    for (; it != end && !is_dense_; ++it)
+      if (detail::is_valid(*it)) ++(*this)[*it];
+    increment_dense_n(std::is_arithmetic<value_type>{}, it, end);
+  }
+
+  template <class Archive>
+  void serialize(Archive& ar, unsigned /* version */) {
+    ar& make_nvp("max_occupancy", max_occupancy_);
+    ar& make_nvp("dense", is_dense_);
+    if (is_dense_) {
+      auto size = dense_.size();
+      ar& make_nvp("size", size);
+      if (Archive::is_loading::value) {
+        sparse_ = sparse_type(get_allocator());
+        dense_.resize(size);
+      }
+      auto w = detail::make_array_wrapper(dense_.data(), size);
+      ar& make_nvp("array", w);
+    } else {
+      ar& make_nvp("sparse", sparse_);
+      if (Archive::is_loading::value) dense_type(get_allocator()).swap(dense_);
+    }
+    if (Archive::is_loading::value)
+      max_occupied_ =
+          static_cast<std::size_t>(max_occupancy_ * static_cast<double>(size()));
+  }
+
+private:
+  // calls f with the cell, switches to the dense representation when the cell was
+  // created in the sparse representation and the threshold is exceeded
+  template <class F>
+  void apply(std::size_t i, F&& f) {
+    if (is_dense_) {
+      f(dense_[i]);
+      return;
+    }
+    auto c = sparse_[i];
+    f(c);
+    if (sparse_.occupied() > max_occupied_) make_dense();
+  }
+
+  template <class Index>
+  void increment_dense_n(std::false_type, const Index* it, const Index* end) {
+    for (; it != end; ++it)
+      if (detail::is_valid(*it)) ++dense_[*it];
+  }
+
+  // same as in detail::fill_n_storage_n, an invalid index adds zero to the first cell
+  template <class Index>
+  void increment_dense_n(std::true_type, const Index* it, const Index* end) {
+    const auto p = dense_.data();
+    for (; it != end; ++it) {
+      const auto mask = std::size_t{0} - detail::is_valid(*it);
+      p[*it & mask] += static_cast<value_type>(mask & 1);
+    }
+  }
+
+  void make_dense() {
+    assert(!is_dense_);
+    dense_.assign(sparse_.size(), value_type{});
+    sparse_.for_each_occupied(
+        [this](std::size_t i, const_reference v) { dense_[i] = v; });
+    // release the memory of the hash table
+    sparse_ = sparse_type(get_allocator());
+    is_dense_ = true;
+  }
+
+  sparse_type sparse_;
+  dense_type dense_;
+  double max_occupancy_ = 0.25;
+  std::size_t max_occupied_ = 0;
+  bool is_dense_ = false;
+};
+
+} // namespace histogram
+} // namespace boost
+
+#endif
@@ -0,0 +1,366 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_MAPPED_STORAGE_HPP
+#define BOOST_HISTOGRAM_MAPPED_STORAGE_HPP
+
+#include <boost/config.hpp>
+
+// memory mapping requires POSIX
+#ifdef BOOST_HAS_UNISTD_H
+
+#include <algorithm>
+#include <boost/core/nvp.hpp>
+#include <boost/histogram/detail/array_wrapper.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/fwd.hpp>
+#include <boost/throw_exception.hpp>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+
+namespace boost {
+namespace histogram {
+
+/**
+  Dense storage whose cells live in a memory-mapped file.
+
+  The cells are a contiguous array of `T` in a file, which is mapped into memory. The
+  operating system pages the cells in and out as needed, so the number of cells may
+  exceed the available memory. Cells are accessed through plain references, so filling
+  is as fast as with a dense_storage once the pages are resident.
+
+  The cells written before a crash of the process are in the file. A new job can
+  continue from there by opening the file with open_mode::resume, without deserializing
+  the histogram. Call flush() to make sure that the cells reach the disk.
+
+  A default-constructed storage and a copy of a storage use anonymous memory without a
+  file. If an axis grows, the file is enlarged and the cells are moved inside the file.
+
+  Only available on POSIX systems.
+
+  @tparam T type of the cells, must be trivially copyable.
+*/
+template <class T>
+class mapped_storage {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "cells must be trivially copyable to be stored in a file");
+
+  // the file starts with a header, the cells follow at this offset
+  static constexpr std::size_t header_size = 64;
+  static_assert(alignof(T) <= header_size, "alignment of cells is too large");
+
+  struct header_type {
+    char magic[8];
+    std::uint64_t value_size;
+    std::uint64_t size;
+  };
+
+public:
+  /// How to open the file.
+  enum class open_mode {
+    create, ///< create the file, an existing file is truncated
+    resume  ///< keep the cells of an existing file, see mapped_storage()
+  };
+
+  /// Access pattern hint for the operating system, see madvise(2).
+  enum class advice { normal, sequential, random, will_need, dont_need };
+
+  static constexpr bool has_threading_support = false;
+
+  using value_type = T;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using iterator = value_type*;
+  using const_iterator = const value_type*;
+
+  /// Storage in anonymous memory.
+  mapped_storage() = default;
+
+  /** Storage in a file.
+
+    With open_mode::resume, the cells of an existing file are kept by the first call to
+    reset(), which happens when a histogram is constructed with this storage. The
+    histogram must have the same number of cells as the file. If the file does not
+    exist, it is created.
+
+    @param path file name.
+    @param m open mode.
+    @param a access pattern hint.
+  */
+  explicit mapped_storage(const std::string& path, open_mode m = open_mode::create,
+                          advice a = advice::normal)
+      : advice_(a) {
+    // the destructor does not run if the constructor throws
+    try {
+      open(path, m);
+    } catch (...) {
+      close();
+      throw;
+    }
+  }
+
+  /// Copy cells into anonymous memory.
+  mapped_storage(const mapped_storage& x) : advice_(x.advice_) { *this = x; }
+
+  /// Copy cells, a storage in a file keeps using the file.
+  mapped_storage& operator=(const mapped_storage& x) {
+    if (this != &x) {
+      resume_ = false;
+      reset(x.size());
+      std::copy(x.begin(), x.end(), begin());
+    }
+    return *this;
+  }
+
+  mapped_storage(mapped_storage&& x) noexcept { swap(x); }
+
+  mapped_storage& operator=(mapped_storage&& x) noexcept {
+    swap(x);
+    return *this;
+  }
+
+  // a file name is iterable, but is not a sequence of cells
+  template <class Iterable, class = detail::requires_iterable<Iterable>,
+            class = std::enable_if_t<!std::is_convertible<Iterable, std::string>::value>>
+  explicit mapped_storage(const Iterable& s) {
+    *this = s;
+  }
+
+  template <class Iterable, class = detail::requires_iterable<Iterable>,
+            class = std::enable_if_t<!std::is_convertible<Iterable, std::string>::value>>
+  mapped_storage& operator=(const Iterable& s) {
+    using std::begin;
+    using std::end;
+    resume_ = false;
+    reset(static_cast<std::size_t>(std::distance(begin(s), end(s))));
+    auto it = this->begin();
+    for (auto&& x : s) *it++ = static_cast<value_type>(x);
+    return *this;
+  }
+
+  ~mapped_storage() { close(); }
+
+  void swap(mapped_storage& x) noexcept {
+    std::swap(fd_, x.fd_);
+    std::swap(base_, x.base_);
+    std::swap(bytes_, x.bytes_);
+    std::swap(size_, x.size_);
+    std::swap(advice_, x.advice_);
+    std::swap(resume_, x.resume_);
+  }
+
+  /// Set number of cells and set all cells to zero.
+  void reset(std::size_t n) {
+    if (resume_) {
+      resume_ = false;
+      if (n == size_) return; // keep cells from the file
+      BOOST_THROW_EXCEPTION(
+          std::invalid_argument("number of cells does not match the file"));
+    }
+    unmap();
+    if (fd_ >= 0) {
+      // shrinking to the header and growing again zeros the cells without writing
+      if (::ftruncate(fd_, header_size) != 0 ||
+          ::ftruncate(fd_, static_cast<off_t>(header_size + n * sizeof(T))) != 0)
+        fail("cannot resize file");
+    }
+    map(n);
+    write_header();
+  }
+
+  /// Return number of cells.
+  std::size_t size() const noexcept { return size_; }
+
+  /// Return true if the cells are stored in a file.
+  bool is_file_backed() const noexcept { return fd_ >= 0; }
+
+  /// Write modified cells to the file and wait until this is done.
+  void flush() {
+    if (fd_ >= 0 && base_ && ::msync(base_, bytes_, MS_SYNC) != 0)
+      fail("cannot write cells to file");
+  }
+
+  /// Set the access pattern hint, which is kept when the storage is reset.
+  void advise(advice a) noexcept {
+    advice_ = a;
+    apply_advice();
+  }
+
+  reference operator[](std::size_t i) noexcept { return data()[i]; }
+  const_reference operator[](std::size_t i) const noexcept { return data()[i]; }
+
+  template <class Iterable, class = detail::requires_iterable<Iterable>>
+  bool operator==(const Iterable& iterable) const {
+    using std::begin;
+    using std::end;
+    if (size_ != static_cast<std::size_t>(std::distance(begin(iterable), end(iterable))))
+      return false;
+    return std::equal(this->begin(), this->end(), begin(iterable));
+  }
+
+  iterator begin() noexcept { return data(); }
+  iterator end() noexcept { return data() + size_; }
+  const_iterator begin() const noexcept { return data(); }
+  const_iterator end() const noexcept { return data() + size_; }
+
+  /// implementation detail; resizes storage to n cells, moves cell i to position i + d,
+  /// and calls f with a pointer to the first cell, so that f can move cells further
+  template <class F>
+  void grow(std::size_t n, std::size_t d, F&& f) {
+    assert(size_ + d <= n);
+    char* const old_base = base_;
+    const std::size_t old_bytes = bytes_, old_size = size_;
+    // the old mapping stays valid until the new one is in place
+    if (fd_ >= 0 && ::ftruncate(fd_, static_cast<off_t>(header_size + n * sizeof(T))))
+      fail("cannot resize file");
+    try {
+      map(n);
+    } catch (...) {
+      // keep the file consistent with its header
+      if (fd_ >= 0) (void)::ftruncate(fd_, static_cast<off_t>(old_bytes));
+      throw;
+    }
+    if (old_base) {
+      // cells in anonymous memory are not shared by the mappings
+      if (fd_ < 0) std::memcpy(base_, old_base, old_bytes);
+      ::munmap(old_base, old_bytes);
+    }
+    // new cells in the file and in anonymous memory are zero
+    std::memmove(data() + d, data(), old_size * sizeof(T));
+    std::memset(static_cast<void*>(data()), 0, (std::min)(d, old_size) * sizeof(T));
+    write_header();
+    f(data());
+  }
+
+  template <class Archive>
+  void serialize(Archive& ar, unsigned /* version */) {
+    auto size = size_;
+    ar& make_nvp("size", size);
+    if (Archive::is_loading::value) {
+      resume_ = false;
+      reset(size);
+    }
+    auto w = detail::make_array_wrapper(data(), size);
+    ar& make_nvp("array", w);
+  }
+
+private:
+  static const char* magic() noexcept { return "BHSTCELL"; }
+
+  BOOST_NORETURN static void fail(const char* what) {
+    const int err = errno;
+    BOOST_THROW_EXCEPTION(std::system_error(err, std::generic_category(), what));
+  }
+
+  void open(const std::string& path, open_mode m) {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | (m == open_mode::create ? O_TRUNC : 0),
+                 0644);
+    if (fd_ < 0) fail("cannot open file");
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) fail("cannot read file size");
+    if (m == open_mode::resume && st.st_size > 0) {
+      header_type h;
+      if (static_cast<std::size_t>(st.st_size) < header_size ||
+          ::pread(fd_, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h)) ||
+          std::memcmp(h.magic, magic(), sizeof(h.magic)) != 0 ||
+          h.value_size != sizeof(value_type) ||
+          static_cast<std::uint64_t>(st.st_size) != header_size + h.size * sizeof(T))
+        BOOST_THROW_EXCEPTION(
+            std::invalid_argument("file does not contain cells of this type"));
+      map(static_cast<std::size_t>(h.size));
+      resume_ = true;
+    }
+  }
+
+  void write_header() noexcept {
+    if (fd_ < 0) return;
+    header_type h{};
+    std::memcpy(h.magic, magic(), sizeof(h.magic));
+    h.value_size = sizeof(value_type);
+    h.size = size_;
+    std::memcpy(base_, &h, sizeof(h));
+  }
+
+  value_type* data() noexcept {
+    return base_ ? reinterpret_cast<value_type*>(base_ + header_size) : nullptr;
+  }
+
+  const value_type* data() const noexcept {
+    return base_ ? reinterpret_cast<const value_type*>(base_ + header_size) : nullptr;
+  }
+
+  void map(std::size_t n) {
+    const std::size_t bytes = header_size + n * sizeof(T);
+    const int flags = fd_ >= 0 ? MAP_SHARED : MAP_PRIVATE | MAP_ANONYMOUS;
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, fd_, 0);
+    if (p == MAP_FAILED) fail("cannot map cells into memory");
+    base_ = static_cast<char*>(p);
+    bytes_ = bytes;
+    size_ = n;
+    apply_advice();
+  }
+
+  void unmap() noexcept {
+    if (base_) ::munmap(base_, bytes_);
+    base_ = nullptr;
+    bytes_ = 0;
+    size_ = 0;
+  }
+
+  void close() noexcept {
+    unmap();
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+  }
+
+  void apply_advice() noexcept {
+    if (!base_) return;
+    int flag = MADV_NORMAL;
+    switch (advice_) {
+      case advice::normal: break;
+      case advice::sequential: flag = MADV_SEQUENTIAL; break;
+      case advice::random: flag = MADV_RANDOM; break;
+      case advice::will_need: flag = MADV_WILLNEED; break;
+      case advice::dont_need:
+        // anonymous memory would be discarded, not paged out
+        if (fd_ < 0) return;
+        flag = MADV_DONTNEED;
+        break;
+    }
+    // only a hint, failure is not an error
+    ::madvise(base_, bytes_, flag);
+  }
+
+  int fd_ = -1;
+  char* base_ = nullptr;
+  std::size_t bytes_ = 0;
+  std::size_t size_ = 0;
+  advice advice_ = advice::normal;
+  bool resume_ = false;
+};
+
+template <class T>
+constexpr std::size_t mapped_storage<T>::header_size;
+
+} // namespace histogram
+} // namespace boost
+
+#endif // BOOST_HAS_UNISTD_H
+
+#endif
@@ -0,0 +1,389 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_NATIVE_ARCHIVE_HPP
+#define BOOST_HISTOGRAM_NATIVE_ARCHIVE_HPP
+
+#include <algorithm>
+#include <boost/core/nvp.hpp>
+#include <boost/histogram/detail/array_wrapper.hpp>
+#include <boost/mp11/utility.hpp>
+#include <boost/throw_exception.hpp>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+  \file boost/histogram/native_archive.hpp
+
+  Archives for a compact binary format, which do not require the Boost.Serialization
+  library.
+
+  The archives work with the same serialize methods as the archives of
+  Boost.Serialization. Saving a histogram writes the axes and then the cells. Arrays of
+  trivially copyable cells are written as one block of raw bytes, which is read straight
+  into the memory of the storage. This is much faster than writing each cell as an
+  individual item, as the XML and text archives do.
+
+  The format starts with a magic string and a format version. Integral numbers are
+  stored as 64 bit and floating point numbers with their size, both in little-endian
+  byte order. A block of cells stores the size of a cell and the class version of the
+  cell type, which are checked when the block is read. Fixed-width cells, like the
+  buffers of unlimited_storage, can be exchanged between platforms.
+*/
+
+#ifndef BOOST_HISTOGRAM_DOXYGEN_INVOKED
+
+namespace boost {
+namespace serialization {
+
+template <class T>
+struct version;
+
+} // namespace serialization
+} // namespace boost
+
+#endif
+
+namespace boost {
+namespace histogram {
+namespace detail {
+
+// class version in the sense of Boost.Serialization, zero if not specified
+template <class T>
+using serialization_version_impl =
+    std::integral_constant<unsigned, boost::serialization::version<T>::value>;
+
+template <class T>
+using serialization_version =
+    mp11::mp_eval_or<std::integral_constant<unsigned, 0>, serialization_version_impl, T>;
+
+inline const char* native_archive_magic() noexcept { return "BHNATIVE"; }
+constexpr std::size_t native_archive_magic_size = 8;
+constexpr std::uint32_t native_archive_version = 1;
+
+// blocks of cells are either raw little-endian bytes or a sequence of items
+enum class native_block_kind : std::uint8_t { raw = 0, items = 1 };
+
+inline bool is_little_endian() noexcept {
+  const std::uint16_t x = 1;
+  unsigned char c;
+  std::memcpy(&c, &x, 1);
+  return c == 1;
+}
+
+template <class T>
+void byteswap_if_big_endian(T& x) noexcept {
+  if (is_little_endian()) return;
+  auto p = reinterpret_cast<unsigned char*>(&x);
+  std::reverse(p, p + sizeof(T));
+}
+
+} // namespace detail
+
+/**
+  Output archive for the compact binary format.
+
+  Use it like an output archive of Boost.Serialization.
+  ```
+  std::ofstream os("histogram.dat", std::ios::binary);
+  native_oarchive oa(os);
+  oa << h;
+  ```
+*/
+class native_oarchive {
+public:
+  using is_loading = std::false_type;
+  using is_saving = std::true_type;
+
+  /// Write the header of the format to the stream.
+  explicit native_oarchive(std::ostream& os) : os_(os) {
+    write(detail::native_archive_magic(), detail::native_archive_magic_size);
+    save_scalar(detail::native_archive_version);
+  }
+
+  template <class T>
+  native_oarchive& operator<<(const T& t) {
+    save(t);
+    return *this;
+  }
+
+  template <class T>
+  native_oarchive& operator&(const T& t) {
+    return operator<<(t);
+  }
+
+private:
+  template <class T>
+  void save(const serialization::nvp<T>& t) {
+    save(t.const_value());
+  }
+
+  template <class T>
+  void save(const detail::array_wrapper<T>& t) {
+    save_block(t.ptr, t.size);
+  }
+
+  template <class C, class Tr, class A>
+  void save(const std::basic_string<C, Tr, A>& t) {
+    save(static_cast<std::uint64_t>(t.size()));
+    save_block(t.data(), t.size());
+  }
+
+  template <class T, class A>
+  void save(const std::vector<T, A>& t) {
+    save(static_cast<std::uint64_t>(t.size()));
+    save_block(t.data(), t.size());
+  }
+
+  template <class K, class V, class C, class A>
+  void save(const std::map<K, V, C, A>& t) {
+    save_map(t);
+  }
+
+  template <class K, class V, class H, class E, class A>
+  void save(const std::unordered_map<K, V, H, E, A>& t) {
+    save_map(t);
+  }
+
+  template <class T>
+  std::enable_if_t<std::is_arithmetic<T>::value> save(const T& t) {
+    // integral numbers are stored with 64 bit, so that their size does not depend on
+    // the platform
+    using U = mp11::mp_cond<std::is_same<T, bool>, std::uint8_t,              //
+                            std::is_floating_point<T>, T,                     //
+                            std::is_signed<T>, std::int64_t, std::true_type, //
+                            std::uint64_t>;
+    save_scalar(static_cast<U>(t));
+  }
+
+  template <class T>
+  std::enable_if_t<std::is_enum<T>::value> save(const T& t) {
+    save(static_cast<std::underlying_type_t<T>>(t));
+  }
+
+  template <class T>
+  std::enable_if_t<std::is_class<T>::value> save(const T& t) {
+    const unsigned version = detail::serialization_version<T>::value;
+    save_scalar(static_cast<std::uint32_t>(version));
+    // serialize methods are not const, since they are also used for loading
+    const_cast<T&>(t).serialize(*this, version);
+  }
+
+  template <class M>
+  void save_map(const M& t) {
+    save(static_cast<std::uint64_t>(t.size()));
+    for (auto&& kv : t) {
+      save(kv.first);
+      save(kv.second);
+    }
+  }
+
+  template <class T>
+  void save_block(const T* p, std::size_t n) {
+    // raw blocks of classes can only be written in little-endian byte order
+    const bool raw = std::is_trivially_copyable<T>::value &&
+                     (std::is_arithmetic<T>::value || detail::is_little_endian());
+    save_scalar(raw ? detail::native_block_kind::raw : detail::native_block_kind::items);
+    save_scalar(static_cast<std::uint32_t>(sizeof(T)));
+    save_scalar(static_cast<std::uint32_t>(detail::serialization_version<T>::value));
+    if (raw && detail::is_little_endian())
+      write(p, n * sizeof(T));
+    else if (raw)
+      for (auto it = p; it != p + n; ++it) save_scalar(*it);
+    else
+      for (auto it = p; it != p + n; ++it) save(*it);
+  }
+
+  template <class T>
+  void save_scalar(T x) {
+    detail::byteswap_if_big_endian(x);
+    write(&x, sizeof(T));
+  }
+
+  void write(const void* p, std::size_t n) {
+    if (!os_.write(static_cast<const char*>(p), static_cast<std::streamsize>(n)))
+      BOOST_THROW_EXCEPTION(std::runtime_error("cannot write to stream"));
+  }
+
+  std::ostream& os_;
+};
+
+/**
+  Input archive for the compact binary format.
+
+  Use it like an input archive of Boost.Serialization.
+  ```
+  std::ifstream is("histogram.dat", std::ios::binary);
+  native_iarchive ia(is);
+  ia >> h;
+  ```
+*/
+class native_iarchive {
+public:
+  using is_loading = std::true_type;
+  using is_saving = std::false_type;
+
+  /// Read and check the header of the format.
+  explicit native_iarchive(std::istream& is) : is_(is) {
+    char magic[detail::native_archive_magic_size];
+    read(magic, sizeof(magic));
+    if (!std::equal(magic, magic + sizeof(magic), detail::native_archive_magic()))
+      BOOST_THROW_EXCEPTION(std::runtime_error("stream does not start with archive"));
+    std::uint32_t version;
+    load_scalar(version);
+    if (version > detail::native_archive_version)
+      BOOST_THROW_EXCEPTION(std::runtime_error("archive has newer format version"));
+  }
+
+  template <class T>
+  native_iarchive& operator>>(T&& t) {
+    load(t);
+    return *this;
+  }
+
+  template <class T>
+  native_iarchive& operator&(T&& t) {
+    return operator>>(std::forward<T>(t));
+  }
+
+  /// implementation detail; objects are not tracked
+  void reset_object_address(const void*, const void*) noexcept {}
+
+private:
+  template <class T>
+  void load(const serialization::nvp<T>& t) {
+    load(t.value());
+  }
+
+  template <class T>
+  void load(detail::array_wrapper<T>& t) {
+    load_block(t.ptr, t.size);
+  }
+
+  template <class C, class Tr, class A>
+  void load(std::basic_string<C, Tr, A>& t) {
+    t.resize(load_size());
+    load_block(&t[0], t.size());
+  }
+
+  template <class T, class A>
+  void load(std::vector<T, A>& t) {
+    t.resize(load_size());
+    load_block(t.data(), t.size());
+  }
+
+  template <class K, class V, class C, class A>
+  void load(std::map<K, V, C, A>& t) {
+    load_map(t);
+  }
+
+  template <class K, class V, class H, class E, class A>
+  void load(std::unordered_map<K, V, H, E, A>& t) {
+    load_map(t);
+  }
+
+  template <class T>
+  std::enable_if_t<std::is_arithmetic<T>::value> load(T& t) {
+    using U = mp11::mp_cond<std::is_same<T, bool>, std::uint8_t,              //
+                            std::is_floating_point<T>, T,                     //
+                            std::is_signed<T>, std::int64_t, std::true_type, //
+                            std::uint64_t>;
+    U u;
+    load_scalar(u);
+    t = static_cast<T>(u);
+  }
+
+  template <class T>
+  std::enable_if_t<std::is_enum<T>::value> load(T& t) {
+    std::underlying_type_t<T> u;
+    load(u);
+    t = static_cast<T>(u);
+  }
+
+  template <class T>
+  std::enable_if_t<std::is_class<T>::value> load(T& t) {
+    std::uint32_t version;
+    load_scalar(version);
+    t.serialize(*this, version);
+  }
+
+  std::size_t load_size() {
+    std::uint64_t n;
+    load_scalar(n);
+    return static_cast<std::size_t>(n);
+  }
+
+  template <class M>
+  void load_map(M& t) {
+    t.clear();
+    for (std::size_t i = 0, n = load_size(); i < n; ++i) {
+      typename M::key_type k;
+      typename M::mapped_type v;
+      load(k);
+      load(v);
+      t.emplace(std::move(k), std::move(v));
+    }
+  }
+
+  template <class T>
+  void load_block(T* p, std::size_t n) {
+    detail::native_block_kind kind;
+    std::uint32_t size, version;
+    load_scalar(kind);
+    load_scalar(size);
+    load_scalar(version);
+    if (kind == detail::native_block_kind::items) {
+      for (auto it = p; it != p + n; ++it) load(*it);
+      return;
+    }
+    load_raw_block(std::is_trivially_copyable<T>{}, p, n, size, version);
+  }
+
+  template <class T>
+  void load_raw_block(std::false_type, T*, std::size_t, std::uint32_t, std::uint32_t) {
+    BOOST_THROW_EXCEPTION(
+        std::runtime_error("archive has raw block of non-trivial type"));
+  }
+
+  template <class T>
+  void load_raw_block(std::true_type, T* p, std::size_t n, std::uint32_t size,
+                      std::uint32_t version) {
+    if (size != sizeof(T) || version != detail::serialization_version<T>::value ||
+        !(std::is_arithmetic<T>::value || detail::is_little_endian()))
+      BOOST_THROW_EXCEPTION(std::runtime_error("archive has block of incompatible type"));
+    // the cells are read directly into their final location
+    read(p, n * sizeof(T));
+    if (!detail::is_little_endian())
+      for (auto it = p; it != p + n; ++it) detail::byteswap_if_big_endian(*it);
+  }
+
+  template <class T>
+  void load_scalar(T& x) {
+    read(&x, sizeof(T));
+    detail::byteswap_if_big_endian(x);
+  }
+
+  void read(void* p, std::size_t n) {
+    if (!is_.read(static_cast<char*>(p), static_cast<std::streamsize>(n)))
+      BOOST_THROW_EXCEPTION(std::runtime_error("unexpected end of archive"));
+  }
+
+  std::istream& is_;
+};
+
+} // namespace histogram
+} // namespace boost
+
+#endif
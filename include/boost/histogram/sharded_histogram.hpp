@@ -0,0 +1,184 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_SHARDED_HISTOGRAM_HPP
+#define BOOST_HISTOGRAM_SHARDED_HISTOGRAM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <boost/histogram/fwd.hpp>
+#include <boost/histogram/histogram.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace histogram {
+
+namespace detail {
+// unique id for each sharded_histogram, ids are never reused
+inline std::size_t next_shard_owner_id() noexcept {
+  static std::atomic<std::size_t> id{0};
+  return ++id;
+}
+} // namespace detail
+
+/** Histogram wrapper for concurrent filling from several threads.
+
+  Each thread that fills the sharded_histogram gets its own replica of the wrapped
+  histogram, the shard, which is allocated on first use. Threads fill their shards
+  without synchronization and without sharing cache lines with other threads, so
+  filling scales with the number of threads and works with any storage. The shards are
+  merged with histogram::operator+= when the merged view is requested. The merged view is
+  cached until the next fill.
+
+  Calling fill methods from several threads concurrently is safe. Reading the merged view
+  while other threads are filling is not; join or synchronize the filling threads first.
+
+  @tparam Axes std::tuple of axis types OR std::vector of an axis type or axis::variant
+  @tparam Storage class that implements the storage interface
+*/
+template <class Axes, class Storage>
+class sharded_histogram {
+public:
+  using histogram_type = histogram<Axes, Storage>;
+
+  /** Create sharded histogram from a histogram.
+
+    The argument is the initial state of the merged view. The shards start as empty
+    copies of it.
+  */
+  explicit sharded_histogram(histogram_type h)
+      : initial_(std::move(h)), merged_(initial_) {}
+
+  sharded_histogram(sharded_histogram&& other)
+      : id_(other.id_)
+      , initial_(std::move(other.initial_))
+      , shards_(std::move(other.shards_))
+      , merged_(std::move(other.merged_))
+      , dirty_(other.dirty_.load()) {
+    // threads cache shard pointers for this id, which are still valid after the move
+    other.id_ = detail::next_shard_owner_id();
+  }
+
+  sharded_histogram(const sharded_histogram&) = delete;
+  sharded_histogram& operator=(const sharded_histogram&) = delete;
+  sharded_histogram& operator=(sharded_histogram&&) = delete;
+
+  /// Fill the shard of the calling thread, accepts arguments of histogram::operator().
+  template <class... Ts>
+  void operator()(const Ts&... ts) {
+    local()(ts...);
+  }
+
+  /// Fill the shard of the calling thread, accepts the arguments of histogram::fill().
+  template <class... Ts>
+  void fill(const Ts&... ts) {
+    local().fill(ts...);
+  }
+
+  /** Return merged view of initial state and all shards.
+
+    The shards are only merged again if they were filled since the last call.
+  */
+  const histogram_type& merged() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (dirty_.load(std::memory_order_relaxed)) merge_impl();
+    return merged_;
+  }
+
+  /// Merge initial state and all shards now and update the merged view.
+  void merge() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    merge_impl();
+  }
+
+  /// Reset initial state and all shards to zero.
+  void reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    initial_.reset();
+    // shards are not deallocated, threads keep pointers to them
+    for (auto&& s : shards_) s.second->reset();
+    merged_ = initial_;
+    dirty_.store(false, std::memory_order_relaxed);
+  }
+
+  /// Number of shards allocated so far.
+  std::size_t shard_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return shards_.size();
+  }
+
+private:
+  histogram_type& local() {
+    // Cache of recently used shards per thread, so that a thread can alternate between
+    // several instances without a lookup. An entry is only valid if its owner matches
+    // id_. The most recently used entry comes first, the last entry is evicted on a miss.
+    struct cache_entry {
+      std::size_t owner = 0;
+      histogram_type* shard = nullptr;
+    };
+    static thread_local cache_entry cache[cache_size];
+    // only write to shared flag if it changes to avoid cache line ping-pong
+    if (!dirty_.load(std::memory_order_relaxed))
+      dirty_.store(true, std::memory_order_relaxed);
+    if (cache[0].owner == id_) return *cache[0].shard;
+    auto it = std::find_if(cache + 1, cache + cache_size,
+                           [this](const cache_entry& e) { return e.owner == id_; });
+    const auto e = it == cache + cache_size ? cache_entry{id_, &find_or_create_shard()}
+                                            : *it;
+    if (it == cache + cache_size) --it;
+    std::move_backward(cache, it, it + 1);
+    cache[0] = e;
+    return *e.shard;
+  }
+
+  void merge_impl() const {
+    auto h = initial_;
+    for (auto&& s : shards_) h += *s.second;
+    merged_ = std::move(h);
+    dirty_.store(false, std::memory_order_relaxed);
+  }
+
+  histogram_type& find_or_create_shard() {
+    const auto tid = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(mutex_);
+    // thread ids may be reused after a thread exits, the new thread then reuses the shard
+    for (auto&& s : shards_)
+      if (s.first == tid) return *s.second;
+    auto h = initial_;
+    h.reset();
+    shards_.emplace_back(tid, std::unique_ptr<histogram_type>(
+                                  new histogram_type(std::move(h))));
+    return *shards_.back().second;
+  }
+
+  static constexpr std::size_t cache_size = 8;
+
+  std::size_t id_ = detail::next_shard_owner_id();
+  histogram_type initial_;
+  std::vector<std::pair<std::thread::id, std::unique_ptr<histogram_type>>> shards_;
+  mutable histogram_type merged_;
+  mutable std::atomic<bool> dirty_{false};
+  mutable std::mutex mutex_;
+};
+
+/** Create sharded histogram from a histogram.
+
+  @param h histogram which is used as initial state, e.g. created with make_histogram.
+*/
+template <class Axes, class Storage>
+sharded_histogram<Axes, Storage> make_sharded_histogram(histogram<Axes, Storage> h) {
+  return sharded_histogram<Axes, Storage>(std::move(h));
+}
+
+} // namespace histogram
+} // namespace boost
+
+#endif
@@ -0,0 +1,389 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_SPARSE_STORAGE_HPP
+#define BOOST_HISTOGRAM_SPARSE_STORAGE_HPP
+
+#include <algorithm>
+#include <boost/core/nvp.hpp>
+#include <boost/histogram/detail/array_wrapper.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/detail/iterator_adaptor.hpp>
+#include <boost/histogram/detail/optional_index.hpp>
+#include <boost/histogram/fwd.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace histogram {
+
+/**
+  Storage for histograms with many cells of which only few are filled.
+
+  Only cells which were written to are stored, in a flat hash table with open
+  addressing and linear probing. Looking up a cell costs a few comparisons in a
+  contiguous array, instead of the node allocations and pointer chasing of a
+  `storage_adaptor<std::map<std::size_t, T>>`. Cells which were never written read as
+  `T{}`. The memory consumption is proportional to the number of occupied cells, not to
+  the number of cells of the histogram.
+
+  Iterating over the storage visits all cells, including the empty ones. Use
+  for_each_occupied() to visit only the occupied cells. Adding another sparse_storage and
+  scaling only touch the occupied cells.
+
+  @tparam T type of the cells, an arithmetic type or an accumulator.
+  @tparam Allocator allocator used for the hash table.
+*/
+template <class T, class Allocator>
+class sparse_storage {
+  struct slot_type {
+    std::size_t key;
+    T value;
+  };
+  using slot_allocator_type =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<slot_type>;
+
+  // marks a free slot, a histogram cannot have this many cells
+  static constexpr std::size_t empty_key = ~static_cast<std::size_t>(0);
+
+public:
+  static constexpr bool has_threading_support = false;
+
+  using allocator_type = Allocator;
+  using value_type = T;
+  using const_reference = const value_type&;
+
+  /// implementation detail
+  class reference {
+  public:
+    reference(sparse_storage& s, std::size_t i) noexcept : sref_(s), idx_(i) {
+      assert(idx_ < sref_.size());
+    }
+
+    reference(const reference&) noexcept = default;
+
+    // references do not rebind, assign through
+    reference& operator=(const reference& x) {
+      return operator=(static_cast<const_reference>(x));
+    }
+
+    reference& operator=(const_reference x) {
+      // do not create a cell to store the default value
+      auto p = sref_.find(idx_);
+      if (p)
+        *p = x;
+      else if (!(x == value_type{}))
+        sref_.insert(idx_) = x;
+      return *this;
+    }
+
+    operator const_reference() const noexcept {
+      return static_cast<const sparse_storage&>(sref_)[idx_];
+    }
+
+    template <class V = value_type,
+              class = std::enable_if_t<detail::has_operator_preincrement<V>::value>>
+    reference& operator++() {
+      ++sref_.insert(idx_);
+      return *this;
+    }
+
+    template <class U, class V = value_type,
+              class = std::enable_if_t<detail::has_operator_radd<V, U>::value>>
+    reference& operator+=(const U& x) {
+      sref_.insert(idx_) += x;
+      return *this;
+    }
+
+    template <class U, class V = value_type,
+              class = std::enable_if_t<detail::has_operator_rsub<V, U>::value>>
+    reference& operator-=(const U& x) {
+      sref_.insert(idx_) -= x;
+      return *this;
+    }
+
+    template <class U, class V = value_type,
+              class = std::enable_if_t<detail::has_operator_rmul<V, U>::value>>
+    reference& operator*=(const U& x) {
+      // scaling an empty cell does not change it
+      if (auto p = sref_.find(idx_)) *p *= x;
+      return *this;
+    }
+
+    template <class U, class V = value_type,
+              class = std::enable_if_t<detail::has_operator_rdiv<V, U>::value>>
+    reference& operator/=(const U& x) {
+      if (auto p = sref_.find(idx_))
+        *p /= x;
+      else if (!(value_type{} / x == value_type{}))
+        sref_.insert(idx_) = value_type{} / x;
+      return *this;
+    }
+
+    template <class U, class = std::enable_if_t<
+                           detail::has_operator_equal<value_type, U>::value>>
+    bool operator==(const U& rhs) const {
+      return operator const_reference() == rhs;
+    }
+
+    template <class U, class = std::enable_if_t<
+                           detail::has_operator_equal<value_type, U>::value>>
+    bool operator!=(const U& rhs) const {
+      return !operator==(rhs);
+    }
+
+    template <class... Ts>
+    auto operator()(const Ts&... args)
+        -> decltype(std::declval<value_type&>()(args...)) {
+      return sref_.insert(idx_)(args...);
+    }
+
+  private:
+    sparse_storage& sref_;
+    std::size_t idx_;
+  };
+
+private:
+  template <class Value, class Reference, class Storage>
+  class iterator_impl
+      : public detail::iterator_adaptor<iterator_impl<Value, Reference, Storage>,
+                                        std::size_t, Reference, Value> {
+  public:
+    iterator_impl() = default;
+    template <class V, class R, class S>
+    iterator_impl(const iterator_impl<V, R, S>& it)
+        : iterator_impl::iterator_adaptor_(it.base()), storage_(it.storage_) {}
+    iterator_impl(Storage* s, std::size_t i) noexcept
+        : iterator_impl::iterator_adaptor_(i), storage_(s) {}
+
+    Reference operator*() const noexcept { return (*storage_)[this->base()]; }
+
+    template <class V, class R, class S>
+    friend class iterator_impl;
+
+  private:
+    Storage* storage_ = nullptr;
+  };
+
+public:
+  using const_iterator =
+      iterator_impl<const value_type, const_reference, const sparse_storage>;
+  using iterator = iterator_impl<value_type, reference, sparse_storage>;
+
+  explicit sparse_storage(const allocator_type& a = {})
+      : slots_(slot_allocator_type(a)) {}
+  sparse_storage(const sparse_storage&) = default;
+  sparse_storage& operator=(const sparse_storage&) = default;
+  sparse_storage(sparse_storage&&) = default;
+  sparse_storage& operator=(sparse_storage&&) = default;
+
+  template <class Iterable, class = detail::requires_iterable<Iterable>>
+  explicit sparse_storage(const Iterable& s) {
+    using std::begin;
+    using std::end;
+    reset(static_cast<std::size_t>(std::distance(begin(s), end(s))));
+    std::size_t i = 0;
+    for (auto&& x : s) (*this)[i++] = x;
+  }
+
+  template <class Iterable, class = detail::requires_iterable<Iterable>>
+  sparse_storage& operator=(const Iterable& s) {
+    *this = sparse_storage(s);
+    return *this;
+  }
+
+  allocator_type get_allocator() const { return allocator_type(slots_.get_allocator()); }
+
+  /// Set number of cells and make all cells empty, the memory is kept.
+  void reset(std::size_t n) {
+    for (auto&& s : slots_) s = slot_type{empty_key, value_type{}};
+    occupied_ = 0;
+    size_ = n;
+  }
+
+  /// Return number of cells.
+  std::size_t size() const noexcept { return size_; }
+
+  /// Return number of cells which were written to.
+  std::size_t occupied() const noexcept { return occupied_; }
+
+  reference operator[](std::size_t i) noexcept { return {*this, i}; }
+
+  const_reference operator[](std::size_t i) const noexcept {
+    assert(i < size_);
+    static const value_type null{};
+    const auto p = find(i);
+    return p ? *p : null;
+  }
+
+  /** Call function for each occupied cell.
+
+    @param f function called with the index and the value of each occupied cell. The order
+    of the cells is unspecified.
+  */
+  template <class F>
+  void for_each_occupied(F&& f) const {
+    for (auto&& s : slots_)
+      if (s.key != empty_key) f(s.key, static_cast<const_reference>(s.value));
+  }
+
+  bool operator==(const sparse_storage& x) const {
+    if (size_ != x.size_) return false;
+    // cells which are occupied in only one storage must be equal to the default value
+    return includes(x) && x.includes(*this);
+  }
+
+  template <class Iterable>
+  bool operator==(const Iterable& iterable) const {
+    if (size() != iterable.size()) return false;
+    return std::equal(begin(), end(), std::begin(iterable));
+  }
+
+  /// Add another sparse storage, only the occupied cells of the argument are touched.
+  template <class V = value_type,
+            class = std::enable_if_t<detail::has_operator_radd<V, V>::value>>
+  sparse_storage& operator+=(const sparse_storage& x) {
+    assert(size_ == x.size_);
+    reserve(occupied_ + x.occupied_);
+    x.for_each_occupied([this](std::size_t i, const_reference v) { insert(i) += v; });
+    return *this;
+  }
+
+  /// Scale occupied cells.
+  template <class V = value_type,
+            class = std::enable_if_t<detail::has_operator_rmul<V, double>::value>>
+  sparse_storage& operator*=(const double x) {
+    for (auto&& s : slots_)
+      if (s.key != empty_key) s.value *= x;
+    return *this;
+  }
+
+  iterator begin() noexcept { return {this, 0}; }
+  iterator end() noexcept { return {this, size()}; }
+  const_iterator begin() const noexcept { return {this, 0}; }
+  const_iterator end() const noexcept { return {this, size()}; }
+
+  /// implementation detail; increments cells at n indices, skips invalid indices
+  template <class Index, class V = value_type,
+            class = std::enable_if_t<detail::has_operator_preincrement<V>::value>>
+  void increment_n(const Index* indices, std::size_t n) {
+    for (auto it = indices, end = indices + n; it != end; ++it)
+      if (detail::is_valid(*it)) ++insert(*it);
+  }
+
+  template <class Archive>
+  void serialize(Archive& ar, unsigned /* version */) {
+    // only occupied cells are stored, the layout of the hash table is not
+    std::vector<std::size_t> keys;
+    std::vector<value_type> values;
+    if (!Archive::is_loading::value) {
+      keys.reserve(occupied_);
+      values.reserve(occupied_);
+      for_each_occupied([&](std::size_t i, const_reference v) {
+        keys.push_back(i);
+        values.push_back(v);
+      });
+    }
+    auto size = size_;
+    auto n = keys.size();
+    ar& make_nvp("size", size);
+    ar& make_nvp("occupied", n);
+    if (Archive::is_loading::value) {
+      keys.resize(n);
+      values.resize(n);
+    }
+    auto wk = detail::make_array_wrapper(keys.data(), n);
+    ar& make_nvp("keys", wk);
+    auto wv = detail::make_array_wrapper(values.data(), n);
+    ar& make_nvp("values", wv);
+    if (Archive::is_loading::value) {
+      reset(size);
+      reserve(n);
+      for (std::size_t k = 0; k < n; ++k) insert(keys[k]) = values[k];
+    }
+  }
+
+private:
+  // Fibonacci hashing, spreads consecutive indices over the table
+  std::size_t slot_index(std::size_t i) const noexcept {
+    return static_cast<std::size_t>((static_cast<std::uint64_t>(i) *
+                                     UINT64_C(0x9E3779B97F4A7C15)) >>
+                                    shift_);
+  }
+
+  const value_type* find(std::size_t i) const noexcept {
+    if (slots_.empty()) return nullptr;
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t k = slot_index(i);; k = (k + 1) & mask) {
+      const auto& s = slots_[k];
+      if (s.key == i) return &s.value;
+      if (s.key == empty_key) return nullptr;
+    }
+  }
+
+  value_type* find(std::size_t i) noexcept {
+    return const_cast<value_type*>(static_cast<const sparse_storage*>(this)->find(i));
+  }
+
+  // returns the cell, which is created with the default value if necessary
+  value_type& insert(std::size_t i) {
+    assert(i < size_);
+    reserve(occupied_ + 1);
+    const std::size_t mask = slots_.size() - 1;
+    for (std::size_t k = slot_index(i);; k = (k + 1) & mask) {
+      auto& s = slots_[k];
+      if (s.key == i) return s.value;
+      if (s.key == empty_key) {
+        s.key = i;
+        ++occupied_;
+        return s.value;
+      }
+    }
+  }
+
+  // make room for n occupied cells; the table is at most 3/4 full
+  void reserve(std::size_t n) {
+    if (4 * n <= 3 * slots_.size()) return;
+    std::size_t capacity = 16;
+    unsigned shift = 60;
+    while (4 * n > 3 * capacity) {
+      capacity *= 2;
+      --shift;
+    }
+    decltype(slots_) old(capacity, slot_type{empty_key, value_type{}},
+                         slots_.get_allocator());
+    old.swap(slots_);
+    shift_ = shift;
+    occupied_ = 0;
+    for (auto&& s : old)
+      if (s.key != empty_key) insert(s.key) = std::move(s.value);
+  }
+
+  bool includes(const sparse_storage& x) const {
+    for (auto&& s : slots_)
+      if (s.key != empty_key && !(x[s.key] == s.value)) return false;
+    return true;
+  }
+
+  std::vector<slot_type, slot_allocator_type> slots_;
+  std::size_t size_ = 0;
+  std::size_t occupied_ = 0;
+  unsigned shift_ = 64;
+};
+
+template <class T, class Allocator>
+constexpr std::size_t sparse_storage<T, Allocator>::empty_key;
+
+} // namespace histogram
+} // namespace boost
+
+#endif
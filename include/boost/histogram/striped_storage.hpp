@@ -0,0 +1,294 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_STRIPED_STORAGE_HPP
+#define BOOST_HISTOGRAM_STRIPED_STORAGE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <boost/core/nvp.hpp>
+#include <boost/histogram/detail/array_wrapper.hpp>
+#include <boost/histogram/detail/atomic_number.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/detail/iterator_adaptor.hpp>
+#include <boost/histogram/detail/optional_index.hpp>
+#include <boost/histogram/fwd.hpp>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace boost {
+namespace histogram {
+
+namespace detail {
+// small number which is unique for each thread, assigned in order of first use
+inline unsigned thread_stripe_seed() noexcept {
+  static std::atomic<unsigned> counter{0};
+  static thread_local const unsigned seed = counter++;
+  return seed;
+}
+} // namespace detail
+
+/**
+  Thread-safe storage for counters which avoids contention between threads.
+
+  The storage keeps several copies of each cell, called stripes. A thread always updates
+  the same stripe with atomic operations; different threads use different stripes as long
+  as there are not more threads than stripes. The stripes are separated by at least one
+  cache line, so that threads which update neighbouring cells do not compete for the same
+  cache line (false sharing). Reading a cell returns the sum over all stripes.
+
+  This makes concurrent filling of small histograms scale with the number of threads,
+  where a dense_storage of thread-safe accumulators::count would be slowed down by
+  contention. The memory consumption is multiplied by the number of stripes, so this
+  storage is best for histograms with few cells. Reading is slower than for other
+  storages, since the values of all stripes have to be added.
+
+  Increments and additions are thread-safe, but assigning to cells and scaling are not.
+
+  @tparam T arithmetic type used for the counters.
+  @tparam Allocator allocator used for the counters.
+*/
+template <class T, class Allocator>
+class striped_storage {
+  static_assert(std::is_arithmetic<T>::value, "counter type must be arithmetic");
+
+  using cell_type = detail::atomic_number<T>;
+  using cell_allocator_type =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<cell_type>;
+
+  // conservative estimate, std::hardware_destructive_interference_size needs C++17
+  static constexpr std::size_t cache_line_size = 64;
+  static constexpr std::size_t cells_per_line =
+      (std::max)(std::size_t{1}, cache_line_size / sizeof(cell_type));
+
+public:
+  static constexpr bool has_threading_support = true;
+
+  using allocator_type = Allocator;
+  using value_type = T;
+  using const_reference = value_type;
+
+  /// implementation detail
+  class reference {
+  public:
+    reference(striped_storage& s, std::size_t i) noexcept : sref_(s), idx_(i) {
+      assert(idx_ < sref_.size());
+    }
+
+    reference(const reference&) noexcept = default;
+
+    // references do not rebind, assign through
+    reference& operator=(const reference& x) { return operator=(static_cast<T>(x)); }
+
+    // not thread-safe
+    reference& operator=(const T& x) noexcept {
+      sref_.assign(idx_, x);
+      return *this;
+    }
+
+    operator T() const noexcept {
+      return static_cast<const striped_storage&>(sref_)[idx_];
+    }
+
+    reference& operator++() noexcept {
+      ++sref_.local_stripe()[idx_];
+      return *this;
+    }
+
+    reference& operator+=(const T& x) noexcept {
+      sref_.local_stripe()[idx_] += x;
+      return *this;
+    }
+
+    reference& operator-=(const T& x) noexcept { return operator+=(-x); }
+
+    // not thread-safe
+    reference& operator*=(const double x) noexcept {
+      sref_.scale(idx_, x);
+      return *this;
+    }
+
+    // not thread-safe
+    reference& operator/=(const double x) noexcept { return operator*=(1.0 / x); }
+
+  private:
+    striped_storage& sref_;
+    std::size_t idx_;
+  };
+
+private:
+  template <class Value, class Reference, class Storage>
+  class iterator_impl
+      : public detail::iterator_adaptor<iterator_impl<Value, Reference, Storage>,
+                                        std::size_t, Reference, Value> {
+  public:
+    iterator_impl() = default;
+    template <class V, class R, class S>
+    iterator_impl(const iterator_impl<V, R, S>& it)
+        : iterator_impl::iterator_adaptor_(it.base()), storage_(it.storage_) {}
+    iterator_impl(Storage* s, std::size_t i) noexcept
+        : iterator_impl::iterator_adaptor_(i), storage_(s) {}
+
+    Reference operator*() const noexcept { return (*storage_)[this->base()]; }
+
+    template <class V, class R, class S>
+    friend class iterator_impl;
+
+  private:
+    Storage* storage_ = nullptr;
+  };
+
+public:
+  using const_iterator = iterator_impl<const value_type, const_reference,
+                                       const striped_storage>;
+  using iterator = iterator_impl<value_type, reference, striped_storage>;
+
+  /** Create storage with a number of stripes.
+
+    @param stripes number of copies of each cell; 0 uses the number of hardware threads.
+    The number is rounded up to the next power of two.
+    @param a allocator instance.
+  */
+  explicit striped_storage(unsigned stripes = 0, const allocator_type& a = {})
+      : buffer_(cell_allocator_type(a)) {
+    if (stripes == 0) stripes = std::thread::hardware_concurrency();
+    unsigned n = 1;
+    while (n < stripes) n *= 2;
+    mask_ = n - 1;
+  }
+
+  /// Create storage with one stripe per hardware thread.
+  explicit striped_storage(const allocator_type& a) : striped_storage(0, a) {}
+
+  striped_storage(const striped_storage&) = default;
+  striped_storage& operator=(const striped_storage&) = default;
+  striped_storage(striped_storage&&) = default;
+  striped_storage& operator=(striped_storage&&) = default;
+
+  template <class Iterable, class = detail::requires_iterable<Iterable>>
+  explicit striped_storage(const Iterable& s) : striped_storage() {
+    using std::begin;
+    using std::end;
+    reset(static_cast<std::size_t>(std::distance(begin(s), end(s))));
+    std::copy(begin(s), end(s), buffer_.begin());
+  }
+
+  template <class Iterable, class = detail::requires_iterable<Iterable>>
+  striped_storage& operator=(const Iterable& s) {
+    *this = striped_storage(s);
+    return *this;
+  }
+
+  allocator_type get_allocator() const { return allocator_type(buffer_.get_allocator()); }
+
+  /// Return empty storage with the same allocator and number of stripes.
+  striped_storage make_default() const {
+    return striped_storage(stripes(), get_allocator());
+  }
+
+  /// Return number of copies of each cell.
+  unsigned stripes() const noexcept { return mask_ + 1; }
+
+  void reset(std::size_t n) {
+    // stripes are padded to whole cache lines and separated by one extra cache line,
+    // so that no two stripes share a cache line regardless of the buffer alignment
+    stride_ = (n + cells_per_line - 1) / cells_per_line * cells_per_line + cells_per_line;
+    buffer_.assign(stride_ * stripes(), cell_type(T{}));
+    size_ = n;
+  }
+
+  std::size_t size() const noexcept { return size_; }
+
+  reference operator[](std::size_t i) noexcept { return {*this, i}; }
+
+  const_reference operator[](std::size_t i) const noexcept {
+    assert(i < size_);
+    T sum{};
+    for (std::size_t k = i; k < buffer_.size(); k += stride_) sum += buffer_[k].load();
+    return sum;
+  }
+
+  bool operator==(const striped_storage& x) const noexcept {
+    if (size() != x.size()) return false;
+    return std::equal(begin(), end(), x.begin());
+  }
+
+  template <class Iterable>
+  bool operator==(const Iterable& iterable) const {
+    if (size() != iterable.size()) return false;
+    return std::equal(begin(), end(), std::begin(iterable));
+  }
+
+  // not thread-safe
+  striped_storage& operator*=(const double x) noexcept {
+    for (std::size_t i = 0; i < size_; ++i) scale(i, x);
+    return *this;
+  }
+
+  iterator begin() noexcept { return {this, 0}; }
+  iterator end() noexcept { return {this, size()}; }
+  const_iterator begin() const noexcept { return {this, 0}; }
+  const_iterator end() const noexcept { return {this, size()}; }
+
+  /// implementation detail; increments cells at n indices, skips invalid indices
+  template <class Index>
+  void increment_n(const Index* indices, std::size_t n) noexcept {
+    // look up stripe of calling thread only once
+    auto stripe = local_stripe();
+    for (auto it = indices, end = indices + n; it != end; ++it)
+      if (detail::is_valid(*it)) ++stripe[*it];
+  }
+
+  template <class Archive>
+  void serialize(Archive& ar, unsigned /* version */) {
+    // only the sums are stored, the number of stripes is a property of the machine
+    std::vector<T> values(begin(), end());
+    std::size_t size = values.size();
+    ar& make_nvp("size", size);
+    if (Archive::is_loading::value) values.resize(size);
+    auto w = detail::make_array_wrapper(values.data(), size);
+    ar& make_nvp("buffer", w);
+    if (Archive::is_loading::value) {
+      reset(size);
+      std::copy(values.begin(), values.end(), buffer_.begin());
+    }
+  }
+
+private:
+  cell_type* local_stripe() noexcept {
+    assert(buffer_.size() > 0);
+    return buffer_.data() + (detail::thread_stripe_seed() & mask_) * stride_;
+  }
+
+  void assign(std::size_t i, const T& x) noexcept {
+    for (std::size_t k = i; k < buffer_.size(); k += stride_) buffer_[k].store(T{});
+    buffer_[i].store(x);
+  }
+
+  // the sum is scaled, so that integral cells are truncated once and not per stripe
+  void scale(std::size_t i, const double x) noexcept {
+    const T sum = static_cast<const striped_storage&>(*this)[i];
+    assign(i, static_cast<T>(sum * x));
+  }
+
+  std::vector<cell_type, cell_allocator_type> buffer_;
+  std::size_t size_ = 0;
+  std::size_t stride_ = 0;
+  unsigned mask_ = 0;
+};
+
+template <class T, class Allocator>
+constexpr std::size_t striped_storage<T, Allocator>::cells_per_line;
+
+} // namespace histogram
+} // namespace boost
+
+#endif
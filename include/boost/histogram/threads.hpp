@@ -0,0 +1,32 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_THREADS_HPP
+#define BOOST_HISTOGRAM_THREADS_HPP
+
+namespace boost {
+namespace histogram {
+
+/** Holder for the number of threads used by an operation.
+
+  You should not construct these directly, use the threads() helper function.
+*/
+struct threads_type {
+  /// Access number of threads.
+  unsigned value;
+};
+
+/** Helper function to request that an operation uses several threads.
+
+  @param n number of threads to use, including the calling thread; 0 and 1 both mean
+  that only the calling thread is used.
+*/
+inline threads_type threads(unsigned n) noexcept { return threads_type{n}; }
+
+} // namespace histogram
+} // namespace boost
+
+#endif
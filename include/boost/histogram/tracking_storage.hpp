@@ -0,0 +1,322 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_TRACKING_STORAGE_HPP
+#define BOOST_HISTOGRAM_TRACKING_STORAGE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <boost/core/nvp.hpp>
+#include <boost/histogram/detail/atomic_number.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/detail/iterator_adaptor.hpp>
+#include <boost/histogram/detail/make_default.hpp>
+#include <boost/histogram/detail/optional_index.hpp>
+#include <boost/histogram/detail/static_if.hpp>
+#include <boost/histogram/fwd.hpp>
+#include <boost/throw_exception.hpp>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace histogram {
+
+/**
+  Storage which remembers which cells were changed since the last checkpoint.
+
+  The storage wraps another storage and divides its cells into blocks of equal size.
+  Each block has a dirty bit, which is set when a cell of the block is accessed for
+  writing. make_delta() returns the cells of all dirty blocks, and apply_delta() writes
+  them into another storage of the same size. checkpoint() clears the dirty bits.
+
+  This allows one to keep a copy of a histogram in sync, for example in a process that
+  aggregates histograms from several fillers. The cost of a sync is proportional to the
+  number of changed blocks instead of the number of cells. A delta can be serialized
+  like a histogram.
+
+  Any non-const access to a cell marks its block as dirty, even if the cell is only
+  read. Resetting the storage marks all blocks as dirty. Marking is thread-safe, so cells
+  can be written concurrently if the wrapped storage allows it.
+
+  @tparam Storage storage which holds the cells.
+*/
+template <class Storage>
+class tracking_storage {
+  using word_type = std::uint64_t;
+  static constexpr unsigned word_bits = 64;
+
+public:
+  static constexpr bool has_threading_support = false;
+
+  using storage_type = Storage;
+  using value_type = typename storage_type::value_type;
+  using reference = typename storage_type::reference;
+  using const_reference = typename storage_type::const_reference;
+
+  /// Cells of the blocks which were changed since the last checkpoint.
+  class delta_type {
+  public:
+    /// Return number of cells of the storage the delta was made from.
+    std::size_t size() const noexcept { return size_; }
+
+    /// Return number of cells per block.
+    std::size_t block_size() const noexcept { return block_size_; }
+
+    /// Return indices of the changed blocks in ascending order.
+    const std::vector<std::size_t>& blocks() const noexcept { return blocks_; }
+
+    /// Return cells of the changed blocks, concatenated in the order of blocks().
+    const storage_type& cells() const noexcept { return cells_; }
+
+    template <class Archive>
+    void serialize(Archive& ar, unsigned /* version */) {
+      ar& make_nvp("size", size_);
+      ar& make_nvp("block_size", block_size_);
+      ar& make_nvp("blocks", blocks_);
+      ar& make_nvp("cells", cells_);
+    }
+
+  private:
+    std::size_t size_ = 0;
+    std::size_t block_size_ = 0;
+    std::vector<std::size_t> blocks_;
+    storage_type cells_;
+
+    friend class tracking_storage;
+  };
+
+private:
+  template <class Value, class Reference, class S>
+  class iterator_impl
+      : public detail::iterator_adaptor<iterator_impl<Value, Reference, S>, std::size_t,
+                                        Reference, Value> {
+  public:
+    iterator_impl() = default;
+    template <class V, class R, class T>
+    iterator_impl(const iterator_impl<V, R, T>& it)
+        : iterator_impl::iterator_adaptor_(it.base()), storage_(it.storage_) {}
+    iterator_impl(S* s, std::size_t i) noexcept
+        : iterator_impl::iterator_adaptor_(i), storage_(s) {}
+
+    // the block is marked when a cell is accessed, not when the iterator is created
+    Reference operator*() const { return (*storage_)[this->base()]; }
+
+    template <class V, class R, class T>
+    friend class iterator_impl;
+
+  private:
+    S* storage_ = nullptr;
+  };
+
+public:
+  using const_iterator =
+      iterator_impl<const value_type, const_reference, const tracking_storage>;
+  using iterator = iterator_impl<value_type, reference, tracking_storage>;
+
+  /// Construct storage with blocks of 64 cells.
+  tracking_storage() = default;
+
+  /** Construct storage.
+
+    @param block_size number of cells per block, rounded up to the next power of two.
+    Smaller blocks make deltas more compact, but the dirty bits use more memory.
+    @param s storage which holds the cells.
+  */
+  explicit tracking_storage(std::size_t block_size, storage_type s = storage_type())
+      : storage_(std::move(s)), shift_(0) {
+    if (block_size == 0)
+      BOOST_THROW_EXCEPTION(std::invalid_argument("block_size must be positive"));
+    while ((std::size_t{1} << shift_) < block_size) ++shift_;
+  }
+
+  /// Wrap storage, using blocks of 64 cells.
+  explicit tracking_storage(storage_type s) : storage_(std::move(s)) {}
+
+  tracking_storage(const tracking_storage&) = default;
+  tracking_storage& operator=(const tracking_storage&) = default;
+  tracking_storage(tracking_storage&&) = default;
+  tracking_storage& operator=(tracking_storage&&) = default;
+
+  /// Set number of cells, reset cells, and mark all blocks as dirty.
+  void reset(std::size_t n) {
+    storage_.reset(n);
+    dirty_.assign((blocks() + word_bits - 1) / word_bits, ~word_type{0});
+  }
+
+  /// Return number of cells.
+  std::size_t size() const noexcept { return storage_.size(); }
+
+  /// Return number of cells per block.
+  std::size_t block_size() const noexcept { return std::size_t{1} << shift_; }
+
+  /// Return empty storage with the same block size and configuration of the wrapped
+  /// storage.
+  tracking_storage make_default() const {
+    return tracking_storage(block_size(), detail::make_default(storage_));
+  }
+
+  /// Return the wrapped storage.
+  const storage_type& storage() const noexcept { return storage_; }
+
+  /// Return true if any cell of the block was changed since the last checkpoint.
+  bool is_dirty(std::size_t block) const noexcept {
+    assert(block < blocks());
+    return (dirty_[block / word_bits].load(std::memory_order_relaxed) >>
+            (block % word_bits)) &
+           1;
+  }
+
+  /// Clear the dirty bits of all blocks.
+  void checkpoint() noexcept {
+    for (auto&& w : dirty_) w.store(0, std::memory_order_relaxed);
+  }
+
+  /// Return cells of all blocks which were changed since the last checkpoint.
+  delta_type make_delta() const {
+    delta_type d;
+    d.size_ = size();
+    d.block_size_ = block_size();
+    std::size_t ncells = 0;
+    for_each_dirty([&](std::size_t b) {
+      d.blocks_.push_back(b);
+      ncells += block_end(b) - (b << shift_);
+    });
+    d.cells_.reset(ncells);
+    std::size_t j = 0;
+    for (auto&& b : d.blocks_)
+      for (std::size_t i = b << shift_, end = block_end(b); i != end; ++i)
+        d.cells_[j++] = storage_[i];
+    return d;
+  }
+
+  /** Overwrite cells with those of a delta and mark their blocks as dirty.
+
+    The delta must be made from a storage with the same number of cells and the same
+    block size.
+  */
+  void apply_delta(const delta_type& d) {
+    // check everything first, so that the storage is not changed if the delta is bad
+    bool ok = d.size_ == size() && d.block_size_ == block_size();
+    std::size_t ncells = 0;
+    for (auto&& b : d.blocks_) {
+      if (!ok || b >= blocks()) {
+        ok = false;
+        break;
+      }
+      ncells += block_end(b) - (b << shift_);
+    }
+    if (!ok || ncells != d.cells_.size())
+      BOOST_THROW_EXCEPTION(std::invalid_argument("delta does not match storage"));
+    std::size_t j = 0;
+    for (auto&& b : d.blocks_) {
+      mark(b << shift_);
+      for (std::size_t i = b << shift_, end = block_end(b); i != end; ++i)
+        storage_[i] = d.cells_[j++];
+    }
+  }
+
+  reference operator[](std::size_t i) {
+    mark(i);
+    return storage_[i];
+  }
+
+  const_reference operator[](std::size_t i) const { return storage_[i]; }
+
+  bool operator==(const tracking_storage& x) const { return storage_ == x.storage_; }
+
+  template <class Iterable, class = detail::requires_iterable<Iterable>>
+  bool operator==(const Iterable& iterable) const {
+    return storage_ == iterable;
+  }
+
+  /// Scale all cells and mark all blocks as dirty.
+  template <class S = storage_type,
+            class = std::enable_if_t<detail::has_operator_rmul<S, double>::value>>
+  tracking_storage& operator*=(const double x) {
+    storage_ *= x;
+    for (auto&& w : dirty_) w.store(~word_type{0}, std::memory_order_relaxed);
+    return *this;
+  }
+
+  iterator begin() noexcept { return {this, 0}; }
+  iterator end() noexcept { return {this, size()}; }
+  const_iterator begin() const noexcept { return {this, 0}; }
+  const_iterator end() const noexcept { return {this, size()}; }
+
+  /// implementation detail; increments cells at n indices, skips invalid indices
+  template <class Index, class V = value_type,
+            class = std::enable_if_t<detail::has_operator_preincrement<V>::value>>
+  void increment_n(const Index* indices, std::size_t n) {
+    for (auto it = indices, end = indices + n; it != end; ++it)
+      if (detail::is_valid(*it)) mark(*it);
+    detail::static_if<detail::has_method_increment_n<storage_type, Index>>(
+        [indices, n](auto& s) { s.increment_n(indices, n); },
+        [indices, n](auto& s) {
+          for (auto it = indices, end = indices + n; it != end; ++it)
+            if (detail::is_valid(*it)) ++s[*it];
+        },
+        storage_);
+  }
+
+  template <class Archive>
+  void serialize(Archive& ar, unsigned /* version */) {
+    ar& make_nvp("shift", shift_);
+    ar& make_nvp("storage", storage_);
+    // a loaded storage is not in sync with anything
+    if (Archive::is_loading::value)
+      dirty_.assign((blocks() + word_bits - 1) / word_bits, ~word_type{0});
+  }
+
+private:
+  std::size_t blocks() const noexcept { return (size() + block_size() - 1) >> shift_; }
+
+  std::size_t block_end(std::size_t b) const noexcept {
+    return (std::min)((b + 1) << shift_, size());
+  }
+
+  // Cells of a parallel fill are written concurrently, so the bit is set atomically. It
+  // is read first, because most accesses hit a dirty block and an atomic write is slow.
+  void mark(std::size_t i) noexcept {
+    assert(i < size());
+    const auto b = i >> shift_;
+    const auto bit = word_type{1} << (b % word_bits);
+    auto& w = dirty_[b / word_bits];
+    if (!(w.load(std::memory_order_relaxed) & bit))
+      w.fetch_or(bit, std::memory_order_relaxed);
+  }
+
+  // calls f with the index of each dirty block in ascending order, skips clean words
+  template <class F>
+  void for_each_dirty(F&& f) const {
+    const auto nblocks = blocks();
+    for (std::size_t k = 0; k < dirty_.size(); ++k) {
+      for (auto w = dirty_[k].load(std::memory_order_relaxed); w != 0; w &= w - 1) {
+        unsigned bit = 0;
+        while (!((w >> bit) & 1)) ++bit;
+        const auto b = k * word_bits + bit;
+        if (b < nblocks) f(b);
+      }
+    }
+  }
+
+  storage_type storage_;
+  std::vector<detail::atomic_number<word_type>> dirty_;
+  unsigned shift_ = 6; // blocks of 64 cells
+};
+
+template <class Storage>
+constexpr unsigned tracking_storage<Storage>::word_bits;
+
+} // namespace histogram
+} // namespace boost
+
+#endif
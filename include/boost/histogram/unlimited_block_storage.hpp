@@ -0,0 +1,172 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_UNLIMITED_BLOCK_STORAGE_HPP
+#define BOOST_HISTOGRAM_UNLIMITED_BLOCK_STORAGE_HPP
+
+#include <algorithm>
+#include <boost/core/nvp.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/detail/iterator_adaptor.hpp>
+#include <boost/histogram/fwd.hpp>
+#include <boost/histogram/unlimited_storage.hpp>
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace boost {
+namespace histogram {
+
+/**
+  Memory-efficient storage for integral counters which cannot overflow, with
+  block-local counter types.
+
+  This storage offers the same no-overflow-guarantee as unlimited_storage and uses the
+  same counter types. The cells are split into blocks of fixed size, each block is an
+  unlimited_storage with its own counter type. If a counter overflows, only the block
+  with this counter is converted to the next wider type. The memory consumption is
+  therefore proportional to the dynamic range of the counts in each block, instead of
+  the maximum count in the whole storage. This is useful for large histograms in which
+  few cells have large counts.
+
+  Accessing a cell requires an additional indirection compared to unlimited_storage.
+*/
+template <class Allocator>
+class unlimited_block_storage {
+  using block_type = unlimited_storage<Allocator>;
+  using block_allocator_type =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<block_type>;
+
+public:
+  static constexpr bool has_threading_support = false;
+
+  /// Number of cells in each block, only the last block may be smaller.
+  static constexpr std::size_t block_size = 1024;
+
+  using allocator_type = Allocator;
+  using value_type = double;
+  using large_int = typename block_type::large_int;
+  using reference = typename block_type::reference;
+  using const_reference = typename block_type::const_reference;
+
+private:
+  template <class Value, class Reference, class Storage>
+  class iterator_impl
+      : public detail::iterator_adaptor<iterator_impl<Value, Reference, Storage>,
+                                        std::size_t, Reference, Value> {
+  public:
+    iterator_impl() = default;
+    template <class V, class R, class S>
+    iterator_impl(const iterator_impl<V, R, S>& it)
+        : iterator_impl::iterator_adaptor_(it.base()), storage_(it.storage_) {}
+    iterator_impl(Storage* s, std::size_t i) noexcept
+        : iterator_impl::iterator_adaptor_(i), storage_(s) {}
+
+    Reference operator*() const noexcept { return (*storage_)[this->base()]; }
+
+    template <class V, class R, class S>
+    friend class iterator_impl;
+
+  private:
+    Storage* storage_ = nullptr;
+  };
+
+public:
+  using const_iterator =
+      iterator_impl<const value_type, const_reference, const unlimited_block_storage>;
+  using iterator = iterator_impl<value_type, reference, unlimited_block_storage>;
+
+  explicit unlimited_block_storage(const allocator_type& a = {})
+      : blocks_(block_allocator_type(a)) {}
+  unlimited_block_storage(const unlimited_block_storage&) = default;
+  unlimited_block_storage& operator=(const unlimited_block_storage&) = default;
+  unlimited_block_storage(unlimited_block_storage&&) = default;
+  unlimited_block_storage& operator=(unlimited_block_storage&&) = default;
+
+  template <class Iterable, class = detail::requires_iterable<Iterable>>
+  explicit unlimited_block_storage(const Iterable& s) {
+    using std::begin;
+    using std::end;
+    reset(static_cast<std::size_t>(std::distance(begin(s), end(s))));
+    std::copy(begin(s), end(s), this->begin());
+  }
+
+  template <class Iterable, class = detail::requires_iterable<Iterable>>
+  unlimited_block_storage& operator=(const Iterable& s) {
+    *this = unlimited_block_storage(s);
+    return *this;
+  }
+
+  allocator_type get_allocator() const {
+    return allocator_type(blocks_.get_allocator());
+  }
+
+  void reset(std::size_t n) {
+    blocks_.clear();
+    blocks_.reserve((n + block_size - 1) / block_size);
+    for (std::size_t i = 0; i < n; i += block_size) {
+      blocks_.emplace_back(get_allocator());
+      blocks_.back().reset((std::min)(block_size, n - i));
+    }
+    size_ = n;
+  }
+
+  std::size_t size() const noexcept { return size_; }
+
+  reference operator[](std::size_t i) noexcept {
+    assert(i < size_);
+    return blocks_[i / block_size][i % block_size];
+  }
+
+  const_reference operator[](std::size_t i) const noexcept {
+    assert(i < size_);
+    return blocks_[i / block_size][i % block_size];
+  }
+
+  bool operator==(const unlimited_block_storage& x) const noexcept {
+    if (size() != x.size()) return false;
+    return std::equal(blocks_.begin(), blocks_.end(), x.blocks_.begin());
+  }
+
+  template <class Iterable>
+  bool operator==(const Iterable& iterable) const {
+    if (size() != iterable.size()) return false;
+    return std::equal(begin(), end(), std::begin(iterable));
+  }
+
+  unlimited_block_storage& operator*=(const double x) {
+    for (auto&& b : blocks_) b *= x;
+    return *this;
+  }
+
+  iterator begin() noexcept { return {this, 0}; }
+  iterator end() noexcept { return {this, size()}; }
+  const_iterator begin() const noexcept { return {this, 0}; }
+  const_iterator end() const noexcept { return {this, size()}; }
+
+  template <class Archive>
+  void serialize(Archive& ar, unsigned /* version */) {
+    auto size = size_;
+    ar& make_nvp("size", size);
+    if (Archive::is_loading::value) reset(size);
+    for (auto&& b : blocks_) ar& make_nvp("block", b);
+  }
+
+private:
+  std::vector<block_type, block_allocator_type> blocks_;
+  std::size_t size_ = 0;
+
+  friend struct unsafe_access;
+};
+
+template <class Allocator>
+constexpr std::size_t unlimited_block_storage<Allocator>::block_size;
+
+} // namespace histogram
+} // namespace boost
+
+#endif
@@ -16,6 +16,7 @@
 #include <boost/histogram/detail/iterator_adaptor.hpp>
 #include <boost/histogram/detail/large_int.hpp>
 #include <boost/histogram/detail/operators.hpp>
+#include <boost/histogram/detail/optional_index.hpp>
 #include <boost/histogram/detail/safe_comparison.hpp>
 #include <boost/histogram/fwd.hpp>
 #include <boost/mp11/algorithm.hpp>
@@ -26,6 +27,7 @@
 #include <cstdint>
 #include <functional>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <type_traits>
 
@@ -125,6 +127,9 @@ void buffer_destroy(Allocator& a, typename std::allocator_traits<Allocator>::poi
 
   A scaling operation or adding a floating point number triggers a conversion of the
   elemental counters into doubles, which voids the no-overflow-guarantee.
+
+  When a histogram with this storage grows, the array is reallocated with room for as
+  many cells again, so that the cells are not copied on every growth of an axis.
 */
 template <class Allocator>
 class unlimited_storage {
@@ -176,7 +181,11 @@ public:
         : alloc(std::move(o.alloc))
         , size(boost::exchange(o.size, 0))
         , type(boost::exchange(o.type, 0))
-        , ptr(boost::exchange(o.ptr, nullptr)) {}
+        , ptr(boost::exchange(o.ptr, nullptr))
+        , capacity(boost::exchange(o.capacity, 0))
+        , front(boost::exchange(o.front, 0))
+        , bound(boost::exchange(o.bound, 0))
+        , drift(boost::exchange(o.drift, 0)) {}
 
     buffer_type& operator=(buffer_type&& o) noexcept {
       using std::swap;
@@ -184,6 +193,10 @@ public:
       swap(size, o.size);
       swap(type, o.type);
       swap(ptr, o.ptr);
+      swap(capacity, o.capacity);
+      swap(front, o.front);
+      swap(bound, o.bound);
+      swap(drift, o.drift);
       return *this;
     }
 
@@ -192,6 +205,8 @@ public:
         using T = std::decay_t<decltype(*xp)>;
         this->template make<T>(n, xp);
       });
+      bound = x.bound;
+      drift = x.drift;
     }
 
     buffer_type& operator=(const buffer_type& o) {
@@ -209,11 +224,15 @@ public:
         using alloc_type =
             typename std::allocator_traits<allocator_type>::template rebind_alloc<T>;
         alloc_type a(alloc); // rebind allocator
-        detail::buffer_destroy(a, p, this->size);
+        detail::buffer_destroy(a, p - this->front, this->capacity);
       });
       size = 0;
       type = 0;
       ptr = nullptr;
+      capacity = 0;
+      front = 0;
+      bound = 0;
+      drift = 0;
     }
 
     template <class T>
@@ -229,6 +248,7 @@ public:
       }
       size = n;
       type = type_index<T>();
+      capacity = n;
     }
 
     template <class T, class U>
@@ -247,12 +267,71 @@ public:
       size = n;
       type = new_type;
       ptr = new_ptr;
+      capacity = n;
+      bound = unknown_bound;
+    }
+
+    // Resize to n cells and move cell i to position i + d. The free space in front of
+    // and after the cells is used if it is large enough, otherwise the cells are moved
+    // into a new allocation with room for as many cells again, so that a sequence of
+    // small growths costs amortized constant time per cell. The free space is only
+    // split between front and back after a growth at the front. New cells are zero.
+    template <class T>
+    void grow(T* p, std::size_t n, std::size_t d) {
+      assert(size + d <= n);
+      if (d <= front && front - d + n <= capacity) {
+        // free space holds zero-initialized cells
+        ptr = p - d;
+        front -= d;
+        size = n;
+        return;
+      }
+      using alloc_type =
+          typename std::allocator_traits<allocator_type>::template rebind_alloc<T>;
+      alloc_type a(alloc);
+      const std::size_t new_capacity = 2 * n;
+      const std::size_t new_front = (d > 0 || front > 0) ? (new_capacity - n) / 2 : 0;
+      auto base = static_cast<T*>(detail::buffer_create(a, new_capacity)); // may throw
+      std::move(p, p + size, base + new_front + d);
+      // cell values do not change, so the bound stays valid
+      const auto old_bound = bound, old_drift = drift;
+      destroy();
+      bound = old_bound;
+      drift = old_drift;
+      size = n;
+      type = type_index<T>();
+      ptr = base + new_front;
+      capacity = new_capacity;
+      front = new_front;
+    }
+
+    static constexpr std::uint64_t unknown_bound = (std::numeric_limits<U64>::max)();
+
+    // raise upper bound of cell values by x
+    void raise_bound(std::uint64_t x) noexcept {
+      bound = x < unknown_bound - bound ? bound + x : unknown_bound;
+      drift = x < unknown_bound - drift ? drift + x : unknown_bound;
+    }
+
+    // how much cells of integral type T can be raised without an overflow check
+    template <class T>
+    std::uint64_t headroom() const noexcept {
+      constexpr std::uint64_t tmax = (std::numeric_limits<T>::max)();
+      return bound < tmax ? tmax - bound : 0;
     }
 
     allocator_type alloc;
     std::size_t size = 0;
     unsigned type = 0;
     mutable void* ptr = nullptr;
+    // allocated cells and unused cells in front of ptr; unused cells are zero
+    std::size_t capacity = 0;
+    std::size_t front = 0;
+    // Upper bound of the integral cell values and the sum of the raises of the bound
+    // since it was computed from the cells. Writes to cells other than through
+    // increment_n must set the bound to unknown_bound.
+    std::uint64_t bound = 0;
+    std::uint64_t drift = 0;
   };
 
   class reference; // forward declare to make friend of const_reference
@@ -493,6 +572,22 @@ public:
   const_iterator begin() const noexcept { return {&buffer_, 0}; }
   const_iterator end() const noexcept { return {&buffer_, size()}; }
 
+  /// implementation detail; increments cells at n indices, skips invalid indices
+  template <class Index>
+  void increment_n(const Index* indices, std::size_t n) {
+    buffer_.visit(incrementor(), buffer_, indices, indices + n);
+  }
+
+  /// implementation detail; resizes storage to n cells, moves cell i to position i + d,
+  /// and calls f with a pointer to the first cell, so that f can move cells further
+  template <class F>
+  void grow(std::size_t n, std::size_t d, F&& f) {
+    buffer_.visit([this, n, d, &f](auto* p) {
+      this->buffer_.grow(p, n, d);
+      f(static_cast<decltype(p)>(this->buffer_.ptr));
+    });
+  }
+
   /// implementation detail; used by unit tests, not part of generic storage interface
   template <class T>
   unlimited_storage(std::size_t s, const T* p, const allocator_type& a = {})
@@ -512,6 +607,8 @@ public:
         using T = std::decay_t<decltype(*tp)>;
         buffer_.template make<T>(size);
       });
+      // cells are loaded below
+      buffer_.bound = buffer_type::unknown_bound;
     } else {
       ar& make_nvp("type", buffer_.type);
       ar& make_nvp("size", buffer_.size);
@@ -532,11 +629,61 @@ private:
         b.template make<U>(b.size, tp);
         ++static_cast<U*>(b.ptr)[i];
       }
+      // a store is cheaper than raising the bound
+      b.bound = buffer_type::unknown_bound;
     }
 
     void operator()(large_int* tp, buffer_type&, std::size_t i) { ++tp[i]; }
 
     void operator()(double* tp, buffer_type&, std::size_t i) { ++tp[i]; }
+
+    // Increment many cells, dispatch on buffer type only once. If the upper bound of
+    // the cell values leaves enough headroom, the overflow check is skipped. Otherwise,
+    // the bound is recomputed from the cells if this scan is cheap compared to the
+    // increments, that is, if the buffer is not larger than the number of increments
+    // or the raises of the bound since the last scan.
+    template <class T, class Index>
+    void operator()(T* tp, buffer_type& b, const Index* it, const Index* end) {
+      const auto n = static_cast<std::size_t>(end - it);
+      if (b.template headroom<T>() < n && 0 < b.size &&
+          (b.size <= n || b.size <= b.drift)) {
+        b.bound = *std::max_element(tp, tp + b.size);
+        b.drift = 0;
+      }
+      if (n <= b.template headroom<T>()) {
+        for (; it != end; ++it)
+          if (detail::is_valid(*it)) ++tp[*it];
+        b.raise_bound(n);
+        return;
+      }
+      for (; it != end; ++it) {
+        if (!detail::is_valid(*it)) continue;
+        assert(*it < b.size);
+        if (!detail::safe_increment(tp[*it])) {
+          using U = detail::next_type<typename buffer_type::types, T>;
+          b.template make<U>(b.size, tp);
+          b.bound = (std::numeric_limits<T>::max)();
+          b.drift = 0;
+          ++static_cast<U*>(b.ptr)[*it];
+          b.raise_bound(1);
+          // continue with wider type
+          return operator()(static_cast<U*>(b.ptr), b, ++it, end);
+        }
+      }
+      b.raise_bound(n);
+    }
+
+    template <class Index>
+    void operator()(large_int* tp, buffer_type&, const Index* it, const Index* end) {
+      for (; it != end; ++it)
+        if (detail::is_valid(*it)) ++tp[*it];
+    }
+
+    template <class Index>
+    void operator()(double* tp, buffer_type&, const Index* it, const Index* end) {
+      for (; it != end; ++it)
+        if (detail::is_valid(*it)) ++tp[*it];
+    }
   };
 
   struct adder {
@@ -588,6 +735,7 @@ private:
 
     template <class T, class U>
     void is_x_unsigned(std::true_type, T* tp, buffer_type& b, std::size_t i, const U& x) {
+      b.bound = buffer_type::unknown_bound;
       if (detail::safe_radd(tp[i], x)) return;
       // x could be reference to buffer we manipulate, need to convert to value
       const auto y = x;
@@ -102,6 +102,23 @@ struct unsafe_access {
     return storage.buffer_;
   }
 
+  /// @copydoc unlimited_storage_buffer()
+  template <class Allocator>
+  static constexpr const auto& unlimited_storage_buffer(
+      const unlimited_storage<Allocator>& storage) {
+    return storage.buffer_;
+  }
+
+  /**
+    Get blocks of unlimited_block_storage.
+    @param storage instance of unlimited_block_storage.
+  */
+  template <class Allocator>
+  static constexpr auto& unlimited_block_storage_blocks(
+      unlimited_block_storage<Allocator>& storage) {
+    return storage.blocks_;
+  }
+
   /**
     Get implementation of storage_adaptor.
     @param storage instance of storage_adaptor.
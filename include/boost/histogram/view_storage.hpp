@@ -0,0 +1,202 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_HISTOGRAM_VIEW_STORAGE_HPP
+#define BOOST_HISTOGRAM_VIEW_STORAGE_HPP
+
+#include <algorithm>
+#include <boost/histogram/axis/traits.hpp>
+#include <boost/histogram/detail/axes.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/detail/iterator_adaptor.hpp>
+#include <boost/histogram/detail/optional_index.hpp>
+#include <boost/histogram/detail/strided_sum.hpp>
+#include <boost/histogram/detail/sub_array.hpp>
+#include <boost/histogram/fwd.hpp>
+#include <boost/throw_exception.hpp>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace boost {
+namespace histogram {
+namespace detail {
+
+// strides of the axes in the storage of a view, zero for axes with only one bin
+template <class Axes>
+std::vector<std::size_t> view_strides(const Axes& axes) {
+  std::vector<std::size_t> strides;
+  strides.reserve(axes_rank(axes));
+  std::size_t n = 1;
+  for_each_axis(axes, [&](const auto& a) {
+    const auto e = static_cast<std::size_t>(axis::traits::extent(a));
+    strides.push_back(e > 1 ? n : 0);
+    n *= e;
+  });
+  return strides;
+}
+
+} // namespace detail
+
+/**
+  Read-only storage which computes its cells on access from the cells of another storage.
+
+  A histogram with this storage is a lazy view of a slice, reduction, or projection of
+  another histogram, created with algorithm::reduce_view() or algorithm::project_view().
+  It has the usual histogram interface for reading: axis(), at(), operator[], indexed(),
+  algorithm::sum(), and so on. Creating a view costs time and memory proportional to the
+  number of bins of the axes, not to the number of cells. Each access to a cell of the
+  view adds up the corresponding cells of the original storage, which is a single cell
+  for slices and pure index ranges. algorithm::materialize() turns a view into a normal
+  histogram.
+
+  The view refers to the storage of the original histogram, which must outlive the
+  view. Changes to the original histogram are visible through the view, unless its axes
+  grow, which invalidates the view. Cells cannot be written through the view.
+
+  @tparam Storage storage of the original histogram.
+*/
+template <class Storage>
+class view_storage {
+public:
+  static constexpr bool has_threading_support = false;
+
+  using storage_type = Storage;
+  using value_type = typename storage_type::value_type;
+  using reference = value_type;
+  using const_reference = value_type;
+
+  class const_iterator
+      : public detail::iterator_adaptor<const_iterator, std::size_t, value_type> {
+  public:
+    const_iterator() = default;
+    const_iterator(const view_storage* s, std::size_t i) noexcept
+        : const_iterator::iterator_adaptor_(i), storage_(s) {}
+
+    value_type operator*() const { return (*storage_)[this->base()]; }
+
+  private:
+    const view_storage* storage_ = nullptr;
+  };
+
+  using iterator = const_iterator;
+
+  view_storage() = default;
+
+  /** Construct view, an implementation detail of the algorithms which create views.
+
+    @param s original storage.
+    @param offsets offsets in the view of the cells along each axis of the original
+    storage, or invalid_index for cells which are not in the view.
+    @param strides stride in the view of each axis of the original storage, or zero for
+    axes which are summed over or have only one bin in the view.
+    @param n number of cells of the view.
+  */
+  view_storage(const storage_type& s, detail::cell_offsets offsets,
+               const std::vector<std::size_t>& strides, std::size_t n)
+      : storage_(&s), offsets_(std::move(offsets)), size_(n) {
+    const auto rank = offsets_.size();
+    assert(strides.size() == rank);
+    axes_.resize(rank);
+    std::size_t source_stride = 1;
+    for (std::size_t k = 0; k < rank; ++k) {
+      auto& a = axes_[k];
+      a.source_stride = source_stride;
+      source_stride *= offsets_[k].size();
+      a.stride = strides[k];
+      // next larger stride bounds the index along this axis
+      a.modulus = n;
+      for (auto s2 : strides)
+        if (s2 > a.stride && s2 < a.modulus) a.modulus = s2;
+      for (std::size_t j = 0; j < offsets_[k].size(); ++j) {
+        const auto o = offsets_[k][j];
+        if (o == detail::invalid_index) continue;
+        const auto i = a.stride ? o / a.stride : 0;
+        if (i >= a.cells.size()) a.cells.resize(i + 1);
+        a.cells[i].push_back(j);
+      }
+    }
+    assert(source_stride == s.size());
+  }
+
+  /// The storage cannot be reset, this only accepts the number of cells of the view once.
+  void reset(std::size_t n) {
+    if (bound_ || n != size_)
+      BOOST_THROW_EXCEPTION(std::logic_error("view_storage cannot be reset"));
+    bound_ = true;
+  }
+
+  /// Return number of cells.
+  std::size_t size() const noexcept { return size_; }
+
+  /// Return the original storage.
+  const storage_type& storage() const noexcept { return *storage_; }
+
+  /// implementation detail; returns offsets in the view of the original cells
+  const detail::cell_offsets& offsets() const noexcept { return offsets_; }
+
+  /// Return the sum of the original cells which correspond to cell i of the view.
+  value_type operator[](std::size_t i) const {
+    assert(i < size_);
+    constexpr std::size_t limit = BOOST_HISTOGRAM_DETAIL_AXES_LIMIT;
+    const auto rank = axes_.size();
+    detail::sub_array<const std::vector<std::size_t>*, limit> cells(rank);
+    for (std::size_t k = 0; k < rank; ++k) {
+      const auto& a = axes_[k];
+      const auto j = a.stride ? i % a.modulus / a.stride : 0;
+      if (j >= a.cells.size() || a.cells[j].empty()) return value_type{};
+      cells[k] = &a.cells[j];
+    }
+    // iterate over all combinations of original cells along the axes
+    detail::sub_array<std::size_t, limit> idx(rank, 0);
+    value_type result{};
+    for (;;) {
+      std::size_t n = 0;
+      for (std::size_t k = 0; k < rank; ++k)
+        n += (*cells[k])[idx[k]] * axes_[k].source_stride;
+      result += (*storage_)[n];
+      std::size_t k = 0;
+      while (k < rank && ++idx[k] == cells[k]->size()) idx[k++] = 0;
+      if (k == rank) break;
+    }
+    return result;
+  }
+
+  template <class Iterable, class = detail::requires_iterable<Iterable>>
+  bool operator==(const Iterable& iterable) const {
+    using std::begin;
+    using std::end;
+    if (size_ != static_cast<std::size_t>(std::distance(begin(iterable), end(iterable))))
+      return false;
+    return std::equal(this->begin(), this->end(), begin(iterable));
+  }
+
+  const_iterator begin() const noexcept { return {this, 0}; }
+  const_iterator end() const noexcept { return {this, size_}; }
+
+private:
+  struct axis_map {
+    std::size_t source_stride;
+    std::size_t stride;
+    std::size_t modulus;
+    // original cells along this axis for each index of the view
+    std::vector<std::vector<std::size_t>> cells;
+  };
+
+  const storage_type* storage_ = nullptr;
+  detail::cell_offsets offsets_;
+  std::vector<axis_map> axes_;
+  std::size_t size_ = 0;
+  bool bound_ = false;
+};
+
+} // namespace histogram
+} // namespace boost
+
+#endif
@@ -0,0 +1,129 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/core/lightweight_test.hpp>
+#include <boost/core/lightweight_test_trait.hpp>
+#include <boost/histogram/accumulators/is_thread_safe.hpp>
+#include <boost/histogram/accumulators/mean.hpp>
+#include <boost/histogram/accumulators/ostream.hpp>
+#include <boost/histogram/accumulators/weighted_mean.hpp>
+#include <boost/histogram/weight.hpp>
+#include <sstream>
+#include <thread>
+#include "is_close.hpp"
+#include "throw_exception.hpp"
+#include "utility_str.hpp"
+
+using namespace boost::histogram;
+using namespace std::literals;
+
+constexpr int N = 10000;
+
+// each thread calls f with the numbers 0 to N - 1
+template <class F>
+void parallel(F f) {
+  auto g = [&]() {
+    for (int i = 0; i < N; ++i) f(i);
+  };
+
+  std::thread a(g), b(g), c(g), d(g);
+  a.join();
+  b.join();
+  c.join();
+  d.join();
+}
+
+int main() {
+  using m_t = accumulators::mean<double>;
+  using ts_m_t = accumulators::mean<double, true>;
+  using wm_t = accumulators::weighted_mean<double>;
+  using ts_wm_t = accumulators::weighted_mean<double, true>;
+
+  BOOST_TEST_TRAIT_FALSE((accumulators::is_thread_safe<m_t>));
+  BOOST_TEST_TRAIT_TRUE((accumulators::is_thread_safe<ts_m_t>));
+  BOOST_TEST_TRAIT_FALSE((accumulators::is_thread_safe<wm_t>));
+  BOOST_TEST_TRAIT_TRUE((accumulators::is_thread_safe<ts_wm_t>));
+  // lock takes no space if thread-safety is not requested
+  BOOST_TEST_EQ(sizeof(m_t), 3 * sizeof(double));
+  BOOST_TEST_EQ(sizeof(wm_t), 4 * sizeof(double));
+
+  // same interface as non-thread-safe version
+  {
+    ts_m_t a;
+    a(4);
+    a(7);
+    a(13);
+    a(16);
+    BOOST_TEST_EQ(str(a), "mean(4, 10, 30)"s);
+    ts_m_t b = a;
+    BOOST_TEST_EQ(b, a);
+    m_t c = a;
+    BOOST_TEST_EQ(c, m_t(4, 10, 30));
+    b += ts_m_t(c);
+    BOOST_TEST_EQ(b.count(), 8);
+
+    ts_wm_t d;
+    d(weight(2), 4);
+    d(weight(2), 16);
+    BOOST_TEST_EQ(str(d), "weighted_mean(4, 10, 72)"s);
+    wm_t e = d;
+    BOOST_TEST_EQ(e.value(), 10);
+  }
+
+  // concurrent insertion of samples
+  {
+    ts_m_t a;
+    m_t b;
+    parallel([&](int i) { a(i); });
+    for (int k = 0; k < 4; ++k)
+      for (int i = 0; i < N; ++i) b(i);
+    BOOST_TEST_EQ(a.count(), 4 * N);
+    BOOST_TEST_IS_CLOSE(a.value(), b.value(), 1e-9);
+    BOOST_TEST_IS_CLOSE(a.variance() / b.variance(), 1, 1e-9);
+  }
+
+  // concurrent insertion of weighted samples
+  {
+    ts_m_t a;
+    m_t b;
+    ts_wm_t c;
+    wm_t d;
+    parallel([&](int i) {
+      a(weight(0.5), i);
+      c(weight(0.5), i);
+    });
+    for (int k = 0; k < 4; ++k)
+      for (int i = 0; i < N; ++i) {
+        b(weight(0.5), i);
+        d(weight(0.5), i);
+      }
+    BOOST_TEST_EQ(a.count(), 2 * N);
+    BOOST_TEST_IS_CLOSE(a.value(), b.value(), 1e-9);
+    BOOST_TEST_IS_CLOSE(a.variance() / b.variance(), 1, 1e-9);
+    BOOST_TEST_EQ(c.sum_of_weights(), 2 * N);
+    BOOST_TEST_EQ(c.sum_of_weights_squared(), N);
+    BOOST_TEST_IS_CLOSE(c.value(), d.value(), 1e-9);
+    BOOST_TEST_IS_CLOSE(c.variance() / d.variance(), 1, 1e-9);
+  }
+
+  // concurrent adds
+  {
+    ts_m_t a;
+    const m_t b(2, 3, 4);
+    parallel([&](int) { a += b; });
+    BOOST_TEST_EQ(a.count(), 8 * N);
+    BOOST_TEST_IS_CLOSE(a.value(), 3, 1e-9);
+
+    ts_wm_t c;
+    const wm_t d(2, 3, 4, 5);
+    parallel([&](int) { c += d; });
+    BOOST_TEST_EQ(c.sum_of_weights(), 8 * N);
+    BOOST_TEST_EQ(c.sum_of_weights_squared(), 12 * N);
+    BOOST_TEST_IS_CLOSE(c.value(), 4, 1e-9);
+  }
+
+  return boost::report_errors();
+}
@@ -0,0 +1,83 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/core/lightweight_test.hpp>
+#include <boost/core/lightweight_test_trait.hpp>
+#include <boost/histogram/accumulators/is_thread_safe.hpp>
+#include <boost/histogram/accumulators/ostream.hpp>
+#include <boost/histogram/accumulators/weighted_sum.hpp>
+#include <boost/histogram/weight.hpp>
+#include <sstream>
+#include <thread>
+#include "throw_exception.hpp"
+#include "utility_str.hpp"
+
+using namespace boost::histogram;
+using namespace std::literals;
+
+constexpr int N = 10000;
+
+template <class F>
+void parallel(F f) {
+  auto g = [&]() {
+    for (int i = 0; i < N; ++i) f();
+  };
+
+  std::thread a(g), b(g), c(g), d(g);
+  a.join();
+  b.join();
+  c.join();
+  d.join();
+}
+
+int main() {
+  using w_t = accumulators::weighted_sum<double>;
+  using ts_t = accumulators::weighted_sum<double, true>;
+
+  BOOST_TEST_TRAIT_FALSE((accumulators::is_thread_safe<w_t>));
+  BOOST_TEST_TRAIT_TRUE((accumulators::is_thread_safe<ts_t>));
+  // lock takes no space if thread-safety is not requested
+  BOOST_TEST_EQ(sizeof(w_t), 2 * sizeof(double));
+
+  // same interface as non-thread-safe version
+  {
+    ts_t w;
+    BOOST_TEST_EQ(str(w), "weighted_sum(0, 0)"s);
+    w += weight(2);
+    ++w;
+    BOOST_TEST_EQ(w, ts_t(3, 5));
+    ts_t u = w;
+    BOOST_TEST_EQ(u, w);
+    w_t v = w;
+    BOOST_TEST_EQ(v, w_t(3, 5));
+    ts_t x = v;
+    BOOST_TEST_EQ(x, w);
+  }
+
+  // operator++
+  {
+    ts_t w;
+    parallel([&]() { ++w; });
+    BOOST_TEST_EQ(w, ts_t(4 * N, 4 * N));
+  }
+
+  // operator+= with weight
+  {
+    ts_t w;
+    parallel([&]() { w += weight(2); });
+    BOOST_TEST_EQ(w, ts_t(8 * N, 16 * N));
+  }
+
+  // operator+= with another weighted_sum
+  {
+    ts_t w;
+    const ts_t u(1, 2);
+    parallel([&]() { w += u; });
+    BOOST_TEST_EQ(w, ts_t(4 * N, 8 * N));
+  }
+
+  return boost::report_errors();
+}
@@ -5,12 +5,22 @@
 // or copy at http://www.boost.org/LICENSE_1_0.txt)
 
 #include <boost/core/lightweight_test.hpp>
+#include <boost/histogram/accumulators/mean.hpp>
+#include <boost/histogram/accumulators/weighted_sum.hpp>
 #include <boost/histogram/algorithm/project.hpp>
 #include <boost/histogram/algorithm/sum.hpp>
+#include <boost/histogram/axis/category.hpp>
 #include <boost/histogram/axis/integer.hpp>
 #include <boost/histogram/axis/ostream.hpp>
+#include <boost/histogram/indexed.hpp>
 #include <boost/histogram/literals.hpp>
+#include <boost/histogram/make_histogram.hpp>
 #include <boost/histogram/ostream.hpp>
+#include <boost/histogram/storage_adaptor.hpp>
+#include <boost/histogram/unlimited_storage.hpp>
+#include <cstdint>
+#include <limits>
+#include <random>
 #include <vector>
 #include "throw_exception.hpp"
 #include "utility_histogram.hpp"
@@ -19,6 +29,37 @@ using namespace boost::histogram;
 using namespace boost::histogram::literals; // to get _c suffix
 using namespace boost::histogram::algorithm;
 
+// projection computed cell by cell
+template <class H>
+auto project_naive(const H& h, const std::vector<unsigned>& kept) {
+  auto r = project(h, kept);
+  r.reset();
+  std::vector<int> idx(kept.size());
+  for (auto&& x : indexed(h, coverage::all)) {
+    for (unsigned i = 0; i < kept.size(); ++i) idx[i] = x.index(kept[i]);
+    r.at(idx) += *x;
+  }
+  return r;
+}
+
+template <class Tag, class Storage>
+void compare_with_naive(Storage s) {
+  using none = axis::integer<int, axis::null_type, axis::option::none_t>;
+  auto h = make_s(Tag(), s, axis::integer<>(0, 5), none(0, 3), axis::integer<>(0, 4),
+                  none(0, 2));
+  std::mt19937 gen(1);
+  std::uniform_int_distribution<> x(-1, 5);
+  for (int i = 0; i < 500; ++i) h(x(gen), x(gen), x(gen), x(gen));
+
+  for (auto&& kept : std::vector<std::vector<unsigned>>{
+           {0}, {1}, {3}, {0, 1}, {1, 0}, {0, 2}, {2, 0}, {1, 3}, {3, 1, 2}, {0, 1, 2, 3},
+           {3, 2, 1, 0}}) {
+    const auto r = project(h, kept);
+    BOOST_TEST(r == project_naive(h, kept));
+  }
+  BOOST_TEST(project(h, 3_c, 1_c) == project_naive(h, {3, 1}));
+}
+
 template <typename Tag>
 void run_tests() {
   {
@@ -189,5 +230,60 @@ int main() {
   run_tests<static_tag>();
   run_tests<dynamic_tag>();
 
+  compare_with_naive<static_tag>(dense_storage<double>());
+  compare_with_naive<dynamic_tag>(dense_storage<int>());
+  compare_with_naive<static_tag>(weight_storage());
+  compare_with_naive<static_tag>(unlimited_storage<>());
+  compare_with_naive<dynamic_tag>(unlimited_storage<>());
+
+  // unlimited_storage: sums do not overflow and use the smallest type that fits
+  {
+    auto h = make(static_tag(), axis::integer<>(0, 2), axis::integer<>(0, 2));
+    const auto u8 = std::numeric_limits<std::uint8_t>::max();
+    h.at(0, 0) = u8;
+    h.at(0, 1) = u8;
+    auto p = project(h, 0_c);
+    BOOST_TEST_EQ(p.at(0), 2 * u8);
+    BOOST_TEST_EQ(unsafe_access::unlimited_storage_buffer(unsafe_access::storage(p)).type,
+                  1);
+
+    const auto u64 = std::numeric_limits<std::uint64_t>::max();
+    h.at(0, 0) = u64;
+    h.at(0, 1) = u64;
+    p = project(h, 0_c);
+    BOOST_TEST_EQ(unsafe_access::unlimited_storage_buffer(unsafe_access::storage(p)).type,
+                  4);
+    BOOST_TEST_EQ(p.at(0), 2.0 * u64);
+
+    h.at(1, 1) = 0.5;
+    p = project(h, 0_c);
+    BOOST_TEST_EQ(p.at(1), 0.5);
+  }
+
+  // axis without cells in the middle, source and result have no cells
+  {
+    using cat = axis::category<int, axis::null_type, axis::option::none_t>;
+    auto h = make_histogram(axis::regular<>(2, 0, 1), cat{}, axis::regular<>(2, 0, 1));
+    BOOST_TEST_EQ(h.size(), 0);
+    const auto p = project(h, 0_c, 2_c);
+    BOOST_TEST_EQ(p.size(), 16);
+    BOOST_TEST_EQ(sum(p), 0);
+    BOOST_TEST_EQ(sum(project(threads(2), h, 0_c, 2_c)), 0);
+    BOOST_TEST_EQ(project(h, 1_c).size(), 0);
+  }
+
+  // accumulators
+  {
+    auto h = make_s(static_tag(), profile_storage(), axis::integer<>(0, 2),
+                    axis::integer<>(0, 2));
+    h(0, 0, sample(1));
+    h(0, 1, sample(3));
+    h(1, 1, sample(5));
+    auto p = project(h, 0_c);
+    BOOST_TEST_EQ(p.at(0).count(), 2);
+    BOOST_TEST_EQ(p.at(0).value(), 2);
+    BOOST_TEST_EQ(p.at(1).value(), 5);
+  }
+
   return boost::report_errors();
 }
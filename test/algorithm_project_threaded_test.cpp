@@ -0,0 +1,48 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/core/lightweight_test.hpp>
+#include <boost/histogram/algorithm/project.hpp>
+#include <boost/histogram/algorithm/sum.hpp>
+#include <boost/histogram/axis/integer.hpp>
+#include <boost/histogram/axis/ostream.hpp>
+#include <boost/histogram/literals.hpp>
+#include <boost/histogram/ostream.hpp>
+#include <vector>
+#include "throw_exception.hpp"
+#include "utility_histogram.hpp"
+
+using namespace boost::histogram;
+using namespace boost::histogram::literals; // to get _c suffix
+using namespace boost::histogram::algorithm;
+
+template <class Tag, class Storage>
+void run_tests(Tag tag, Storage s) {
+  using none = axis::integer<int, axis::null_type, axis::option::none_t>;
+  const auto h = make_filled(tag, s, -1, 11, axis::integer<>(0, 7), none(0, 5),
+                             axis::integer<>(0, 11));
+
+  for (unsigned n : {2, 3, 4, 20}) {
+    // last axis is kept, threads write to different cells
+    BOOST_TEST(project(threads(n), h, 2_c) == project(h, 2_c));
+    BOOST_TEST(project(threads(n), h, 0_c, 2_c) == project(h, 0_c, 2_c));
+    BOOST_TEST(project(threads(n), h, 2_c, 0_c) == project(h, 2_c, 0_c));
+    // last axis is summed, threads use separate buffers
+    BOOST_TEST(project(threads(n), h, 0_c) == project(h, 0_c));
+    BOOST_TEST(project(threads(n), h, 1_c, 0_c) == project(h, 1_c, 0_c));
+
+    const std::vector<unsigned> kept = {1};
+    const auto p = project(threads(n), h, kept);
+    BOOST_TEST(p == project(h, kept));
+    BOOST_TEST_EQ(sum(p), sum(h));
+  }
+}
+
+int main() {
+  for_each_test_storage([](auto tag, auto s) { run_tests(tag, s); });
+
+  return boost::report_errors();
+}
@@ -12,8 +12,12 @@
 #include <boost/histogram/axis/ostream.hpp>
 #include <boost/histogram/axis/regular.hpp>
 #include <boost/histogram/axis/variable.hpp>
+#include <boost/histogram/indexed.hpp>
 #include <boost/histogram/ostream.hpp>
+#include <boost/histogram/storage_adaptor.hpp>
+#include <boost/histogram/unlimited_storage.hpp>
 #include <boost/histogram/unsafe_access.hpp>
+#include <random>
 #include <vector>
 #include "throw_exception.hpp"
 #include "utility_histogram.hpp"
@@ -30,6 +34,49 @@ struct unreducible {
   }
 };
 
+// reference implementation: each cell is added to the bin which contains its center
+template <class H>
+H reduce_naive(const H& h, const H& r, const std::vector<bool>& cropped) {
+  auto res = r;
+  res.reset();
+  std::vector<axis::index_type> idx(h.rank());
+  for (auto&& x : indexed(h, coverage::all)) {
+    bool skip = false;
+    for (unsigned k = 0; k < h.rank(); ++k) {
+      const auto& a = res.axis(k);
+      const auto opt = axis::traits::options(a);
+      idx[k] = a.index(h.axis(k).value(x.index(k) + 0.5));
+      if (idx[k] < 0) skip |= cropped[k] || !(opt & axis::option::underflow);
+      if (idx[k] >= a.size()) skip |= cropped[k] || !(opt & axis::option::overflow);
+    }
+    if (!skip) res.at(idx) += *x;
+  }
+  return res;
+}
+
+template <class Storage>
+void compare_with_naive(Storage s) {
+  using R = axis::regular<>;
+  using RN = axis::regular<double, use_default, use_default, axis::option::none_t>;
+  using RO = axis::regular<double, use_default, use_default, axis::option::overflow_t>;
+  auto h = make_s(dynamic_tag(), s, R(6, 0, 6), RN(5, 0, 5), RO(4, 0, 4));
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<> x(-1, 7);
+  for (int i = 0; i < 500; ++i) h(x(gen), x(gen), x(gen));
+
+  const auto test = [&h](std::vector<reduce_command> opts, std::vector<bool> cropped) {
+    const auto r = reduce(h, opts);
+    BOOST_TEST(r == reduce_naive(h, r, cropped));
+  };
+  test({rebin(0, 2)}, {false, false, false});
+  test({rebin(0, 3), shrink(1, 1, 4)}, {false, false, false});
+  test({slice(0, 1, 5), rebin(2, 2)}, {false, false, false});
+  test({rebin(1, 5), slice(2, 1, 3)}, {false, false, false});
+  test({crop(1, 1, 3)}, {false, true, false});
+  test({shrink_and_rebin(0, 1, 5, 2), crop(2, 1, 3)}, {false, false, true});
+  test({crop(0, 2, 4), crop(1, 1, 4), crop(2, 0, 2)}, {true, true, true});
+}
+
 template <typename Tag>
 void run_tests() {
   // limitations: shrink does not work with arguments not convertible to double
@@ -423,5 +470,10 @@ int main() {
   run_tests<static_tag>();
   run_tests<dynamic_tag>();
 
+  compare_with_naive(dense_storage<int>());
+  compare_with_naive(dense_storage<double>());
+  compare_with_naive(weight_storage());
+  compare_with_naive(unlimited_storage<>());
+
   return boost::report_errors();
 }
@@ -0,0 +1,51 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/core/lightweight_test.hpp>
+#include <boost/histogram/algorithm/reduce.hpp>
+#include <boost/histogram/algorithm/sum.hpp>
+#include <boost/histogram/axis/category.hpp>
+#include <boost/histogram/axis/integer.hpp>
+#include <boost/histogram/axis/ostream.hpp>
+#include <boost/histogram/axis/regular.hpp>
+#include <boost/histogram/ostream.hpp>
+#include <vector>
+#include "throw_exception.hpp"
+#include "utility_histogram.hpp"
+
+using namespace boost::histogram;
+using namespace boost::histogram::algorithm;
+
+template <class Tag, class Storage>
+void run_tests(Tag tag, Storage s) {
+  using none = axis::integer<int, axis::null_type, axis::option::none_t>;
+  using cat = axis::category<int, axis::null_type>;
+  const auto h = make_filled(tag, s, -1, 8, axis::regular<>(8, 0, 8), none(0, 5),
+                             cat{0, 1, 2, 3, 4, 5});
+
+  for (unsigned n : {2, 3, 4, 20}) {
+    // last axis is kept or merged in order, threads write to different cells
+    BOOST_TEST(reduce(threads(n), h, rebin(0, 2)) == reduce(h, rebin(0, 2)));
+    BOOST_TEST(reduce(threads(n), h, shrink(0, 2, 6), slice(1, 1, 3)) ==
+               reduce(h, shrink(0, 2, 6), slice(1, 1, 3)));
+    // removed bins of the category axis go to the overflow bin, which is out of order;
+    // threads use separate buffers
+    BOOST_TEST(reduce(threads(n), h, slice(2, 2, 4)) == reduce(h, slice(2, 2, 4)));
+    BOOST_TEST(reduce(threads(n), h, crop(0, 1, 7), slice(2, 1, 5)) ==
+               reduce(h, crop(0, 1, 7), slice(2, 1, 5)));
+
+    const std::vector<reduce_command> opts = {rebin(0, 4), slice(2, 3, 6)};
+    const auto r = reduce(threads(n), h, opts);
+    BOOST_TEST(r == reduce(h, opts));
+    BOOST_TEST_EQ(sum(r), sum(h));
+  }
+}
+
+int main() {
+  for_each_test_storage([](auto tag, auto s) { run_tests(tag, s); });
+
+  return boost::report_errors();
+}
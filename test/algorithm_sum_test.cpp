@@ -9,6 +9,10 @@
 #include <boost/histogram/accumulators/weighted_sum.hpp>
 #include <boost/histogram/algorithm/sum.hpp>
 #include <boost/histogram/axis/integer.hpp>
+#include <boost/histogram/axis/regular.hpp>
+#include <boost/histogram/unlimited_storage.hpp>
+#include <cstdint>
+#include <limits>
 #include <unordered_map>
 #include <vector>
 #include "throw_exception.hpp"
@@ -26,6 +30,8 @@ void run_tests() {
     std::fill(h.begin(), h.end(), 1);
     BOOST_TEST_EQ(sum(h), 12);
     BOOST_TEST_EQ(sum(h, coverage::inner), 10);
+    BOOST_TEST_EQ(sum(threads(1), h), 12);
+    BOOST_TEST_EQ(sum(threads(1), h, coverage::inner), 10);
   }
 
   {
@@ -33,6 +39,8 @@ void run_tests() {
     std::fill(h.begin(), h.end(), 1);
     BOOST_TEST_EQ(sum(h), 12);
     BOOST_TEST_EQ(sum(h, coverage::inner), 10);
+    BOOST_TEST_EQ(sum(threads(1), h), 12);
+    BOOST_TEST_EQ(sum(threads(1), h, coverage::inner), 10);
   }
 
   {
@@ -40,6 +48,8 @@ void run_tests() {
     std::fill(h.begin(), h.end(), 1);
     BOOST_TEST_EQ(sum(h), 12);
     BOOST_TEST_EQ(sum(h, coverage::inner), 10);
+    BOOST_TEST_EQ(sum(threads(1), h), 12);
+    BOOST_TEST_EQ(sum(threads(1), h, coverage::inner), 10);
   }
 
   {
@@ -47,6 +57,8 @@ void run_tests() {
     std::fill(h.begin(), h.end(), 1);
     BOOST_TEST_EQ(sum(h), 12 * 12);
     BOOST_TEST_EQ(sum(h, coverage::inner), 10 * 10);
+    BOOST_TEST_EQ(sum(threads(1), h), 12 * 12);
+    BOOST_TEST_EQ(sum(threads(1), h, coverage::inner), 10 * 10);
   }
 
   {
@@ -68,6 +80,9 @@ void run_tests() {
     const auto v2 = algorithm::sum(h, coverage::inner);
     BOOST_TEST_EQ(v2.value(), 1 + 2 + 5 + 6);
     BOOST_TEST_EQ(v2.variance(), 4 * 2);
+
+    BOOST_TEST(algorithm::sum(threads(1), h) == v1);
+    BOOST_TEST(algorithm::sum(threads(1), h, coverage::inner) == v2);
   }
 }
 
@@ -75,5 +90,43 @@ int main() {
   run_tests<static_tag>();
   run_tests<dynamic_tag>();
 
+  // fast algorithm keeps the accuracy of accumulators::sum
+  {
+    using none = axis::integer<int, axis::null_type, axis::option::none_t>;
+    auto h = make_s(static_tag(), std::vector<double>(), none(0, 1003));
+    const double x[] = {1e100, 1.0, -1e100, 1.0};
+    unsigned k = 0;
+    for (auto&& c : h) c = x[k++ % 4];
+    h[1002] = -1e100;
+    BOOST_TEST_EQ(sum(h), 501);
+    BOOST_TEST_EQ(sum(threads(1), h), 501);
+  }
+
+  // inner cells of axes with and without flow bins
+  {
+    using none = axis::integer<int, axis::null_type, axis::option::none_t>;
+    using under = axis::integer<int, axis::null_type, axis::option::underflow_t>;
+    auto h = make_s(dynamic_tag(), std::vector<int>(), under(0, 3), axis::integer<>(0, 2),
+                    none(0, 2));
+    int i = 0;
+    for (auto&& c : h) c = ++i;
+    BOOST_TEST_EQ(sum(threads(1), h), sum(h));
+    BOOST_TEST_EQ(sum(threads(1), h, coverage::inner), sum(h, coverage::inner));
+  }
+
+  // unlimited_storage: cells of each integer type and of type double
+  {
+    auto h = make(static_tag(), axis::integer<>(0, 10));
+    for (auto&& c : h) ++c;
+    BOOST_TEST_EQ(sum(threads(1), h), 12);
+    h[3] = std::numeric_limits<std::uint64_t>::max();
+    BOOST_TEST_EQ(sum(threads(1), h), sum(h));
+    h[3] *= 4;
+    BOOST_TEST_EQ(sum(threads(1), h), sum(h));
+    h[3] = 0.5;
+    BOOST_TEST_EQ(sum(threads(1), h), 11.5);
+    BOOST_TEST_EQ(sum(threads(1), h, coverage::inner), 9.5);
+  }
+
   return boost::report_errors();
 }
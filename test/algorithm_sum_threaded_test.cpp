@@ -0,0 +1,42 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/core/lightweight_test.hpp>
+#include <boost/histogram/algorithm/sum.hpp>
+#include <boost/histogram/axis/integer.hpp>
+#include <boost/histogram/storage_adaptor.hpp>
+#include "throw_exception.hpp"
+#include "utility_histogram.hpp"
+
+using namespace boost::histogram;
+using boost::histogram::algorithm::sum;
+
+template <class Tag, class Storage>
+void run_tests(Tag tag, Storage s) {
+  using none = axis::integer<int, axis::null_type, axis::option::none_t>;
+  const auto h = make_filled(tag, s, -1, 11, axis::integer<>(0, 7), none(0, 5),
+                             axis::integer<>(0, 11));
+
+  for (unsigned n : {2, 3, 4, 20, 2000}) {
+    BOOST_TEST(sum(threads(n), h) == sum(h));
+    BOOST_TEST(sum(threads(n), h, coverage::inner) == sum(h, coverage::inner));
+  }
+}
+
+int main() {
+  for_each_test_storage([](auto tag, auto s) { run_tests(tag, s); });
+
+  // results of the threads are combined accurately
+  {
+    auto h = make_s(static_tag(), dense_storage<double>(), axis::integer<>(0, 98));
+    h[-1] = 1e100;
+    for (int i = 0; i < 98; ++i) h[i] = 1;
+    h[98] = -1e100;
+    for (unsigned n : {1, 2, 3, 4}) BOOST_TEST_EQ(sum(threads(n), h), 98);
+  }
+
+  return boost::report_errors();
+}
@@ -9,10 +9,12 @@
 #include <boost/histogram/axis/category.hpp>
 #include <boost/histogram/axis/ostream.hpp>
 #include <boost/histogram/axis/traits.hpp>
+#include <algorithm>
 #include <limits>
 #include <sstream>
 #include <string>
 #include <type_traits>
+#include <vector>
 #include "std_ostream.hpp"
 #include "throw_exception.hpp"
 #include "utility_axis.hpp"
@@ -148,6 +150,54 @@ int main() {
     BOOST_TEST_EQ(str(a), "category(5, 1, 10, options=growth)");
   }
 
+  // many values, index uses hash table
+  {
+    std::vector<int> v;
+    for (int i = 0; i < 1000; ++i) v.push_back(i * 1024 - 5000);
+    v.push_back(v[10]); // duplicate, first occurrence is found
+    auto a = axis::category<int>(v);
+    auto ref = [&v](int x) {
+      return static_cast<axis::index_type>(std::find(v.begin(), v.end(), x) - v.begin());
+    };
+    for (int x = -6000; x < 1030000; x += 7) BOOST_TEST_EQ(a.index(x), ref(x));
+    for (auto&& x : v) BOOST_TEST_EQ(a.index(x), ref(x));
+    BOOST_TEST_EQ(a.index(v[10]), 10);
+
+    // shrink
+    auto b = axis::category<int>(a, 100, 200, 1);
+    BOOST_TEST_EQ(b.size(), 100);
+    for (int i = 0; i < 1000; ++i)
+      BOOST_TEST_EQ(b.index(v[i]), i < 100 || i >= 200 ? 100 : i - 100);
+
+    std::vector<std::string> s;
+    for (int i = 0; i < 500; ++i) s.push_back("s" + std::to_string(i));
+    auto c = axis::category<std::string>(s);
+    for (int i = 0; i < 500; ++i) BOOST_TEST_EQ(c.index(s[i]), i);
+    BOOST_TEST_EQ(c.index("foo"), 500);
+    BOOST_TEST_EQ(c.index("s500"), 500);
+
+    // value type without std::hash
+    struct X {
+      int value;
+      bool operator==(const X& o) const { return value == o.value; }
+    };
+    std::vector<X> u;
+    for (int i = 0; i < 100; ++i) u.push_back(X{i});
+    auto d = axis::category<X, axis::null_type>(u);
+    for (int i = 0; i < 101; ++i) BOOST_TEST_EQ(d.index(X{i}), i);
+  }
+
+  // many values with growth
+  {
+    using pii_t = std::pair<axis::index_type, axis::index_type>;
+    axis::category<int, axis::null_type, axis::option::growth_t> a;
+    for (int i = 0; i < 1000; ++i) {
+      BOOST_TEST_EQ(a.update(i * 3), pii_t(i, -1));
+      BOOST_TEST_EQ(a.update(i * 3), pii_t(i, 0));
+    }
+    for (int i = 0; i < 3000; ++i) BOOST_TEST_EQ(a.index(i), i % 3 ? 1000 : i / 3);
+  }
+
   // iterators
   {
     test_axis_iterator(axis::category<>({3, 1, 2}, ""), 0, 3);
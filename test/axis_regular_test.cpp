@@ -223,6 +223,32 @@ int main() {
     BOOST_TEST_EQ(a.update(-std::numeric_limits<double>::infinity()), pii_t(-1, 0));
   }
 
+  // index_n gives same results as index
+  {
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double x[] = {-inf, -10, -2.1, -2, -1.1, -0.5, 0, 0.9, 1,
+                        1.999, 2, 2.5, 10, 1e300, inf, nan};
+    constexpr std::size_t n = sizeof(x) / sizeof(*x);
+    auto check = [&](const auto& a) {
+      axis::index_type idx[n];
+      a.index_n(x, n, idx);
+      for (std::size_t i = 0; i < n; ++i) BOOST_TEST_EQ(idx[i], a.index(x[i]));
+    };
+    check(axis::regular<>{4, -2, 2});
+    check(axis::regular<>{3, 2, -2});
+    check(axis::regular<double, tr::log>{2, 1, 100});
+    check(axis::regular<double, def, def, axis::option::none_t>{4, -2, 2});
+    check(axis::regular<double, def, def, axis::option::circular_t>{4, -2, 2});
+    check(axis::regular<float>{3, -1, 2});
+
+    const int y[] = {-3, -2, 0, 1, 2};
+    axis::index_type idx[5];
+    axis::regular<> a{4, -2, 2};
+    a.index_n(y, 5, idx);
+    for (std::size_t i = 0; i < 5; ++i) BOOST_TEST_EQ(idx[i], a.index(y[i]));
+  }
+
   // iterators
   {
     test_axis_iterator(axis::regular<>(5, 0, 1), 0, 5);
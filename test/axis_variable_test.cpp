@@ -7,6 +7,8 @@
 #include <boost/core/lightweight_test.hpp>
 #include <boost/histogram/axis/ostream.hpp>
 #include <boost/histogram/axis/variable.hpp>
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <sstream>
 #include <type_traits>
@@ -149,6 +151,42 @@ int main() {
     BOOST_TEST_EQ(a.update(nan), pii_t(a.size(), 0));
   }
 
+  // many edges, index uses guide table
+  {
+    // bin widths vary over several orders of magnitude
+    std::vector<double> edges;
+    for (int i = 0; i <= 1000; ++i) edges.push_back(std::pow(1.01, i) - 1);
+    auto a = axis::variable<>(edges);
+    const std::vector<float> fedges(edges.begin(), edges.end());
+    auto b = axis::variable<float>(fedges);
+    auto c = axis::variable<double, axis::null_type, axis::option::circular_t>(edges);
+    // reference without table
+    auto ref = [&edges](double x) {
+      return static_cast<axis::index_type>(
+          std::upper_bound(edges.begin(), edges.end(), x) - edges.begin() - 1);
+    };
+    std::vector<double> x = {-inf, -1, -1e-300, 0, 1e-300, inf, nan};
+    for (auto&& e : edges) {
+      x.push_back(e);
+      x.push_back(std::nextafter(e, -inf));
+      x.push_back(std::nextafter(e, inf));
+    }
+    for (int i = 0; i < 100000; ++i) x.push_back(std::pow(1.01, i * 1e-2) - 1.0 - 1e-3);
+    for (auto&& xi : x) {
+      BOOST_TEST_EQ(a.index(xi), ref(xi));
+      const auto yi = static_cast<float>(xi);
+      const auto bi = std::upper_bound(fedges.begin(), fedges.end(), yi) - fedges.begin();
+      BOOST_TEST_EQ(b.index(yi), bi - 1);
+      if (std::isfinite(xi) && xi >= 0 && xi < edges.back())
+        BOOST_TEST_EQ(c.index(xi), ref(xi));
+    }
+
+    // shrink and rebin
+    auto d = axis::variable<>(a, 0, 1000, 2);
+    for (auto&& xi : x)
+      BOOST_TEST_EQ(d.index(xi), ref(xi) < 0 ? -1 : std::min(ref(xi), 1000) / 2);
+  }
+
   // iterators
   {
     test_axis_iterator(axis::variable<>{1, 2, 3}, 0, 2);
@@ -66,6 +66,26 @@ int main() {
     BOOST_TEST_TRAIT_TRUE((is_transform<axis::transform::id, double>));
   }
 
+  // is_hashable
+  {
+    struct A {};
+    BOOST_TEST_TRAIT_FALSE((is_hashable<A>));
+    BOOST_TEST_TRAIT_TRUE((is_hashable<int>));
+    BOOST_TEST_TRAIT_TRUE((is_hashable<std::string>));
+  }
+
+  // has_method_index_n
+  {
+    struct A {};
+    using B = axis::regular<>;
+    using C = axis::integer<>;
+    BOOST_TEST_TRAIT_FALSE((has_method_index_n<A, double>));
+    BOOST_TEST_TRAIT_TRUE((has_method_index_n<B, double>));
+    BOOST_TEST_TRAIT_TRUE((has_method_index_n<B, int>));
+    BOOST_TEST_TRAIT_FALSE((has_method_index_n<B, std::string>));
+    BOOST_TEST_TRAIT_FALSE((has_method_index_n<C, double>));
+  }
+
   // is_vector_like
   {
     struct A {};
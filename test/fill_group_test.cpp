@@ -0,0 +1,136 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <array>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/histogram/accumulators/mean.hpp>
+#include <boost/histogram/accumulators/ostream.hpp>
+#include <boost/histogram/accumulators/weighted_mean.hpp>
+#include <boost/histogram/axis/category.hpp>
+#include <boost/histogram/axis/integer.hpp>
+#include <boost/histogram/axis/ostream.hpp>
+#include <boost/histogram/axis/regular.hpp>
+#include <boost/histogram/fill_group.hpp>
+#include <boost/histogram/histogram.hpp>
+#include <boost/histogram/ostream.hpp>
+#include <boost/histogram/storage_adaptor.hpp>
+#include <boost/histogram/unlimited_storage.hpp>
+#include <boost/variant2/variant.hpp>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "throw_exception.hpp"
+#include "utility_histogram.hpp"
+
+using namespace boost::histogram;
+using boost::variant2::variant;
+
+constexpr auto ndata = 1 << 15; // should be larger than index buffer in fill_group
+
+using in = axis::integer<int, axis::null_type>;
+using in0 = axis::integer<int, axis::null_type, axis::option::none_t>;
+using reg = axis::regular<double, axis::transform::id, axis::null_type>;
+using ing = axis::integer<double, axis::null_type, axis::option::growth_t>;
+
+template <class Tag>
+void run_tests(const std::vector<double>& x, const std::vector<double>& y,
+               const std::vector<double>& w) {
+  const std::vector<std::vector<double>> columns = {x, y};
+
+  // histograms sharing axes, with different storages and weights
+  {
+    auto h1 = make(Tag(), reg(10, -2, 2));
+    auto h2 = make_s(Tag(), weight_storage(), reg(10, -2, 2));
+    auto h3 = make_s(Tag(), dense_storage<double>(), reg(10, -2, 2), in0(-1, 2));
+    auto h4 = make_s(Tag(), unlimited_storage<>(), in(-2, 2), reg(10, -2, 2));
+    auto h5 = make(Tag(), reg(5, -2, 2)); // not equal to the axis of h1
+    auto h6 = make_s(Tag(), weight_storage(), reg(10, -2, 2), in0(-1, 2));
+    auto r1 = h1, r2 = h2, r3 = h3, r4 = h4, r5 = h5, r6 = h6;
+
+    fill_group(columns, fill_entry(h1), fill_entry(h2, {0}, weight(w)),
+               fill_entry(h3, {0, 1}, weight(w)), fill_entry(h4, {1, 0}),
+               fill_entry(h5, {1}), fill_entry(h6, {0, 1}));
+
+    r1.fill(x);
+    r2.fill(x, weight(w));
+    r3.fill(columns, weight(w));
+    r4.fill(std::vector<std::vector<double>>{y, x});
+    r5.fill(y);
+    r6.fill(columns);
+    BOOST_TEST_EQ(h1, r1);
+    BOOST_TEST_EQ(h2, r2);
+    BOOST_TEST_EQ(h3, r3);
+    BOOST_TEST_EQ(h4, r4);
+    BOOST_TEST_EQ(h5, r5);
+    BOOST_TEST_EQ(h6, r6);
+  }
+
+  // profiles with samples, and weights and samples
+  {
+    auto h1 = make_s(Tag(), profile_storage(), reg(10, -2, 2));
+    auto h2 = make_s(Tag(), weighted_profile_storage(), reg(10, -2, 2), in(-2, 2));
+    auto r1 = h1, r2 = h2;
+
+    fill_group(columns, fill_entry(h1, {0}, sample(y)),
+               fill_entry(h2, {0, 1}, weight(w), sample(x)));
+
+    r1.fill(x, sample(y));
+    r2.fill(columns, weight(w), sample(x));
+    BOOST_TEST_EQ(h1, r1);
+    BOOST_TEST_EQ(h2, r2);
+  }
+
+  // single values and variants of values and columns are broadcast
+  {
+    auto h1 = make(Tag(), reg(10, -2, 2), in(-2, 2));
+    auto h2 = make_s(Tag(), weight_storage(), in(-2, 2));
+    auto r1 = h1, r2 = h2;
+
+    std::array<variant<double, std::vector<double>>, 2> v = {{x, 1.0}};
+    fill_group(v, fill_entry(h1), fill_entry(h2, {1}, weight(2)));
+
+    r1.fill(v);
+    r2.fill(std::vector<double>(x.size(), 1.0), weight(2));
+    BOOST_TEST_EQ(h1, r1);
+    BOOST_TEST_EQ(h2, r2);
+  }
+}
+
+int main() {
+  std::mt19937 gen(1);
+  std::normal_distribution<> id(0, 2);
+  std::vector<double> x(ndata), y(ndata), w(ndata);
+  for (auto&& xi : x) xi = id(gen);
+  for (auto&& yi : y) yi = id(gen);
+  for (auto&& wi : w) wi = id(gen);
+
+  run_tests<static_tag>(x, y, w);
+  run_tests<dynamic_tag>(x, y, w);
+
+  // bad arguments
+  {
+    auto h = make(static_tag(), in(0, 2), in(0, 2));
+    auto hg = make(static_tag(), ing(0, 2));
+    const std::vector<std::vector<double>> columns = {{1, 2}, {3, 4}};
+    const std::vector<std::vector<double>> bad = {{1, 2}, {3}};
+
+    BOOST_TEST_THROWS(fill_group(columns, fill_entry(h, {0})), std::invalid_argument);
+    BOOST_TEST_THROWS(fill_group(columns, fill_entry(h, {0, 2})), std::invalid_argument);
+    BOOST_TEST_THROWS(fill_group(bad, fill_entry(h)), std::invalid_argument);
+    BOOST_TEST_THROWS(fill_group(columns, fill_entry(hg)), std::invalid_argument);
+    BOOST_TEST_THROWS(fill_group(columns, fill_entry(h), fill_entry(hg)),
+                      std::invalid_argument);
+    BOOST_TEST_THROWS(fill_group(columns, fill_entry(h, {0, 1}, weight(bad[1]))),
+                      std::invalid_argument);
+    BOOST_TEST_THROWS(
+        fill_group(columns, fill_entry(h), fill_entry(h, {0, 1}, weight(bad[1]))),
+        std::invalid_argument);
+    // nothing is filled if an argument is bad
+    BOOST_TEST_EQ(h, make(static_tag(), in(0, 2), in(0, 2)));
+  }
+
+  return boost::report_errors();
+}
@@ -22,6 +22,7 @@
 #include <boost/histogram/ostream.hpp>
 #include <boost/histogram/storage_adaptor.hpp>
 #include <boost/variant2/variant.hpp>
+#include <limits>
 #include <random>
 #include <sstream>
 #include <stdexcept>
@@ -174,6 +175,26 @@ void run_tests(const std::vector<int>& x, const std::vector<int>& y,
     BOOST_TEST_THROWS(h2.fill(bad), std::invalid_argument);
   }
 
+  // 2D simple with non-inclusive axis and storage of arithmetic values
+  {
+    auto h = make_s(Tag(), std::vector<double>(), in{1, 3}, in0{1, 5});
+    auto h2 = h;
+
+    for (int i = 0; i < ndata; ++i) h(x[i], y[i]);
+    const auto xy = {x, y};
+    h2.fill(xy);
+    BOOST_TEST_EQ(h, h2);
+
+    // infinite weights of discarded values have no effect
+    auto w2 = w;
+    for (int i = 0; i < ndata; ++i) {
+      if (y[i] < 1 || y[i] >= 5) w2[i] = std::numeric_limits<double>::infinity();
+      h(x[i], y[i], weight(w2[i]));
+    }
+    h2.fill(xy, weight(w2));
+    BOOST_TEST_EQ(h, h2);
+  }
+
   // 2D variant and weight
   {
     auto h = make(Tag(), in{1, 3}, in0{1, 5});
@@ -252,6 +273,23 @@ void run_tests(const std::vector<int>& x, const std::vector<int>& y,
     BOOST_TEST_EQ(h, h2);
   }
 
+  // 2D growing with descending and ascending values
+  {
+    using rg = axis::regular<double, boost::use_default, axis::null_type,
+                             axis::option::growth_t>;
+    auto h = make(Tag(), rg(2, 0, 1), ing());
+    auto h2 = h;
+    std::vector<double> a, b;
+    for (int i = 0; i < 2000; ++i) {
+      a.push_back(-0.01 * i);
+      b.push_back(i % 2 ? -i / 10 : i / 10);
+    }
+    for (unsigned i = 0; i < a.size(); ++i) h(a[i], b[i]);
+    const auto ab = {a, b};
+    h2.fill(ab);
+    BOOST_TEST_EQ(h, h2);
+  }
+
   // 2D growing with weights A
   {
     auto h = make(Tag(), in(1, 3), ing());
@@ -10,8 +10,11 @@
 #include <boost/histogram/axis/ostream.hpp>
 #include <boost/histogram/histogram.hpp>
 #include <boost/histogram/ostream.hpp>
+#include <boost/variant2/variant.hpp>
+#include <map>
 #include <string>
 #include <utility>
+#include <vector>
 #include "std_ostream.hpp"
 #include "throw_exception.hpp"
 #include "utility_histogram.hpp"
@@ -196,6 +199,35 @@ void run_tests() {
     BOOST_TEST_EQ(h.at(2, 3), 1);
     BOOST_TEST_EQ(algorithm::sum(h), 3);
   }
+
+  // storage growth in place (std::vector, default) gives same result as copying (map)
+  {
+    auto h1 = make_s(Tag(), std::vector<int>(), integer(), category(), integer());
+    auto h2 = make(Tag(), integer(), category(), integer());
+    auto h3 = make_s(Tag(), std::map<std::size_t, int>(), integer(), category(),
+                     integer());
+    const char* cats[] = {"a", "b", "c", "d", "e"};
+    std::vector<double> x, z;
+    std::vector<std::string> y;
+    for (int i = 0; i < 200; ++i) {
+      x.push_back(i % 7 == 0 ? -i / 7 : i / 3);
+      y.push_back(cats[(i / 11) % 5]);
+      z.push_back(i % 5 == 0 ? std::numeric_limits<double>::infinity() : (i % 13) - 6);
+      h1(x.back(), y.back(), z.back());
+      h2(x.back(), y.back(), z.back());
+      h3(x.back(), y.back(), z.back());
+      BOOST_TEST_EQ(h1, h3);
+      BOOST_TEST_EQ(h2, h3);
+    }
+    using V = boost::variant2::variant<std::vector<double>, std::vector<std::string>>;
+    const V args[] = {x, y, z};
+    h1.fill(args);
+    h2.fill(args);
+    h3.fill(args);
+    BOOST_TEST_EQ(h1, h3);
+    BOOST_TEST_EQ(h2, h3);
+    BOOST_TEST_EQ(algorithm::sum(h1), 400);
+  }
 }
 
 int main() {
@@ -6,14 +6,25 @@
 
 #include <boost/core/lightweight_test.hpp>
 #include <boost/histogram/accumulators/count.hpp>
+#include <boost/histogram/accumulators/mean.hpp>
+#include <boost/histogram/accumulators/weighted_mean.hpp>
+#include <boost/histogram/accumulators/weighted_sum.hpp>
 #include <boost/histogram/algorithm/sum.hpp>
+#include <boost/histogram/axis/category.hpp>
 #include <boost/histogram/axis/integer.hpp>
 #include <boost/histogram/axis/ostream.hpp>
+#include <boost/histogram/indexed.hpp>
 #include <boost/histogram/ostream.hpp>
 #include <boost/histogram/storage_adaptor.hpp>
+#include <boost/histogram/tracking_storage.hpp>
+#include <algorithm>
 #include <iostream>
 #include <random>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <vector>
+#include "is_close.hpp"
 #include "throw_exception.hpp"
 #include "utility_histogram.hpp"
 
@@ -50,6 +61,41 @@ void fill_test(const A1& a1, const A2& a2, const X& x, const Y& y) {
   BOOST_TEST_EQ(h1, h2);
 }
 
+template <class Tag, class A1, class A2, class X, class Y>
+void fill_threads_test(const A1& a1, const A2& a2, const X& x, const Y& y) {
+  auto xy = {x, y};
+
+  auto h1 = make(Tag{}, a1, a2);
+  auto h2 = h1;
+  h1.fill(xy);
+  for (unsigned n : {0, 1, 2, 3, 4, 8}) {
+    h2.reset();
+    h2.fill(threads(n), xy);
+    BOOST_TEST_EQ(h1, h2);
+  }
+
+  auto h3 = make_s(Tag{}, dense_storage<double>(), a1, a2);
+  auto h4 = h3;
+  h3.fill(xy, weight(x));
+  h4.fill(threads(3), xy, weight(x));
+  BOOST_TEST_EQ(h3, h4);
+
+  auto h5 = make_s(Tag{}, dense_storage<accumulators::mean<>>(), a1, a2);
+  auto h6 = h5;
+  h5.fill(xy, sample(y));
+  h6.fill(threads(3), xy, sample(y));
+  BOOST_TEST_EQ(h5, h6);
+
+  // weighted_mean needs positive weights, otherwise variance may be NaN
+  std::vector<double> w(y.size());
+  std::transform(y.begin(), y.end(), w.begin(), [](auto yi) { return 1.0 + yi * yi; });
+  auto h7 = make_s(Tag{}, dense_storage<accumulators::weighted_mean<>>(), a1, a2);
+  auto h8 = h7;
+  h7.fill(xy, weight(w), sample(x));
+  h8.fill(threads(3), xy, weight(w), sample(x));
+  BOOST_TEST_EQ(h7, h8);
+}
+
 template <class T>
 void tests() {
   std::mt19937 gen(1);
@@ -64,11 +110,197 @@ void tests() {
   fill_test<T>(ig{0, 1}, i{0, 1}, vi, vj);
   fill_test<T>(i{0, 1}, ig{0, 1}, vi, vj);
   fill_test<T>(ig{0, 1}, ig{0, 1}, vi, vj);
+
+  using in = axis::integer<int, use_default, axis::option::none_t>;
+  fill_threads_test<T>(i{-2, 3}, i{-3, 2}, vi, vj);
+  fill_threads_test<T>(in{-2, 3}, i{-3, 2}, vi, vj);
+  fill_threads_test<T>(in{-2, 3}, in{-3, 2}, vi, vj);
+  fill_threads_test<T>(ig{0, 1}, i{-3, 2}, vi, vj);
+
+  // large histograms, cells are filled in parallel if the storage allows it
+  std::uniform_int_distribution<> id2(-10, 210);
+  std::generate(vi.begin(), vi.end(), [&] { return id2(gen); });
+  std::generate(vj.begin(), vj.end(), [&] { return id2(gen); });
+  fill_threads_test<T>(i{0, 200}, i{0, 200}, vi, vj);
+  fill_threads_test<T>(in{0, 200}, i{0, 200}, vi, vj);
 }
 
 int main() {
   tests<static_tag>();
   tests<dynamic_tag>();
 
+  // growing axis and axis without flow bins, some values are discarded
+  {
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<> id(-5, 5);
+    std::vector<int> x(n_fill), y(n_fill);
+    std::generate(x.begin(), x.end(), [&] { return id(gen); });
+    std::generate(y.begin(), y.end(), [&] { return id(gen); });
+
+    using ig = axis::integer<int, use_default, axis::option::growth_t>;
+    using in = axis::integer<int, use_default, axis::option::none_t>;
+    auto h1 = make_histogram_with(dense_storage<int>(), ig{0, 1}, in{-3, 2});
+    for (unsigned i = 0; i < n_fill; ++i) h1(x[i], y[i]);
+
+    auto h2 = make_histogram_with(dense_storage<accumulators::count<int, true>>(),
+                                  ig{0, 1}, in{-3, 2});
+    auto run = [&h2, &x, &y](int k) {
+      constexpr auto shift = n_fill / 4;
+      for (int i = k * shift; i < (k + 1) * shift; ++i) h2(x[i], y[i]);
+    };
+    std::thread t1([&] { run(0); });
+    std::thread t2([&] { run(1); });
+    std::thread t3([&] { run(2); });
+    std::thread t4([&] { run(3); });
+    t1.join();
+    t2.join();
+    t3.join();
+    t4.join();
+
+    BOOST_TEST_LT(algorithm::sum(h1), n_fill);
+    BOOST_TEST_EQ(h1.axis(0).size(), 11);
+    BOOST_TEST_EQ(h1, h2);
+  }
+
+  // concurrent batch fills of thread-safe storage, counts are summed per cell first
+  {
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<> id(-5, 5);
+    std::vector<int> x(n_fill), y(n_fill);
+    std::generate(x.begin(), x.end(), [&] { return id(gen); });
+    std::generate(y.begin(), y.end(), [&] { return id(gen); });
+    std::vector<double> w(n_fill);
+    std::transform(y.begin(), y.end(), w.begin(), [](auto yi) { return 0.5 * yi; });
+
+    using i = axis::integer<>;
+    using in = axis::integer<int, use_default, axis::option::none_t>;
+    auto h1 = make_histogram_with(dense_storage<int>(), i{-2, 3}, in{-3, 2});
+    auto h3 = make_histogram_with(dense_storage<double>(), i{-2, 3}, in{-3, 2});
+    h1.fill(std::vector<std::vector<int>>{x, y});
+    h3.fill(std::vector<std::vector<int>>{x, y}, weight(w));
+
+    auto h2 = make_histogram_with(dense_storage<accumulators::count<int, true>>(),
+                                  i{-2, 3}, in{-3, 2});
+    auto h4 = make_histogram_with(dense_storage<accumulators::count<double, true>>(),
+                                  i{-2, 3}, in{-3, 2});
+    auto run = [&](int k) {
+      constexpr auto shift = n_fill / 4;
+      const auto b = k * shift, e = (k + 1) * shift;
+      std::vector<std::vector<int>> xy = {{x.begin() + b, x.begin() + e},
+                                          {y.begin() + b, y.begin() + e}};
+      std::vector<double> wk(w.begin() + b, w.begin() + e);
+      h2.fill(xy);
+      h4.fill(xy, weight(wk));
+    };
+    std::thread t1([&] { run(0); });
+    std::thread t2([&] { run(1); });
+    std::thread t3([&] { run(2); });
+    std::thread t4([&] { run(3); });
+    t1.join();
+    t2.join();
+    t3.join();
+    t4.join();
+
+    BOOST_TEST_EQ(h1, h2);
+    BOOST_TEST_EQ(h3, h4);
+  }
+
+  // concurrent fills of weighted histogram and profiles with thread-safe accumulators
+  {
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<> id(-5, 5);
+    std::vector<int> x(n_fill), y(n_fill);
+    std::generate(x.begin(), x.end(), [&] { return id(gen); });
+    std::generate(y.begin(), y.end(), [&] { return id(gen); });
+
+    using ig = axis::integer<int, use_default, axis::option::growth_t>;
+    using ws = accumulators::weighted_sum<>;
+    using ts_ws = accumulators::weighted_sum<double, true>;
+    using m = accumulators::mean<>;
+    using ts_m = accumulators::mean<double, true>;
+    using wm = accumulators::weighted_mean<>;
+    using ts_wm = accumulators::weighted_mean<double, true>;
+    auto h1 = make_histogram_with(dense_storage<ws>(), ig{0, 1});
+    auto h2 = make_histogram_with(dense_storage<ts_ws>(), ig{0, 1});
+    auto p1 = make_histogram_with(dense_storage<m>(), ig{0, 1});
+    auto p2 = make_histogram_with(dense_storage<ts_m>(), ig{0, 1});
+    auto q1 = make_histogram_with(dense_storage<wm>(), ig{0, 1});
+    auto q2 = make_histogram_with(dense_storage<ts_wm>(), ig{0, 1});
+    for (unsigned i = 0; i < n_fill; ++i) {
+      h1(x[i], weight(0.5 * y[i]));
+      p1(x[i], sample(y[i]));
+      q1(x[i], weight(1 + y[i] * y[i]), sample(y[i]));
+    }
+
+    auto run = [&](int k) {
+      constexpr auto shift = n_fill / 4;
+      for (int i = k * shift; i < (k + 1) * shift; ++i) {
+        h2(x[i], weight(0.5 * y[i]));
+        p2(x[i], sample(y[i]));
+        q2(x[i], weight(1 + y[i] * y[i]), sample(y[i]));
+      }
+    };
+    std::thread t1([&] { run(0); });
+    std::thread t2([&] { run(1); });
+    std::thread t3([&] { run(2); });
+    std::thread t4([&] { run(3); });
+    t1.join();
+    t2.join();
+    t3.join();
+    t4.join();
+
+    // sums of these weights are exact, means may differ by round-off
+    BOOST_TEST_EQ(h1, h2);
+    BOOST_TEST_EQ(p1.axis(), p2.axis());
+    BOOST_TEST_EQ(q1.axis(), q2.axis());
+    for (auto&& b : indexed(p1)) {
+      const auto& b2 = p2.at(b.index());
+      BOOST_TEST_EQ(b->count(), b2.count());
+      BOOST_TEST_IS_CLOSE(b->value(), b2.value(), 1e-9);
+    }
+    for (auto&& b : indexed(q1)) {
+      const auto& b2 = q2.at(b.index());
+      BOOST_TEST_EQ(b->sum_of_weights(), b2.sum_of_weights());
+      BOOST_TEST_IS_CLOSE(b->value(), b2.value(), 1e-9);
+    }
+  }
+
+  // cells of large histogram with tracking storage are filled in parallel, all
+  // changed blocks are marked
+  {
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<> id(-10, 40010);
+    std::vector<int> x(n_fill);
+    std::generate(x.begin(), x.end(), [&] { return id(gen); });
+
+    using in = axis::integer<int, use_default, axis::option::none_t>;
+    using S = tracking_storage<dense_storage<int>>;
+    auto h1 = make_histogram_with(S(1), in{0, 40000});
+    auto h2 = h1;
+    unsafe_access::storage(h1).checkpoint();
+    h1.fill(threads(4), x);
+    h2.fill(x);
+    BOOST_TEST_EQ(h1, h2);
+
+    const auto& s1 = unsafe_access::storage(h1);
+    const auto d = s1.make_delta();
+    std::size_t nonzero = 0;
+    for (std::size_t i = 0; i < s1.size(); ++i) {
+      if (s1[i] == 0) continue;
+      ++nonzero;
+      BOOST_TEST(s1.is_dirty(i / s1.block_size()));
+    }
+    BOOST_TEST_EQ(d.blocks().size(), nonzero);
+  }
+
+  // exception thrown in worker thread is passed to caller
+  {
+    using V = axis::variant<axis::integer<>, axis::category<std::string>>;
+    std::vector<V> axes = {axis::category<std::string>({"A", "B"})};
+    auto h = make_histogram(axes);
+    std::vector<int> x(n_fill, 1);
+    BOOST_TEST_THROWS(h.fill(threads(4), x), std::invalid_argument);
+  }
+
   return boost::report_errors();
 }
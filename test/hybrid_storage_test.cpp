@@ -0,0 +1,223 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/core/lightweight_test.hpp>
+#include <boost/core/lightweight_test_trait.hpp>
+#include <boost/histogram/accumulators/mean.hpp>
+#include <boost/histogram/accumulators/weighted_sum.hpp>
+#include <boost/histogram/algorithm/project.hpp>
+#include <boost/histogram/algorithm/reduce.hpp>
+#include <boost/histogram/algorithm/sum.hpp>
+#include <boost/histogram/axis/integer.hpp>
+#include <boost/histogram/axis/regular.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/histogram.hpp>
+#include <boost/histogram/hybrid_storage.hpp>
+#include <boost/histogram/indexed.hpp>
+#include <boost/histogram/make_histogram.hpp>
+#include <boost/histogram/storage_adaptor.hpp>
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "throw_exception.hpp"
+#include "utility_allocator.hpp"
+
+using namespace boost::histogram;
+
+int main() {
+  BOOST_TEST_TRAIT_TRUE((detail::is_storage<hybrid_storage<double>>));
+  BOOST_TEST_TRAIT_TRUE((detail::is_storage<hybrid_storage<accumulators::mean<>>>));
+
+  BOOST_TEST_THROWS(hybrid_storage<double>(1.5), std::invalid_argument);
+  BOOST_TEST_THROWS(hybrid_storage<double>(-0.1), std::invalid_argument);
+
+  // becomes dense when threshold is exceeded and sparse again on reset
+  {
+    hybrid_storage<int> a;
+    BOOST_TEST_EQ(a.max_occupancy(), 0.25);
+    a.reset(20);
+    BOOST_TEST_NOT(a.is_dense());
+    ++a[0];
+    a[5] = 2;
+    a[6] = 0; // does not occupy a cell
+    a[7] *= 3;
+    a[10] += 3;
+    a[19] -= 1;
+    a[2] = 1;
+    BOOST_TEST_NOT(a.is_dense());
+    BOOST_TEST_EQ(a[0], 1);
+    BOOST_TEST_EQ(a[5], 2);
+    BOOST_TEST_EQ(a[19], -1);
+    a[3] = 1;
+    BOOST_TEST(a.is_dense());
+    BOOST_TEST_EQ(a.size(), 20);
+    BOOST_TEST(a == (std::vector<int>{1, 0, 1, 1, 0, 2, 0, 0, 0, 0, 3, 0, 0, 0, 0, 0, 0,
+                                      0, 0, -1}));
+    ++a[4];
+    BOOST_TEST_EQ(a[4], 1);
+
+    a.reset(10);
+    BOOST_TEST_NOT(a.is_dense());
+    BOOST_TEST_EQ(a.size(), 10);
+    BOOST_TEST_EQ(std::count(a.begin(), a.end(), 0), 10);
+  }
+
+  // threshold of 1 never becomes dense
+  {
+    hybrid_storage<double> a(1.0);
+    a.reset(4);
+    for (auto&& x : a) x = 1;
+    BOOST_TEST_NOT(a.is_dense());
+    BOOST_TEST_EQ(std::count(a.begin(), a.end(), 1), 4);
+  }
+
+  // compare, add, scale in all combinations of representations
+  {
+    std::vector<double> ref(100);
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<std::size_t> id(0, ref.size() - 1);
+    hybrid_storage<double> s, d;
+    s.reset(ref.size());
+    d.reset(ref.size());
+    for (int i = 0; i < 10; ++i) {
+      const auto k = id(gen);
+      s[k] += 1;
+      ref[k] += 1;
+    }
+    for (auto&& x : d) x = 1;
+    BOOST_TEST_NOT(s.is_dense());
+    BOOST_TEST(d.is_dense());
+    BOOST_TEST(s == ref);
+    BOOST_TEST_NOT(s == d);
+
+    auto s2 = s;
+    s2 += s;
+    BOOST_TEST_NOT(s2.is_dense());
+    s2 *= 0.5;
+    BOOST_TEST(s2 == s);
+
+    auto d2 = d;
+    d2 += s;
+    BOOST_TEST(d2.is_dense());
+    s2 += d;
+    BOOST_TEST(s2.is_dense());
+    BOOST_TEST(s2 == d2);
+    s2 *= 2;
+    for (auto&& x : ref) x = 2 * (x + 1);
+    BOOST_TEST(s2 == ref);
+  }
+
+  // copy from iterable
+  {
+    std::vector<int> v{0, 1, 0, 0, 0, 0, 0, 0, 0, 0};
+    hybrid_storage<int> a(v);
+    BOOST_TEST_NOT(a.is_dense());
+    BOOST_TEST(a == v);
+    v.assign(10, 1);
+    a = v;
+    BOOST_TEST(a.is_dense());
+    BOOST_TEST(a == v);
+  }
+
+  // allocator is used for hash table and array, only one of them is kept
+  {
+    tracing_allocator_db db;
+    hybrid_storage<double, tracing_allocator<double>> a(tracing_allocator<double>{db});
+    a.reset(4);
+    ++a[1];
+    BOOST_TEST_GT(db.first, 0);
+    ++a[2];
+    BOOST_TEST(a.is_dense());
+    BOOST_TEST_EQ(db.first, 4 * sizeof(double));
+    a.reset(4);
+    BOOST_TEST_EQ(db.first, 0);
+  }
+
+  // histogram which starts sparse and becomes dense
+  {
+    using reg = axis::regular<>;
+    auto h1 = make_histogram_with(hybrid_storage<double>(), reg(20, 0, 1), reg(20, 0, 1));
+    auto h2 = make_histogram(reg(20, 0, 1), reg(20, 0, 1));
+    std::mt19937 gen(1);
+    std::normal_distribution<> nd(0.5, 0.02);
+    std::vector<double> x[2];
+    for (auto&& xi : x) {
+      xi.resize(1000);
+      std::generate(xi.begin(), xi.end(), [&] { return nd(gen); });
+    }
+    for (int i = 0; i < 20; ++i) {
+      h1(x[0][i], x[1][i]);
+      h2(x[0][i], x[1][i]);
+    }
+    BOOST_TEST_NOT(unsafe_access::storage(h1).is_dense());
+    BOOST_TEST(h1 == h2);
+
+    std::uniform_real_distribution<> ud(0, 1);
+    for (auto&& xi : x) std::generate(xi.begin(), xi.end(), [&] { return ud(gen); });
+    h1.fill(x);
+    h2.fill(x);
+    BOOST_TEST(unsafe_access::storage(h1).is_dense());
+    BOOST_TEST(h1 == h2);
+    BOOST_TEST_EQ(algorithm::sum(h1), 1020);
+
+    auto ind1 = indexed(h1, coverage::all);
+    auto ind2 = indexed(h2, coverage::all);
+    BOOST_TEST(std::equal(ind1.begin(), ind1.end(), ind2.begin(),
+                          [](const auto& a, const auto& b) { return *a == *b; }));
+
+    auto p1 = algorithm::project(h1, std::integral_constant<unsigned, 0>{});
+    auto p2 = algorithm::project(h2, std::integral_constant<unsigned, 0>{});
+    BOOST_TEST(std::equal(p1.begin(), p1.end(), p2.begin()));
+
+    h1.reset();
+    BOOST_TEST_NOT(unsafe_access::storage(h1).is_dense());
+    BOOST_TEST_EQ(algorithm::sum(h1), 0);
+  }
+
+  // max_occupancy survives project, reduce, and growth
+  {
+    using ing = axis::integer<int, axis::null_type, axis::option::growth_t>;
+    auto h = make_histogram_with(hybrid_storage<double>(0.5), axis::regular<>(4, 0, 1),
+                                 ing(0, 2));
+    const auto p = algorithm::project(h, std::integral_constant<unsigned, 0>{});
+    BOOST_TEST_EQ(unsafe_access::storage(p).max_occupancy(), 0.5);
+    const auto r = algorithm::reduce(h, algorithm::shrink(0, 0, 0.5));
+    BOOST_TEST_EQ(unsafe_access::storage(r).max_occupancy(), 0.5);
+    h(0.5, 5);
+    BOOST_TEST_EQ(unsafe_access::storage(h).max_occupancy(), 0.5);
+    BOOST_TEST_EQ(h.axis(1).size(), 6);
+  }
+
+  // accumulators
+  {
+    auto h = make_histogram_with(hybrid_storage<accumulators::weighted_sum<>>(),
+                                 axis::integer<>(0, 8));
+    h(1, weight(2));
+    h(1, weight(3));
+    // proxy references do not have the methods of the accumulator
+    const auto& hc = h;
+    BOOST_TEST_EQ(hc[1].value(), 5);
+    BOOST_TEST_EQ(hc[1].variance(), 13);
+    BOOST_TEST_NOT(unsafe_access::storage(h).is_dense());
+    h(2, weight(1));
+    h(3, weight(1));
+    BOOST_TEST(unsafe_access::storage(h).is_dense());
+    BOOST_TEST_EQ(hc[1].value(), 5);
+    BOOST_TEST_EQ(hc[3].value(), 1);
+
+    auto p = make_histogram_with(hybrid_storage<accumulators::mean<>>(),
+                                 axis::integer<>(0, 1000));
+    p(1, sample(2));
+    p(1, sample(4));
+    const auto& pc = p;
+    BOOST_TEST_EQ(pc[1].count(), 2);
+    BOOST_TEST_EQ(pc[1].value(), 3);
+  }
+
+  return boost::report_errors();
+}
@@ -0,0 +1,182 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/config.hpp>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/core/lightweight_test_trait.hpp>
+#include <boost/histogram/accumulators/weighted_sum.hpp>
+#include <boost/histogram/algorithm/sum.hpp>
+#include <boost/histogram/axis/integer.hpp>
+#include <boost/histogram/axis/regular.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/histogram.hpp>
+#include <boost/histogram/make_histogram.hpp>
+#include <boost/histogram/mapped_storage.hpp>
+#include <boost/histogram/storage_adaptor.hpp>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+#include "throw_exception.hpp"
+
+using namespace boost::histogram;
+
+#ifdef BOOST_HAS_UNISTD_H
+
+int main() {
+  using S = mapped_storage<double>;
+  BOOST_TEST_TRAIT_TRUE((detail::is_storage<S>));
+  using W = mapped_storage<accumulators::weighted_sum<>>;
+  BOOST_TEST_TRAIT_TRUE((detail::is_storage<W>));
+
+  const char* path = "mapped_storage_test.dat";
+
+  // anonymous memory
+  {
+    S a;
+    BOOST_TEST_EQ(a.size(), 0);
+    BOOST_TEST_NOT(a.is_file_backed());
+    BOOST_TEST(a.begin() == a.end());
+    a.reset(3);
+    BOOST_TEST(a == (std::vector<double>{0, 0, 0}));
+    a[1] = 2;
+    ++a[2];
+    BOOST_TEST(a == (std::vector<double>{0, 2, 1}));
+    a.reset(2);
+    BOOST_TEST(a == (std::vector<double>{0, 0}));
+    a.flush();
+    a.advise(S::advice::dont_need);
+    a.reset(2);
+    a[0] = 1;
+    a.advise(S::advice::dont_need);
+    BOOST_TEST_EQ(a[0], 1);
+  }
+
+  // file, copy and move
+  {
+    S a(path, S::open_mode::create, S::advice::random);
+    BOOST_TEST(a.is_file_backed());
+    a.reset(4);
+    a[0] = 1;
+    a[3] = 2;
+    a.reset(4);
+    BOOST_TEST(a == (std::vector<double>{0, 0, 0, 0}));
+    a[0] = 1;
+
+    auto b = a;
+    BOOST_TEST_NOT(b.is_file_backed());
+    BOOST_TEST(b == a);
+    b[0] = 3;
+    BOOST_TEST_EQ(a[0], 1);
+
+    a = b;
+    BOOST_TEST(a.is_file_backed());
+    BOOST_TEST_EQ(a[0], 3);
+
+    S c(std::move(a));
+    BOOST_TEST(c.is_file_backed());
+    BOOST_TEST_EQ(c[0], 3);
+
+    S d(std::vector<int>{1, 2});
+    BOOST_TEST_NOT(d.is_file_backed());
+    BOOST_TEST(d == (std::vector<double>{1, 2}));
+  }
+
+  // resume histogram from file
+  {
+    using reg = axis::regular<>;
+    auto h1 = make_histogram_with(S(path), reg(10, 0, 1), reg(10, 0, 1));
+    auto h2 = make_histogram(reg(10, 0, 1), reg(10, 0, 1));
+    for (double x : {0.1, 0.2, 0.2, 0.5, 2.0}) {
+      h1(x, x);
+      h2(x, x);
+    }
+    BOOST_TEST(h1 == h2);
+    unsafe_access::storage(h1).flush();
+
+    // cells stay in the file after the histogram is destroyed
+    auto h3 = make_histogram_with(S(path, S::open_mode::resume), reg(10, 0, 1),
+                                  reg(10, 0, 1));
+    BOOST_TEST(h3 == h2);
+    h3(0.1, 0.1);
+    h2(0.1, 0.1);
+    BOOST_TEST(h3 == h2);
+    BOOST_TEST_EQ(algorithm::sum(h3), 6);
+
+    // histogram with different number of cells
+    BOOST_TEST_THROWS(
+        make_histogram_with(S(path, S::open_mode::resume), reg(10, 0, 1)),
+        std::invalid_argument);
+
+    // resetting the histogram zeros the cells in the file
+    h3.reset();
+    BOOST_TEST_EQ(algorithm::sum(h3), 0);
+  }
+
+  // resume with missing or incompatible file
+  {
+    std::remove(path);
+    S a(path, S::open_mode::resume);
+    a.reset(2);
+    BOOST_TEST(a == (std::vector<double>{0, 0}));
+
+    using F = mapped_storage<float>;
+    BOOST_TEST_THROWS(F(path, F::open_mode::resume), std::invalid_argument);
+
+    std::ofstream(path) << "not a histogram";
+    BOOST_TEST_THROWS(S(path, S::open_mode::resume), std::invalid_argument);
+  }
+
+  BOOST_TEST_THROWS(S("no_such_directory/mapped_storage_test.dat"), std::system_error);
+
+  // growing axes enlarge the file, with and without a file
+  {
+    using ig = axis::integer<int, axis::null_type, axis::option::growth_t>;
+    using in = axis::integer<>;
+    auto h1 = make_histogram_with(S(path), ig(0, 2), in(0, 2));
+    auto h2 = make_histogram_with(S(), ig(0, 2), in(0, 2));
+    auto h3 = make_histogram(ig(0, 2), in(0, 2));
+    auto fill = [&](int x, int y) {
+      h1(x, y);
+      h2(x, y);
+      h3(x, y);
+    };
+    fill(0, 0);
+    fill(1, -1);
+    fill(1, 2);
+    fill(5, 1);
+    fill(-2, 0);
+    fill(-3, 5);
+    BOOST_TEST(unsafe_access::storage(h1).is_file_backed());
+    BOOST_TEST(h1.axis(0) == ig(-3, 6));
+    BOOST_TEST(h1 == h3);
+    BOOST_TEST(h2 == h3);
+    unsafe_access::storage(h1).flush();
+
+    auto h4 = make_histogram_with(S(path, S::open_mode::resume), ig(-3, 6), in(0, 2));
+    BOOST_TEST(h4 == h3);
+  }
+
+  // accumulators
+  {
+    auto h = make_histogram_with(W(path), axis::integer<>(0, 3));
+    h(1, weight(2));
+    h(1, weight(3));
+    BOOST_TEST_EQ(h[1].value(), 5);
+    BOOST_TEST_EQ(h[1].variance(), 13);
+  }
+
+  std::remove(path);
+
+  return boost::report_errors();
+}
+
+#else
+
+int main() { return 0; }
+
+#endif
@@ -0,0 +1,165 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/core/lightweight_test.hpp>
+#include <boost/histogram/accumulators/count.hpp>
+#include <boost/histogram/accumulators/mean.hpp>
+#include <boost/histogram/accumulators/weighted_sum.hpp>
+#include <boost/histogram/axis.hpp>
+#include <boost/histogram/axis/ostream.hpp>
+#include <boost/histogram/native_archive.hpp>
+#include <boost/histogram/ostream.hpp>
+#include <boost/histogram/sparse_storage.hpp>
+#include <boost/histogram/storage_adaptor.hpp>
+#include <boost/histogram/unlimited_storage.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "throw_exception.hpp"
+#include "utility_histogram.hpp"
+
+using namespace boost::histogram;
+
+template <class T>
+std::string save(const T& t) {
+  std::ostringstream os;
+  native_oarchive oa(os);
+  oa << t;
+  return os.str();
+}
+
+template <class T>
+void load(const std::string& s, T& t) {
+  std::istringstream is(s);
+  native_iarchive ia(is);
+  ia >> t;
+}
+
+template <class Tag>
+void run_tests() {
+  // all axis types
+  {
+    namespace tr = axis::transform;
+    using def = use_default;
+    using axis::option::none_t;
+    auto a =
+        make(Tag(), axis::regular<double, def, def, none_t>(1, -1, 1, "reg"),
+             axis::circular<float, def, none_t>(1, 0.0, 1.0, "cir"),
+             axis::regular<double, tr::log, def, none_t>(1, 1, std::exp(2), "reg-log"),
+             axis::regular<double, tr::pow, std::vector<int>, axis::option::overflow_t>(
+                 tr::pow(0.5), 1, 1, 100, {1, 2, 3}),
+             axis::variable<double, def, none_t>({1.5, 2.5}, "var"),
+             axis::category<int, def, none_t>{3, 1},
+             axis::integer<int, axis::null_type, none_t>(1, 2),
+             axis::category<std::string>({"foo", "bar"}), axis::boolean<>());
+    a(0.5, 0.2, 2, 20, 2.2, 1, 1, std::string("bar"), true);
+
+    auto b = decltype(a)();
+    BOOST_TEST_NE(a, b);
+    load(save(a), b);
+    BOOST_TEST_EQ(a, b);
+  }
+
+  // unlimited_storage with all cell types
+  {
+    auto a = make(Tag(), axis::integer<>(0, 3));
+    auto b = a;
+    load(save(a), b);
+    BOOST_TEST_EQ(a, b);
+    a(0);
+    for (auto&& x : {0, 1, 2}) {
+      unsafe_access::storage(a)[static_cast<std::size_t>(x)] +=
+          std::numeric_limits<std::uint16_t>::max();
+      load(save(a), b);
+      BOOST_TEST_EQ(a, b);
+    }
+    unsafe_access::storage(a)[1] += std::numeric_limits<std::uint32_t>::max();
+    load(save(a), b);
+    BOOST_TEST_EQ(a, b);
+    unsafe_access::storage(a)[1] += std::numeric_limits<std::uint64_t>::max();
+    load(save(a), b);
+    BOOST_TEST_EQ(a, b);
+    unsafe_access::storage(a)[2] += 0.5;
+    load(save(a), b);
+    BOOST_TEST_EQ(a, b);
+  }
+
+  // storages with accumulators and maps
+  {
+    auto a = make_s(Tag(), weight_storage(), axis::integer<>(0, 3));
+    a(0, weight(2));
+    a(1, weight(3));
+    auto b = decltype(a)();
+    load(save(a), b);
+    BOOST_TEST_EQ(a, b);
+
+    auto c = make_s(Tag(), profile_storage(), axis::integer<>(0, 3));
+    c(0, sample(2));
+    c(0, sample(3));
+    auto d = decltype(c)();
+    load(save(c), d);
+    BOOST_TEST_EQ(c, d);
+
+    auto e = make_s(Tag(), std::map<std::size_t, double>(), axis::integer<>(0, 3));
+    e(1);
+    auto f = decltype(e)();
+    load(save(e), f);
+    BOOST_TEST_EQ(e, f);
+
+    auto g = make_s(Tag(), sparse_storage<double>(), axis::integer<>(0, 1000));
+    g(1);
+    g(500, weight(2));
+    auto h = decltype(g)();
+    load(save(g), h);
+    BOOST_TEST_EQ(g, h);
+
+    // not trivially copyable cells are stored item by item
+    using count_storage = dense_storage<accumulators::count<int, true>>;
+    auto i = make_s(Tag(), count_storage(), axis::integer<>(0, 3));
+    i(1);
+    auto j = decltype(i)();
+    load(save(i), j);
+    BOOST_TEST_EQ(i, j);
+  }
+}
+
+int main() {
+  run_tests<static_tag>();
+  run_tests<dynamic_tag>();
+
+  // cells are stored as one block of raw bytes
+  {
+    auto h = make_s(static_tag(), dense_storage<double>(), axis::integer<>(0, 1000));
+    const auto s = save(h);
+    BOOST_TEST_LT(s.size(), 1002 * sizeof(double) + 200);
+    BOOST_TEST_EQ(s.substr(0, 8), "BHNATIVE");
+  }
+
+  // errors
+  {
+    auto h = make_s(static_tag(), dense_storage<double>(), axis::integer<>(0, 3));
+    h(1);
+    auto s = save(h);
+
+    auto h2 = h;
+    BOOST_TEST_THROWS(load(s.substr(0, s.size() - 1), h2), std::runtime_error);
+    BOOST_TEST_THROWS(load("BHNATIVX" + s.substr(8), h2), std::runtime_error);
+    auto s2 = s;
+    s2[8] = 2; // format version
+    BOOST_TEST_THROWS(load(s2, h2), std::runtime_error);
+
+    // block has cells of different size
+    auto h3 = make_s(static_tag(), dense_storage<float>(), axis::integer<>(0, 3));
+    BOOST_TEST_THROWS(load(s, h3), std::runtime_error);
+  }
+
+  return boost::report_errors();
+}
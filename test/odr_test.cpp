@@ -7,4 +7,5 @@
 // include all Boost.Histogram header here; see odr_main_test.cpp for details
 #include <boost/histogram.hpp>
 #include <boost/histogram/ostream.hpp>
+#include <boost/histogram/native_archive.hpp>
 #include <boost/histogram/serialization.hpp>
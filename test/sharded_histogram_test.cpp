@@ -0,0 +1,158 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/core/lightweight_test.hpp>
+#include <boost/histogram/accumulators/mean.hpp>
+#include <boost/histogram/algorithm/sum.hpp>
+#include <boost/histogram/axis/category.hpp>
+#include <boost/histogram/axis/integer.hpp>
+#include <boost/histogram/axis/ostream.hpp>
+#include <boost/histogram/axis/regular.hpp>
+#include <boost/histogram/make_histogram.hpp>
+#include <boost/histogram/make_profile.hpp>
+#include <boost/histogram/ostream.hpp>
+#include <boost/histogram/sample.hpp>
+#include <boost/histogram/sharded_histogram.hpp>
+#include <boost/histogram/weight.hpp>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "is_close.hpp"
+#include "throw_exception.hpp"
+
+using namespace boost::histogram;
+
+constexpr unsigned n_fill = 40000;
+constexpr unsigned n_threads = 4;
+static_assert(n_fill % n_threads == 0, "must be multiple of n_threads");
+
+template <class F>
+void run_threads(F f) {
+  std::vector<std::thread> threads;
+  for (unsigned k = 0; k < n_threads; ++k) threads.emplace_back(f, k);
+  for (auto&& t : threads) t.join();
+}
+
+int main() {
+  std::default_random_engine gen(1);
+  std::normal_distribution<> dis(0.5, 0.3);
+  std::vector<double> x(n_fill), y(n_fill);
+  for (auto&& xi : x) xi = dis(gen);
+  for (auto&& yi : y) yi = dis(gen);
+  constexpr auto chunk = n_fill / n_threads;
+
+  // single fills from several threads
+  {
+    auto h = make_histogram(axis::regular<>(10, 0, 1), axis::integer<>(0, 3));
+    auto sh = make_sharded_histogram(h);
+    BOOST_TEST_EQ(sh.shard_count(), 0);
+    BOOST_TEST_EQ(sh.merged(), h);
+
+    run_threads([&](unsigned k) {
+      for (unsigned i = k * chunk; i < (k + 1) * chunk; ++i) sh(x[i], 3 * y[i]);
+    });
+    for (unsigned i = 0; i < n_fill; ++i) h(x[i], 3 * y[i]);
+
+    BOOST_TEST_EQ(sh.shard_count(), n_threads);
+    BOOST_TEST_EQ(algorithm::sum(sh.merged()), n_fill);
+    BOOST_TEST_EQ(sh.merged(), h);
+
+    // cached view is returned while there are no new fills
+    const auto* p = &sh.merged();
+    BOOST_TEST_EQ(p, &sh.merged());
+    BOOST_TEST_EQ(sh.merged().at(0, 0), h.at(0, 0));
+
+    // calling thread gets its own shard, view is updated after fill
+    sh(0.05, 0);
+    h(0.05, 0);
+    BOOST_TEST_EQ(sh.shard_count(), n_threads + 1);
+    BOOST_TEST_EQ(sh.merged(), h);
+
+    sh.reset();
+    BOOST_TEST_EQ(algorithm::sum(sh.merged()), 0);
+    BOOST_TEST_EQ(sh.shard_count(), n_threads + 1);
+    sh(0.05, 0);
+    BOOST_TEST_EQ(sh.merged().at(0, 0), 1);
+  }
+
+  // initial state is part of merged view
+  {
+    auto h = make_histogram(axis::integer<>(0, 2));
+    h(0);
+    auto sh = make_sharded_histogram(h);
+    run_threads([&sh](unsigned) { sh(1); });
+    BOOST_TEST_EQ(sh.merged().at(0), 1);
+    BOOST_TEST_EQ(sh.merged().at(1), n_threads);
+  }
+
+  // fill with arrays, weights, and samples
+  {
+    auto h1 = make_weighted_histogram(axis::regular<>(10, 0, 1));
+    auto sh1 = make_sharded_histogram(h1);
+    auto h2 = make_profile(axis::regular<>(10, 0, 1));
+    auto sh2 = make_sharded_histogram(h2);
+    run_threads([&](unsigned k) {
+      const auto xs = x.data() + k * chunk;
+      const auto ys = y.data() + k * chunk;
+      sh1.fill(detail::span<const double>(xs, chunk),
+               weight(detail::span<const double>(ys, chunk)));
+      sh2.fill(detail::span<const double>(xs, chunk),
+               sample(detail::span<const double>(ys, chunk)));
+    });
+    h1.fill(x, weight(y));
+    h2.fill(x, sample(y));
+    for (auto&& i : indexed(h1, coverage::all)) {
+      // summation order differs, results are only equal up to round-off
+      BOOST_TEST_IS_CLOSE(sh1.merged().at(i.index()).value(), i->value(), 1e-9);
+      BOOST_TEST_IS_CLOSE(sh1.merged().at(i.index()).variance(), i->variance(), 1e-9);
+    }
+    for (auto&& i : indexed(h2, coverage::all)) {
+      BOOST_TEST_EQ(sh2.merged().at(i.index()).count(), i->count());
+      BOOST_TEST_IS_CLOSE(sh2.merged().at(i.index()).value(), i->value(), 1e-9);
+    }
+  }
+
+  // threads alternate between instances, with more instances than cache entries, the
+  // least recently used entries are evicted
+  {
+    auto h = make_histogram(axis::integer<>(0, n_threads));
+    using sh_t = decltype(make_sharded_histogram(h));
+    for (unsigned n : {2, 20}) {
+      std::vector<std::unique_ptr<sh_t>> shs;
+      for (unsigned j = 0; j < n; ++j) shs.emplace_back(new sh_t(h));
+      run_threads([&](unsigned k) {
+        for (unsigned i = 0; i < 100; ++i)
+          for (unsigned j = 0; j < n; ++j) (*shs[j])(k);
+      });
+      for (unsigned j = 0; j < n; ++j) {
+        BOOST_TEST_EQ(shs[j]->shard_count(), n_threads);
+        for (unsigned k = 0; k < n_threads; ++k)
+          BOOST_TEST_EQ(shs[j]->merged().at(k), 100);
+      }
+    }
+  }
+
+  // growing category axis, shards grow independently and are merged
+  {
+    using cat = axis::category<std::string, axis::null_type, axis::option::growth_t>;
+    auto sh = make_sharded_histogram(make_histogram(cat()));
+    const std::vector<std::string> labels = {"a", "b", "c", "d"};
+    run_threads([&](unsigned k) {
+      for (unsigned i = 0; i <= k; ++i) sh(labels[k]);
+      sh("x");
+    });
+    const auto& h = sh.merged();
+    BOOST_TEST_EQ(h.axis().size(), 5);
+    BOOST_TEST_EQ(algorithm::sum(h), 1 + 2 + 3 + 4 + n_threads);
+    for (unsigned k = 0; k < n_threads; ++k)
+      BOOST_TEST_EQ(h.at(h.axis().index(labels[k])), k + 1);
+    BOOST_TEST_EQ(h.at(h.axis().index("x")), n_threads);
+  }
+
+  return boost::report_errors();
+}
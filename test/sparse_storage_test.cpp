@@ -0,0 +1,185 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/core/lightweight_test.hpp>
+#include <boost/core/lightweight_test_trait.hpp>
+#include <boost/histogram/accumulators/mean.hpp>
+#include <boost/histogram/accumulators/weighted_sum.hpp>
+#include <boost/histogram/algorithm/sum.hpp>
+#include <boost/histogram/axis/integer.hpp>
+#include <boost/histogram/axis/regular.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/histogram.hpp>
+#include <boost/histogram/make_histogram.hpp>
+#include <boost/histogram/sparse_storage.hpp>
+#include <boost/histogram/storage_adaptor.hpp>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+#include "throw_exception.hpp"
+#include "utility_allocator.hpp"
+
+using namespace boost::histogram;
+
+int main() {
+  BOOST_TEST_TRAIT_TRUE((detail::is_storage<sparse_storage<double>>));
+  BOOST_TEST_TRAIT_TRUE((detail::is_storage<sparse_storage<accumulators::mean<>>>));
+
+  // empty state
+  {
+    sparse_storage<double> a;
+    BOOST_TEST_EQ(a.size(), 0);
+    BOOST_TEST_EQ(a.occupied(), 0);
+    BOOST_TEST(a.begin() == a.end());
+    a.reset(10);
+    BOOST_TEST_EQ(a.size(), 10);
+    BOOST_TEST_EQ(std::count(a.begin(), a.end(), 0), 10);
+    BOOST_TEST_EQ(a.occupied(), 0);
+  }
+
+  // only written cells are occupied
+  {
+    sparse_storage<int> a;
+    a.reset(1000000000);
+    ++a[3];
+    a[999999999] += 5;
+    a[7] = 2;
+    a[8] = 0;
+    a[9] *= 2;
+    BOOST_TEST_EQ(a.occupied(), 3);
+    BOOST_TEST_EQ(a[3], 1);
+    BOOST_TEST_EQ(a[999999999], 5);
+    BOOST_TEST_EQ(a[7], 2);
+    BOOST_TEST_EQ(a[8], 0);
+    const auto& ac = a;
+    BOOST_TEST_EQ(ac[4], 0);
+    BOOST_TEST_EQ(a.occupied(), 3);
+
+    std::map<std::size_t, int> m;
+    a.for_each_occupied([&m](std::size_t i, int x) { m[i] = x; });
+    BOOST_TEST(m == (std::map<std::size_t, int>{{3, 1}, {7, 2}, {999999999, 5}}));
+
+    a.reset(10);
+    BOOST_TEST_EQ(a.occupied(), 0);
+    BOOST_TEST_EQ(std::count(a.begin(), a.end(), 0), 10);
+  }
+
+  // many cells, table grows
+  {
+    sparse_storage<double> a;
+    std::vector<double> b(100000);
+    a.reset(b.size());
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<std::size_t> id(0, b.size() - 1);
+    for (int i = 0; i < 50000; ++i) {
+      const auto k = id(gen);
+      a[k] += 0.5;
+      b[k] += 0.5;
+    }
+    BOOST_TEST_EQ(a.occupied(), b.size() - std::count(b.begin(), b.end(), 0));
+    BOOST_TEST(a == b);
+    BOOST_TEST(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+
+    sparse_storage<double> c(b);
+    BOOST_TEST(c == a);
+    BOOST_TEST_EQ(c.occupied(), a.occupied());
+  }
+
+  // compare, add, scale
+  {
+    sparse_storage<double> a, b;
+    a.reset(5);
+    b.reset(5);
+    BOOST_TEST(a == b);
+    a[1] = 2;
+    BOOST_TEST_NOT(a == b);
+    b[1] = 2;
+    b[3] = 0;
+    // occupied cell with default value equals empty cell
+    BOOST_TEST(a == b);
+    b[4] = 1;
+    a += b;
+    BOOST_TEST_EQ(a[1], 4);
+    BOOST_TEST_EQ(a[4], 1);
+    a *= 2;
+    BOOST_TEST_EQ(a[1], 8);
+    BOOST_TEST_EQ(a[4], 2);
+    BOOST_TEST_EQ(a[0], 0);
+    a[4] /= 2;
+    a[0] /= 2;
+    BOOST_TEST_EQ(a[4], 1);
+    BOOST_TEST_EQ(a[0], 0);
+    a[4] -= 1;
+    BOOST_TEST_EQ(a[4], 0);
+  }
+
+  // allocator is used for hash table
+  {
+    tracing_allocator_db db;
+    sparse_storage<double, tracing_allocator<double>> a(tracing_allocator<double>{db});
+    a.reset(100);
+    ++a[1];
+    BOOST_TEST_GT(db.first, 0);
+  }
+
+  // histogram with many cells of which few are filled
+  {
+    using reg = axis::regular<>;
+    auto h1 = make_histogram_with(sparse_storage<double>(), reg(100, 0, 1),
+                                  reg(100, 0, 1), reg(100, 0, 1), reg(100, 0, 1));
+    auto h2 = make_histogram_with(std::map<std::size_t, double>(), reg(100, 0, 1),
+                                  reg(100, 0, 1), reg(100, 0, 1), reg(100, 0, 1));
+    std::mt19937 gen(1);
+    std::normal_distribution<> nd(0.5, 0.01);
+    std::vector<double> x[4];
+    for (auto&& xi : x) {
+      xi.resize(1000);
+      std::generate(xi.begin(), xi.end(), [&] { return nd(gen); });
+    }
+    for (int i = 0; i < 500; ++i) {
+      h1(x[0][i], x[1][i], x[2][i], x[3][i]);
+      h2(x[0][i], x[1][i], x[2][i], x[3][i]);
+    }
+    h1.fill(x, weight(2));
+    h2.fill(x, weight(2));
+    BOOST_TEST(h1 == h2);
+    BOOST_TEST_EQ(algorithm::sum(h1), 2500);
+    BOOST_TEST_LE(unsafe_access::storage(h1).occupied(), 1000);
+
+    auto h3 = h1;
+    h3 += h1;
+    BOOST_TEST_EQ(algorithm::sum(h3), 5000);
+    BOOST_TEST_EQ(unsafe_access::storage(h3).occupied(),
+                  unsafe_access::storage(h1).occupied());
+    h3 *= 0.5;
+    BOOST_TEST(h3 == h1);
+  }
+
+  // accumulators
+  {
+    auto h = make_histogram_with(sparse_storage<accumulators::weighted_sum<>>(),
+                                 axis::integer<>(0, 1000));
+    h(1, weight(2));
+    h(1, weight(3));
+    // proxy references do not have the methods of the accumulator
+    const auto& hc = h;
+    BOOST_TEST_EQ(hc[1].value(), 5);
+    BOOST_TEST_EQ(hc[1].variance(), 13);
+    BOOST_TEST_EQ(hc[2].value(), 0);
+
+    auto p = make_histogram_with(sparse_storage<accumulators::mean<>>(),
+                                 axis::integer<>(0, 1000));
+    p(1, sample(2));
+    p(1, sample(4));
+    const auto& pc = p;
+    BOOST_TEST_EQ(pc[1].count(), 2);
+    BOOST_TEST_EQ(pc[1].value(), 3);
+    BOOST_TEST_EQ(unsafe_access::storage(p).occupied(), 1);
+  }
+
+  return boost::report_errors();
+}
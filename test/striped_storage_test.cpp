@@ -0,0 +1,167 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/core/lightweight_test.hpp>
+#include <boost/core/lightweight_test_trait.hpp>
+#include <boost/histogram/algorithm/project.hpp>
+#include <boost/histogram/algorithm/reduce.hpp>
+#include <boost/histogram/algorithm/sum.hpp>
+#include <boost/histogram/axis/integer.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/histogram.hpp>
+#include <boost/histogram/make_histogram.hpp>
+#include <boost/histogram/striped_storage.hpp>
+#include <boost/histogram/unsafe_access.hpp>
+#include <algorithm>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "throw_exception.hpp"
+
+using namespace boost::histogram;
+
+constexpr auto n_fill = 120000;
+
+int main() {
+  BOOST_TEST_TRAIT_TRUE((detail::is_storage<striped_storage<int>>));
+
+  // number of stripes
+  {
+    BOOST_TEST_EQ(striped_storage<int>(1).stripes(), 1);
+    BOOST_TEST_EQ(striped_storage<int>(3).stripes(), 4);
+    BOOST_TEST_EQ(striped_storage<int>(8).stripes(), 8);
+    BOOST_TEST_GE(striped_storage<int>().stripes(), 1);
+  }
+
+  // number of stripes survives project, reduce, and growth
+  {
+    using ing = axis::integer<int, axis::null_type, axis::option::growth_t>;
+    const auto n = striped_storage<int>().stripes() * 2;
+    auto h =
+        make_histogram_with(striped_storage<int>(n), axis::integer<>(0, 4), ing(0, 2));
+    h(1, 1);
+    const auto p = algorithm::project(h, std::integral_constant<unsigned, 0>{});
+    BOOST_TEST_EQ(unsafe_access::storage(p).stripes(), n);
+    const auto r = algorithm::reduce(h, algorithm::shrink(0, 0, 2));
+    BOOST_TEST_EQ(unsafe_access::storage(r).stripes(), n);
+    BOOST_TEST_EQ(algorithm::sum(r), 1);
+    h(1, 5);
+    BOOST_TEST_EQ(unsafe_access::storage(h).stripes(), n);
+    BOOST_TEST_EQ(h.at(1, 1), 1);
+    BOOST_TEST_EQ(h.at(1, 5), 1);
+  }
+
+  // cell access
+  {
+    striped_storage<int> s(4);
+    s.reset(3);
+    BOOST_TEST_EQ(s.size(), 3);
+    BOOST_TEST_EQ(std::count(s.begin(), s.end(), 0), 3);
+    ++s[0];
+    s[1] += 2;
+    s[2] = 5;
+    s[2] -= 1;
+    BOOST_TEST_EQ(s[0], 1);
+    BOOST_TEST_EQ(s[1], 2);
+    BOOST_TEST_EQ(s[2], 4);
+    s[1] *= 3;
+    BOOST_TEST_EQ(s[1], 6);
+    s *= 0.5;
+    BOOST_TEST_EQ(s[1], 3);
+    BOOST_TEST_EQ(s[2], 2);
+
+    const auto& cs = s;
+    BOOST_TEST_EQ(cs[1], 3);
+    BOOST_TEST(s == (std::vector<int>{0, 3, 2}));
+
+    auto s2 = s;
+    BOOST_TEST(s == s2);
+    ++s2[0];
+    BOOST_TEST_NOT(s == s2);
+
+    striped_storage<int> s3(std::vector<int>{1, 2, 3});
+    BOOST_TEST(s3 == (std::vector<int>{1, 2, 3}));
+    s3.reset(2);
+    BOOST_TEST(s3 == (std::vector<int>{0, 0}));
+  }
+
+  // stripes of concurrent threads are summed on read
+  {
+    striped_storage<unsigned> s(4);
+    s.reset(4);
+
+    auto fill = [&s](unsigned k) {
+      for (unsigned i = 0; i < n_fill; ++i) {
+        ++s[(i + k) % 4];
+        s[0] += 1;
+      }
+    };
+
+    std::thread t1(fill, 0);
+    std::thread t2(fill, 1);
+    std::thread t3(fill, 2);
+    std::thread t4(fill, 3);
+    t1.join();
+    t2.join();
+    t3.join();
+    t4.join();
+
+    BOOST_TEST_EQ(s[0], n_fill + 4 * n_fill);
+    BOOST_TEST_EQ(s[1], n_fill);
+    BOOST_TEST_EQ(s[2], n_fill);
+    BOOST_TEST_EQ(s[3], n_fill);
+  }
+
+  // integral cells are scaled after the stripes are summed
+  {
+    auto h = make_histogram_with(striped_storage<int>(2), axis::integer<>(0, 2));
+    // new threads use consecutive stripes, so the counts end up in different stripes
+    std::thread t1([&h] { h(0); });
+    t1.join();
+    std::thread t2([&h] { h(0); });
+    t2.join();
+    auto h2 = h;
+    h *= 0.5;
+    BOOST_TEST_EQ(h.at(0), 1);
+    unsafe_access::storage(h2)[1] *= 0.5; // cell 0 is the underflow bin
+    BOOST_TEST_EQ(h2.at(0), 1);
+    // scaled sum is kept by later fills
+    h(0);
+    BOOST_TEST_EQ(h.at(0), 2);
+  }
+
+  // concurrent filling of histogram
+  {
+    auto h = make_histogram_with(striped_storage<unsigned>(2), axis::integer<>(0, 10));
+    std::vector<int> x(n_fill);
+    for (unsigned i = 0; i < x.size(); ++i) x[i] = i % 12 - 1;
+
+    auto fill = [&h, &x](unsigned k) {
+      if (k == 0)
+        h.fill(x);
+      else
+        for (auto&& xi : x) h(xi);
+    };
+    std::thread t1(fill, 0);
+    std::thread t2(fill, 1);
+    std::thread t3(fill, 2);
+    t1.join();
+    t2.join();
+    t3.join();
+
+    BOOST_TEST_EQ(algorithm::sum(h), 3 * n_fill);
+    for (auto&& i : {-1, 0, 5, 10}) BOOST_TEST_EQ(h.at(i), 3 * n_fill / 12);
+
+    auto h2 = make_histogram_with(striped_storage<unsigned>(2), axis::integer<>(0, 10));
+    h2.fill(x);
+    h2 += h2;
+    h2 += h2;
+    h.fill(x);
+    BOOST_TEST(h == h2);
+  }
+
+  return boost::report_errors();
+}
@@ -0,0 +1,242 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/core/lightweight_test.hpp>
+#include <boost/core/lightweight_test_trait.hpp>
+#include <boost/histogram/accumulators/weighted_sum.hpp>
+#include <boost/histogram/algorithm/project.hpp>
+#include <boost/histogram/algorithm/reduce.hpp>
+#include <boost/histogram/algorithm/sum.hpp>
+#include <boost/histogram/axis/integer.hpp>
+#include <boost/histogram/axis/regular.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/histogram.hpp>
+#include <boost/histogram/hybrid_storage.hpp>
+#include <boost/histogram/make_histogram.hpp>
+#include <boost/histogram/native_archive.hpp>
+#include <boost/histogram/storage_adaptor.hpp>
+#include <boost/histogram/tracking_storage.hpp>
+#include <boost/histogram/unlimited_storage.hpp>
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "throw_exception.hpp"
+
+using namespace boost::histogram;
+
+template <class T>
+std::string save(const T& t) {
+  std::ostringstream os;
+  native_oarchive oa(os);
+  oa << t;
+  return os.str();
+}
+
+template <class T>
+void load(const std::string& s, T& t) {
+  std::istringstream is(s);
+  native_iarchive ia(is);
+  ia >> t;
+}
+
+template <class Storage>
+void sync_test() {
+  using S = tracking_storage<Storage>;
+  using reg = axis::regular<>;
+  auto filler = make_histogram_with(S(), reg(100, 0, 1), reg(100, 0, 1));
+  auto replica = make_histogram_with(S(), reg(100, 0, 1), reg(100, 0, 1));
+
+  // first delta contains all cells
+  auto d = unsafe_access::storage(filler).make_delta();
+  BOOST_TEST_EQ(d.cells().size(), filler.size());
+  unsafe_access::storage(filler).checkpoint();
+  unsafe_access::storage(replica).apply_delta(d);
+  BOOST_TEST(filler == replica);
+
+  std::mt19937 gen(1);
+  std::normal_distribution<> nd(0.5, 0.01);
+  for (int round = 0; round < 3; ++round) {
+    std::vector<double> x[2];
+    for (auto&& xi : x) {
+      xi.resize(1000);
+      std::generate(xi.begin(), xi.end(), [&] { return nd(gen); });
+    }
+    filler.fill(x);
+    filler(x[0][0], x[1][0]);
+    BOOST_TEST(filler != replica);
+
+    d = unsafe_access::storage(filler).make_delta();
+    unsafe_access::storage(filler).checkpoint();
+    // only few blocks around the peak are shipped
+    BOOST_TEST_GT(d.blocks().size(), 0);
+    BOOST_TEST_LT(d.cells().size(), filler.size() / 4);
+
+    decltype(d) d2;
+    load(save(d), d2);
+    unsafe_access::storage(replica).apply_delta(d2);
+    BOOST_TEST(filler == replica);
+    BOOST_TEST_EQ(algorithm::sum(replica), 1001 * (round + 1));
+  }
+
+  // nothing changed
+  d = unsafe_access::storage(filler).make_delta();
+  BOOST_TEST_EQ(d.blocks().size(), 0);
+  BOOST_TEST_EQ(d.cells().size(), 0);
+
+  // scaling changes all cells
+  filler *= 2;
+  d = unsafe_access::storage(filler).make_delta();
+  BOOST_TEST_EQ(d.cells().size(), filler.size());
+  unsafe_access::storage(replica).apply_delta(d);
+  BOOST_TEST(filler == replica);
+}
+
+int main() {
+  BOOST_TEST_TRAIT_TRUE((detail::is_storage<tracking_storage<dense_storage<double>>>));
+  BOOST_TEST_TRAIT_TRUE((detail::is_storage<tracking_storage<unlimited_storage<>>>));
+
+  BOOST_TEST_THROWS(tracking_storage<dense_storage<double>>(0), std::invalid_argument);
+
+  // blocks and dirty bits
+  {
+    tracking_storage<dense_storage<int>> a(3);
+    BOOST_TEST_EQ(a.block_size(), 4);
+    a.reset(10);
+    BOOST_TEST(a == (std::vector<int>(10, 0)));
+    BOOST_TEST(a.is_dirty(0) && a.is_dirty(1) && a.is_dirty(2));
+    auto d = a.make_delta();
+    BOOST_TEST_EQ(d.size(), 10);
+    BOOST_TEST_EQ(d.block_size(), 4);
+    BOOST_TEST(d.blocks() == (std::vector<std::size_t>{0, 1, 2}));
+    BOOST_TEST_EQ(d.cells().size(), 10);
+
+    a.checkpoint();
+    BOOST_TEST_NOT(a.is_dirty(0) || a.is_dirty(1) || a.is_dirty(2));
+    BOOST_TEST_EQ(a.make_delta().cells().size(), 0);
+
+    // const access does not mark blocks
+    const auto& ac = a;
+    BOOST_TEST_EQ(ac[5], 0);
+    BOOST_TEST_EQ(*(ac.begin() + 9), 0);
+    BOOST_TEST_NOT(a.is_dirty(1) || a.is_dirty(2));
+
+    ++a[5];
+    *(a.begin() + 9) = 3;
+    BOOST_TEST_NOT(a.is_dirty(0));
+    BOOST_TEST(a.is_dirty(1) && a.is_dirty(2));
+    d = a.make_delta();
+    BOOST_TEST(d.blocks() == (std::vector<std::size_t>{1, 2}));
+    // last block is shorter
+    BOOST_TEST(d.cells() == (std::vector<int>{0, 1, 0, 0, 0, 3}));
+
+    tracking_storage<dense_storage<int>> b(4);
+    b.reset(10);
+    b.checkpoint();
+    b.apply_delta(d);
+    BOOST_TEST(b == a);
+    BOOST_TEST(b.is_dirty(1) && b.is_dirty(2));
+    BOOST_TEST_NOT(b.is_dirty(0));
+
+    tracking_storage<dense_storage<int>> c(8);
+    c.reset(10);
+    BOOST_TEST_THROWS(c.apply_delta(d), std::invalid_argument);
+    c = tracking_storage<dense_storage<int>>(4);
+    c.reset(9);
+    BOOST_TEST_THROWS(c.apply_delta(d), std::invalid_argument);
+  }
+
+  // many blocks span several words of dirty bits
+  {
+    tracking_storage<dense_storage<int>> a(1);
+    a.reset(200);
+    a.checkpoint();
+    for (std::size_t i : {0, 63, 64, 130, 199}) a[i] = static_cast<int>(i);
+    const auto d = a.make_delta();
+    BOOST_TEST(d.blocks() == (std::vector<std::size_t>{0, 63, 64, 130, 199}));
+    BOOST_TEST(d.cells() == (std::vector<int>{0, 63, 64, 130, 199}));
+  }
+
+  // values outside of an axis without flow bins mark no blocks
+  {
+    using in = axis::integer<int, axis::null_type, axis::option::none_t>;
+    using S = tracking_storage<dense_storage<double>>;
+    auto h = make_histogram_with(S(2), in(0, 8));
+    unsafe_access::storage(h).checkpoint();
+    const std::vector<int> x = {-1, 8, 6, 9, -5};
+    h.fill(x);
+    h.fill(x, weight(2));
+    const auto d = unsafe_access::storage(h).make_delta();
+    BOOST_TEST(d.blocks() == (std::vector<std::size_t>{3}));
+    BOOST_TEST(d.cells() == (std::vector<double>{3, 0}));
+  }
+
+  // cells use plain references and proxy references
+  sync_test<dense_storage<double>>();
+  sync_test<unlimited_storage<>>();
+
+  // cells of unlimited_storage keep their integer type in the delta
+  {
+    tracking_storage<unlimited_storage<>> a;
+    a.reset(4);
+    a.checkpoint();
+    ++a[1];
+    auto cells = a.make_delta().cells();
+    BOOST_TEST_EQ(unsafe_access::unlimited_storage_buffer(cells).type, 0);
+  }
+
+  // accumulators
+  {
+    using S = tracking_storage<weight_storage>;
+    auto h1 = make_histogram_with(S(2), axis::integer<>(0, 8));
+    auto h2 = h1;
+    unsafe_access::storage(h1).checkpoint();
+    h1(1, weight(2));
+    h1(6, weight(3));
+    const auto d = unsafe_access::storage(h1).make_delta();
+    BOOST_TEST_EQ(d.blocks().size(), 2);
+    unsafe_access::storage(h2).apply_delta(d);
+    BOOST_TEST(h1 == h2);
+    BOOST_TEST_EQ(h2[1].value(), 2);
+    BOOST_TEST_EQ(h2[6].variance(), 9);
+  }
+
+  // block size and configuration of the wrapped storage survive project, reduce, and
+  // growth
+  {
+    using ing = axis::integer<int, axis::null_type, axis::option::growth_t>;
+    using S = tracking_storage<hybrid_storage<double>>;
+    auto h = make_histogram_with(S(2, hybrid_storage<double>(0.5)), axis::integer<>(0, 4),
+                                 ing(0, 2));
+    const auto p = algorithm::project(h, std::integral_constant<unsigned, 0>{});
+    BOOST_TEST_EQ(unsafe_access::storage(p).block_size(), 2);
+    BOOST_TEST_EQ(unsafe_access::storage(p).storage().max_occupancy(), 0.5);
+    const auto r = algorithm::reduce(h, algorithm::shrink(0, 0, 2));
+    BOOST_TEST_EQ(unsafe_access::storage(r).block_size(), 2);
+    BOOST_TEST_EQ(unsafe_access::storage(r).storage().max_occupancy(), 0.5);
+    h(1, 5);
+    BOOST_TEST_EQ(unsafe_access::storage(h).block_size(), 2);
+    BOOST_TEST_EQ(unsafe_access::storage(h).storage().max_occupancy(), 0.5);
+    BOOST_TEST_EQ(h.at(1, 5), 1);
+  }
+
+  // serialization keeps the block size and marks all blocks
+  {
+    tracking_storage<dense_storage<int>> a(2), b;
+    a.reset(5);
+    a[3] = 2;
+    a.checkpoint();
+    load(save(a), b);
+    BOOST_TEST(a == b);
+    BOOST_TEST_EQ(b.block_size(), 2);
+    BOOST_TEST_EQ(b.make_delta().blocks().size(), 3);
+  }
+
+  return boost::report_errors();
+}
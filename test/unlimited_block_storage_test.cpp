@@ -0,0 +1,150 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <boost/core/lightweight_test.hpp>
+#include <boost/core/lightweight_test_trait.hpp>
+#include <boost/histogram/algorithm/sum.hpp>
+#include <boost/histogram/axis/integer.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/histogram.hpp>
+#include <boost/histogram/make_histogram.hpp>
+#include <boost/histogram/unlimited_block_storage.hpp>
+#include <boost/histogram/unsafe_access.hpp>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+#include "std_ostream.hpp"
+#include "throw_exception.hpp"
+#include "utility_allocator.hpp"
+
+using namespace boost::histogram;
+
+using storage_type = unlimited_block_storage<>;
+constexpr auto block_size = storage_type::block_size;
+
+// returns index of counter type of each block
+std::vector<unsigned> types(storage_type& s) {
+  std::vector<unsigned> result;
+  for (auto&& b : unsafe_access::unlimited_block_storage_blocks(s))
+    result.push_back(unsafe_access::unlimited_storage_buffer(b).type);
+  return result;
+}
+
+int main() {
+  BOOST_TEST_TRAIT_TRUE((detail::is_storage<storage_type>));
+
+  // empty state
+  {
+    storage_type a;
+    BOOST_TEST_EQ(a.size(), 0);
+    BOOST_TEST(a.begin() == a.end());
+    a.reset(0);
+    BOOST_TEST_EQ(a.size(), 0);
+    BOOST_TEST(a == storage_type());
+  }
+
+  // reset, size, blocks
+  {
+    storage_type a;
+    a.reset(2 * block_size + 3);
+    BOOST_TEST_EQ(a.size(), 2 * block_size + 3);
+    BOOST_TEST_EQ(types(a), (std::vector<unsigned>{0, 0, 0}));
+    BOOST_TEST_EQ(std::count(a.begin(), a.end(), 0), a.size());
+    a.reset(block_size);
+    BOOST_TEST_EQ(a.size(), block_size);
+    BOOST_TEST_EQ(types(a), (std::vector<unsigned>{0}));
+  }
+
+  // widening is local to block
+  {
+    storage_type a;
+    a.reset(3 * block_size);
+    for (unsigned i = 0; i < 256; ++i) ++a[block_size + 5];
+    BOOST_TEST_EQ(types(a), (std::vector<unsigned>{0, 1, 0}));
+    BOOST_TEST_EQ(a[block_size + 5], 256);
+    for (unsigned i = 0; i < 3; ++i) ++a[2 * block_size];
+    a[0] += (std::numeric_limits<std::uint32_t>::max)();
+    BOOST_TEST_EQ(types(a), (std::vector<unsigned>{2, 1, 0}));
+    ++a[0];
+    BOOST_TEST_EQ(types(a), (std::vector<unsigned>{3, 1, 0}));
+    BOOST_TEST_EQ(a[0], static_cast<double>((std::numeric_limits<std::uint32_t>::max)()) +
+                            1);
+    BOOST_TEST_EQ(a[2 * block_size], 3);
+    BOOST_TEST_EQ(a[1], 0);
+
+    // adding a non-integral value converts only one block to double
+    a[2 * block_size + 1] += 0.5;
+    BOOST_TEST_EQ(types(a), (std::vector<unsigned>{3, 1, 5}));
+    BOOST_TEST_EQ(a[2 * block_size + 1], 0.5);
+    BOOST_TEST_EQ(a[2 * block_size], 3);
+  }
+
+  // copy, compare, scale, iterators
+  {
+    storage_type a;
+    a.reset(block_size + 2);
+    std::iota(a.begin(), a.end(), 0);
+    BOOST_TEST_EQ(a[block_size + 1], block_size + 1);
+
+    auto b = a;
+    BOOST_TEST(a == b);
+    ++b[block_size];
+    BOOST_TEST_NOT(a == b);
+
+    std::vector<double> v(a.begin(), a.end());
+    BOOST_TEST(a == v);
+    storage_type c(v);
+    BOOST_TEST(a == c);
+
+    const auto& aconst = a;
+    storage_type::const_iterator it = aconst.begin();
+    BOOST_TEST_EQ(*(it + block_size), block_size);
+
+    a *= 2;
+    BOOST_TEST_EQ(a[3], 6);
+    BOOST_TEST_EQ(a[block_size + 1], 2 * (block_size + 1));
+  }
+
+  // allocator is used for blocks
+  {
+    tracing_allocator_db db;
+    unlimited_block_storage<tracing_allocator<char>> a(tracing_allocator<char>{db});
+    a.reset(2 * block_size);
+    BOOST_TEST_EQ(db.at<std::uint8_t>().first, 2 * block_size);
+  }
+
+  // histogram with many cells and few large counts
+  {
+    auto h1 = make_histogram_with(storage_type(), axis::integer<>(0, 10000));
+    auto h2 = make_histogram(axis::integer<>(0, 10000));
+    for (int i = 0; i < 10000; ++i) {
+      h1(i);
+      h2(i);
+    }
+    for (int i = 0; i < 1000; ++i) {
+      h1(42);
+      h2(42);
+    }
+    const std::vector<int> x(3000, 9000);
+    h1.fill(x);
+    h2.fill(x);
+
+    BOOST_TEST_EQ(algorithm::sum(h1), algorithm::sum(h2));
+    BOOST_TEST(std::equal(h1.begin(), h1.end(), h2.begin(), h2.end()));
+    // only blocks with cells 42 and 9000 are widened
+    const auto t = types(unsafe_access::storage(h1));
+    BOOST_TEST_EQ(std::count(t.begin(), t.end(), 0), t.size() - 2);
+
+    auto h3 = h1;
+    h3 += h1;
+    BOOST_TEST_EQ(h3.at(42), 2002);
+    BOOST_TEST_EQ(h3.at(9000), 6002);
+  }
+
+  return boost::report_errors();
+}
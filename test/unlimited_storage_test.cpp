@@ -7,7 +7,10 @@
 #include <algorithm>
 #include <boost/core/lightweight_test.hpp>
 #include <boost/core/lightweight_test_trait.hpp>
+#include <boost/histogram/axis/integer.hpp>
 #include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/histogram.hpp>
+#include <boost/histogram/make_histogram.hpp>
 #include <boost/histogram/storage_adaptor.hpp>
 #include <boost/histogram/unlimited_storage.hpp>
 #include <boost/histogram/unsafe_access.hpp>
@@ -117,6 +120,62 @@ void increase_and_grow() {
   BOOST_TEST_EQ(n2[1], 0.0);
 }
 
+template <typename T>
+void grow() {
+  auto s = prepare<T>(2, T(1));
+  ++s[1];
+  ++s[1];
+  const auto& buffer = unsafe_access::unlimited_storage_buffer(s);
+  void* p = nullptr;
+  const auto f = [&p](auto* x) { p = x; };
+
+  // growth at the front allocates room for as many cells again
+  s.grow(4, 1, f);
+  BOOST_TEST_EQ(p, buffer.ptr);
+  BOOST_TEST_EQ(buffer.capacity, 8);
+  BOOST_TEST_EQ(buffer.front, 2);
+  BOOST_TEST_EQ(s.size(), 4);
+  BOOST_TEST_EQ(s[0], 0);
+  BOOST_TEST_EQ(s[1], 1);
+  BOOST_TEST_EQ(s[2], 2);
+  BOOST_TEST_EQ(s[3], 0);
+
+  // growth at both ends which fits into the free space does not allocate
+  s.grow(7, 2, f);
+  BOOST_TEST_EQ(buffer.capacity, 8);
+  BOOST_TEST_EQ(buffer.front, 0);
+  BOOST_TEST_EQ(s.size(), 7);
+  const double ref1[] = {0, 0, 0, 1, 2, 0, 0};
+  BOOST_TEST_ALL_EQ(s.begin(), s.end(), ref1, ref1 + 7);
+
+  // growth which does not fit reallocates
+  s.grow(8, 1, f);
+  BOOST_TEST_EQ(p, buffer.ptr);
+  BOOST_TEST_EQ(buffer.capacity, 16);
+  BOOST_TEST_EQ(s.size(), 8);
+  const double ref2[] = {0, 0, 0, 0, 1, 2, 0, 0};
+  BOOST_TEST_ALL_EQ(s.begin(), s.end(), ref2, ref2 + 8);
+
+  // growth at the back reallocates without free space in front
+  auto t = prepare<T>(2, T(1));
+  t.grow(3, 0, f);
+  const auto& tbuffer = unsafe_access::unlimited_storage_buffer(t);
+  BOOST_TEST_EQ(tbuffer.capacity, 6);
+  BOOST_TEST_EQ(tbuffer.front, 0);
+  t.grow(6, 0, f);
+  BOOST_TEST_EQ(tbuffer.capacity, 6);
+  const double ref3[] = {1, 0, 0, 0, 0, 0};
+  BOOST_TEST_ALL_EQ(t.begin(), t.end(), ref3, ref3 + 6);
+
+  // copies and moves keep the cells
+  auto c = s;
+  BOOST_TEST(c == s);
+  auto m = std::move(c);
+  BOOST_TEST(m == s);
+  ++m[4];
+  BOOST_TEST_EQ(m[4], 2);
+}
+
 template <typename T>
 void convert_foreign_storage() {
 
@@ -354,6 +413,16 @@ int main() {
     BOOST_TEST_EQ(a[1], 6);
   }
 
+  // grow
+  {
+    grow<uint8_t>();
+    grow<uint16_t>();
+    grow<uint32_t>();
+    grow<uint64_t>();
+    grow<large_int>();
+    grow<double>();
+  }
+
   // convert_foreign_storage
   {
     convert_foreign_storage<uint8_t>();
@@ -411,6 +480,106 @@ int main() {
     BOOST_TEST_TRAIT_TRUE((detail::has_operator_preincrement<decltype(d[0])>));
   }
 
+  // increment_n
+  {
+    BOOST_TEST_TRAIT_TRUE(
+        (detail::has_method_increment_n<unlimited_storage_type, std::size_t>));
+    BOOST_TEST_TRAIT_FALSE(
+        (detail::has_method_increment_n<vector_storage<int>, std::size_t>));
+
+    // with and without overflow check, with widening across several types
+    for (std::size_t n : {3, 1000}) {
+      auto a = prepare(n, limits_max<uint8_t>());
+      auto b = a;
+      std::vector<std::size_t> idx;
+      for (unsigned i = 0; i < 70000; ++i) idx.push_back(i % 5 ? 0 : i % n);
+      a.increment_n(idx.data(), idx.size());
+      for (auto i : idx) ++b[i];
+      BOOST_TEST_EQ(unsafe_access::unlimited_storage_buffer(a).type,
+                    unsafe_access::unlimited_storage_buffer(b).type);
+      BOOST_TEST(a == b);
+    }
+
+    // buffers larger than the number of increments skip the overflow check while the
+    // upper bound of the cell values leaves enough headroom
+    {
+      unlimited_storage_type s;
+      s.reset(1000);
+      const auto& buffer = unsafe_access::unlimited_storage_buffer(s);
+      std::vector<std::size_t> idx(100, 7);
+      s.increment_n(idx.data(), idx.size());
+      BOOST_TEST_EQ(buffer.bound, 100);
+      BOOST_TEST_EQ(buffer.type, 0);
+      s.increment_n(idx.data(), idx.size());
+      s.increment_n(idx.data(), idx.size());
+      BOOST_TEST_EQ(buffer.type, 1);
+      BOOST_TEST_EQ(s[7], 300);
+      for (int i = 0; i < 653; ++i) s.increment_n(idx.data(), idx.size());
+      BOOST_TEST_EQ(buffer.type, 2);
+      BOOST_TEST_EQ(s[7], 65600);
+      BOOST_TEST_GE(buffer.bound, 65600);
+
+      // other writes make the bound unknown
+      s.reset(1000);
+      s[7] = 250;
+      s.increment_n(idx.data(), 10);
+      BOOST_TEST_EQ(buffer.type, 1);
+      BOOST_TEST_EQ(s[7], 260);
+      s.reset(1000);
+      s[7] += 250u;
+      BOOST_TEST_GE(buffer.bound, 250);
+      s.increment_n(idx.data(), 10);
+      BOOST_TEST_EQ(s[7], 260);
+      s.reset(1000);
+      ++s[7];
+      auto c = s;
+      BOOST_TEST_GE(unsafe_access::unlimited_storage_buffer(c).bound, 1);
+      c.increment_n(idx.data(), idx.size());
+      BOOST_TEST_EQ(c[7], 101);
+
+      // unknown bound is recomputed after as many increments as there are cells
+      s = unlimited_storage_type(std::vector<std::uint16_t>(1000, 1));
+      for (int i = 0; i < 10; ++i) s.increment_n(idx.data(), idx.size());
+      BOOST_TEST_GE(buffer.bound, std::uint64_t(1) << 63);
+      s.increment_n(idx.data(), idx.size());
+      BOOST_TEST_EQ(buffer.bound, 1101);
+      BOOST_TEST_EQ(s[7], 1101);
+    }
+
+    // growth keeps the bound, batch fills after growth still check for overflow
+    {
+      using ig = axis::integer<int, axis::null_type, axis::option::growth_t>;
+      auto h = make_histogram_with(unlimited_storage_type(), ig(0, 1));
+      h.fill(std::vector<int>(250, 0));
+      h.fill(std::vector<int>{5});
+      BOOST_TEST_EQ(h.axis().size(), 6);
+      const auto& s = unsafe_access::storage(h);
+      BOOST_TEST_GE(unsafe_access::unlimited_storage_buffer(s).bound, 250);
+      h.fill(std::vector<int>(100, 0));
+      BOOST_TEST_EQ(h.at(0), 350);
+      BOOST_TEST_EQ(h.at(5), 1);
+    }
+
+    // invalid indices are skipped
+    auto a = prepare(3);
+    const detail::optional_index idx[] = {{2}, {detail::invalid_index}, {0}, {2}};
+    a.increment_n(idx, 4);
+    BOOST_TEST_EQ(a[0], 1);
+    BOOST_TEST_EQ(a[1], 0);
+    BOOST_TEST_EQ(a[2], 2);
+
+    // no overflow check for large_int and double
+    auto c = prepare<large_int>(2, limits_max<large_int>());
+    auto d = prepare<double>(2, 1.5);
+    const std::size_t idx2[] = {0, 1, 0};
+    c.increment_n(idx2, 3);
+    d.increment_n(idx2, 3);
+    BOOST_TEST_EQ(c[0], static_cast<double>(limits_max<uint64_t>()) + 2);
+    BOOST_TEST_EQ(c[1], 1);
+    BOOST_TEST_EQ(d[0], 3.5);
+    BOOST_TEST_EQ(d[1], 1);
+  }
+
   // iterators
   {
     using iterator = typename unlimited_storage_type::iterator;
@@ -494,6 +663,14 @@ int main() {
     BOOST_TEST_EQ(buffer.type, 0);
     // all memory returned
     BOOST_TEST_EQ(db.first, 0);
+
+    // growth returns all memory, also with free space in front of the cells
+    s.reset(3);
+    s.grow(4, 1, [](auto*) {});
+    s.grow(5, 1, [](auto*) {});
+    BOOST_TEST_EQ(db.at<uint8_t>().first, 8);
+    s.reset(0);
+    BOOST_TEST_EQ(db.first, 0);
 #endif
   }
 
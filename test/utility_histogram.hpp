@@ -7,13 +7,19 @@
 #ifndef BOOST_HISTOGRAM_TEST_UTILITY_HISTOGRAM_HPP
 #define BOOST_HISTOGRAM_TEST_UTILITY_HISTOGRAM_HPP
 
+#include <boost/histogram/accumulators/weighted_sum.hpp>
 #include <boost/histogram/axis/category.hpp>
 #include <boost/histogram/axis/integer.hpp>
 #include <boost/histogram/axis/regular.hpp>
 #include <boost/histogram/axis/variable.hpp>
 #include <boost/histogram/axis/variant.hpp>
 #include <boost/histogram/make_histogram.hpp>
+#include <boost/histogram/storage_adaptor.hpp>
+#include <boost/histogram/unlimited_storage.hpp>
+#include <boost/histogram/weight.hpp>
 #include <boost/mp11/algorithm.hpp>
+#include <random>
+#include <tuple>
 #include <type_traits>
 #include <vector>
 
@@ -54,6 +60,29 @@ auto make_s(dynamic_tag, S&& s, const Axes&... axes) {
   return make_histogram_with(s, make_axis_vector(axes...));
 }
 
+// histogram filled with random integral values in [lo, hi] and random integral weights
+template <class Tag, class S, class... Axes>
+auto make_filled(Tag tag, S&& s, int lo, int hi, const Axes&... axes) {
+  auto h = make_s(tag, s, axes...);
+  std::mt19937 gen(1);
+  std::uniform_int_distribution<> x(lo, hi);
+  // braced initialization draws the values from left to right
+  using args = std::tuple<decltype(static_cast<void>(axes), 0)..., weight_type<int>>;
+  for (int i = 0; i < 2000; ++i)
+    h(args{(static_cast<void>(axes), x(gen))..., weight(x(gen))});
+  return h;
+}
+
+// calls f(tag, storage) for static and dynamic axes and storages with different code
+// paths in the algorithms
+template <class F>
+void for_each_test_storage(F&& f) {
+  f(static_tag{}, dense_storage<int>());
+  f(dynamic_tag{}, dense_storage<int>());
+  f(static_tag{}, unlimited_storage<>());
+  f(static_tag{}, weight_storage());
+}
+
 } // namespace histogram
 } // namespace boost
 
@@ -0,0 +1,192 @@
+// Copyright 2021 Hans Dembinski
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt
+// or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/core/lightweight_test.hpp>
+#include <boost/core/lightweight_test_trait.hpp>
+#include <boost/histogram/accumulators/mean.hpp>
+#include <boost/histogram/accumulators/weighted_sum.hpp>
+#include <boost/histogram/algorithm/materialize.hpp>
+#include <boost/histogram/algorithm/project.hpp>
+#include <boost/histogram/algorithm/reduce.hpp>
+#include <boost/histogram/algorithm/sum.hpp>
+#include <boost/histogram/axis/category.hpp>
+#include <boost/histogram/axis/integer.hpp>
+#include <boost/histogram/axis/ostream.hpp>
+#include <boost/histogram/axis/regular.hpp>
+#include <boost/histogram/detail/detect.hpp>
+#include <boost/histogram/indexed.hpp>
+#include <boost/histogram/literals.hpp>
+#include <boost/histogram/ostream.hpp>
+#include <boost/histogram/storage_adaptor.hpp>
+#include <boost/histogram/unlimited_storage.hpp>
+#include <boost/histogram/view_storage.hpp>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "throw_exception.hpp"
+#include "utility_histogram.hpp"
+
+using namespace boost::histogram;
+using namespace boost::histogram::literals; // to get _c suffix
+using namespace boost::histogram::algorithm;
+
+// accumulator without operator==
+struct counter {
+  counter& operator++() {
+    ++value;
+    return *this;
+  }
+  counter& operator+=(const counter& c) {
+    value += c.value;
+    return *this;
+  }
+  double value = 0;
+};
+
+template <class Tag, class Storage>
+void compare_with_algorithms(Storage s) {
+  using none = axis::integer<int, axis::null_type, axis::option::none_t>;
+  using cat = axis::category<int, axis::null_type>;
+  auto h = make_s(Tag(), s, axis::regular<>(6, 0, 6), none(0, 3), cat{0, 1, 2, 3});
+  std::mt19937 gen(1);
+  std::uniform_int_distribution<> x(-1, 6);
+  for (int i = 0; i < 500; ++i) h(x(gen), x(gen), x(gen));
+
+  for (auto&& kept : std::vector<std::vector<unsigned>>{
+           {0}, {1}, {2}, {0, 1}, {1, 0}, {2, 0}, {1, 2, 0}, {0, 1, 2}}) {
+    const auto v = project_view(h, kept);
+    BOOST_TEST(v == project(h, kept));
+    BOOST_TEST(materialize(v) == project(h, kept));
+  }
+  BOOST_TEST(project_view(h, 2_c, 0_c) == project(h, 2_c, 0_c));
+  BOOST_TEST(project_view(h, 1_c) == project(h, 1_c));
+
+  for (auto&& opts : std::vector<std::vector<reduce_command>>{
+           {rebin(0, 2)},
+           {shrink(0, 1, 4)},
+           {crop(0, 1, 4)},
+           {slice(1, 1, 2)},
+           {slice(2, 1, 3)},
+           {shrink_and_rebin(0, 1, 5, 2), slice(2, 2, 4)},
+           {crop(0, 2, 3), crop(1, 0, 1)}}) {
+    const auto v = reduce_view(h, opts);
+    BOOST_TEST_EQ(v.axis(0), reduce(h, opts).axis(0));
+    BOOST_TEST(v == reduce(h, opts));
+    BOOST_TEST(materialize(v) == reduce(h, opts));
+  }
+}
+
+int main() {
+  BOOST_TEST_TRAIT_TRUE((detail::is_storage<view_storage<dense_storage<int>>>));
+
+  compare_with_algorithms<static_tag>(dense_storage<int>());
+  compare_with_algorithms<dynamic_tag>(dense_storage<int>());
+  compare_with_algorithms<static_tag>(dense_storage<double>());
+  compare_with_algorithms<static_tag>(weight_storage());
+  compare_with_algorithms<static_tag>(unlimited_storage<>());
+  compare_with_algorithms<dynamic_tag>(unlimited_storage<>());
+
+  // histogram interface of a view
+  {
+    auto h = make(static_tag(), axis::integer<>(0, 4), axis::integer<>(0, 3));
+    for (auto&& x : indexed(h, coverage::all)) *x = 10 * x.index(0) + x.index(1);
+
+    auto v = reduce_view(h, slice(0, 1, 3));
+    BOOST_TEST_EQ(v.rank(), 2);
+    BOOST_TEST_EQ(v.axis(0), axis::integer<>(1, 3));
+    BOOST_TEST_EQ(v.axis(1), h.axis(1));
+    BOOST_TEST_EQ(v.size(), 4 * 5);
+    BOOST_TEST_EQ(v.at(0, 0), 10);
+    BOOST_TEST_EQ(v.at(1, 2), 22);
+    // shrunk bins are added to the flow bins
+    BOOST_TEST_EQ(v.at(-1, 2), -10 + 2 + 2);
+    BOOST_TEST_EQ(v.at(2, 1), 31 + 41);
+    BOOST_TEST_EQ(sum(v), sum(h));
+    BOOST_TEST_EQ(sum(threads(1), v, coverage::inner), 10 + 11 + 12 + 20 + 21 + 22);
+
+    double inner = 0;
+    for (auto&& x : indexed(v)) inner += *x;
+    BOOST_TEST_EQ(inner, sum(v, coverage::inner));
+
+    // changes of the original cells are visible through the view
+    h.at(1, 0) = 100;
+    BOOST_TEST_EQ(v.at(0, 0), 100);
+    h(2.5, 1.5);
+    BOOST_TEST_EQ(v.at(1, 1), 22);
+
+    // projection sums the removed axes on access
+    auto p = project_view(h, 1_c);
+    double col = 0;
+    for (int i = -1; i < 5; ++i) col += h.at(i, 1);
+    BOOST_TEST_EQ(p.at(1), col);
+    BOOST_TEST(p == project(h, 1_c));
+
+    // views of views
+    const auto pv = project_view(v, 1_c);
+    BOOST_TEST(pv == project(reduce(h, slice(0, 1, 3)), 1_c));
+
+    // cells cannot be changed through a view
+    BOOST_TEST_THROWS(v.reset(), std::logic_error);
+  }
+
+  // unlimited_storage: materialize keeps the integer type of the cells
+  {
+    auto h = make(static_tag(), axis::integer<>(0, 3), axis::integer<>(0, 2));
+    h(0, 0);
+    h(1, 1);
+    const auto m = materialize(project_view(h, 0_c));
+    BOOST_TEST(m == project(h, 0_c));
+    BOOST_TEST_EQ(unsafe_access::unlimited_storage_buffer(unsafe_access::storage(m)).type,
+                  0);
+  }
+
+  // profile: cells of the view are merged accumulators
+  {
+    auto h = make_s(static_tag(), profile_storage(), axis::integer<>(0, 2),
+                    axis::integer<>(0, 2));
+    h(0, 0, sample(1));
+    h(0, 1, sample(3));
+    h(1, 1, sample(5));
+    const auto p = project_view(h, 0_c);
+    BOOST_TEST_EQ(p.at(0).count(), 2);
+    BOOST_TEST_EQ(p.at(0).value(), 2);
+    BOOST_TEST_EQ(p.at(1).value(), 5);
+  }
+
+  // axis without cells in the middle, the original histogram has no cells
+  {
+    using cat = axis::category<int, axis::null_type, axis::option::none_t>;
+    auto h =
+        make(static_tag(), axis::regular<>(2, 0, 1), cat{}, axis::regular<>(2, 0, 1));
+    const auto p = materialize(project_view(h, 0_c, 2_c));
+    BOOST_TEST(p == project(h, 0_c, 2_c));
+    BOOST_TEST_EQ(p.size(), 16);
+    BOOST_TEST_EQ(sum(p), 0);
+    const auto r = reduce(h, shrink(0, 0, 0.5));
+    BOOST_TEST_EQ(r.size(), 0);
+    BOOST_TEST(materialize(reduce_view(h, shrink(0, 0, 0.5))) == r);
+  }
+
+  // cells without operator== are all copied into the result
+  {
+    auto h = make_s(static_tag(), dense_storage<counter>(), axis::regular<>(2, 0, 2),
+                    axis::regular<>(2, 0, 2));
+    h(0, 0);
+    h(0, 1);
+    h(1, 1);
+    const auto p = project(h, 0_c);
+    BOOST_TEST_EQ(p.at(0).value, 2);
+    BOOST_TEST_EQ(p.at(1).value, 1);
+    const auto r = reduce(h, rebin(1, 2));
+    BOOST_TEST_EQ(r.at(0, 0).value, 2);
+    BOOST_TEST_EQ(r.at(1, 0).value, 1);
+    const auto m = materialize(project_view(h, 1_c));
+    BOOST_TEST_EQ(m.at(0).value, 1);
+    BOOST_TEST_EQ(m.at(1).value, 2);
+  }
+
+  return boost::report_errors();
+}